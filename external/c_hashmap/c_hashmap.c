@@ -11,6 +11,21 @@
 #include <stddef.h>
 #include "c_hashmap.h"
 
+// every library links its own copy of this file and only one is kept, so
+// default callbacks can't know creator. engine code passes ac_hashmap_alloc
+// and ac_hashmap_realloc to account maps to its own tag
+static void*
+hashmap_default_malloc(size_t size)
+{
+  return ac_alloc_tagged(size, ac_memory_tag_core);
+}
+
+static void*
+hashmap_default_realloc(void* p, size_t size)
+{
+  return ac_realloc_tagged(p, size, ac_memory_tag_core);
+}
+
 #if defined(__clang__)
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Weverything"
@@ -90,11 +105,11 @@ hashmap_new_with_allocator(
 {
   if (!_malloc)
   {
-    _malloc = ac_alloc;
+    _malloc = hashmap_default_malloc;
   }
   if (!_realloc)
   {
-    _realloc = ac_realloc;
+    _realloc = hashmap_default_realloc;
   }
   if (!_free)
   {
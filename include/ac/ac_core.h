@@ -21,10 +21,91 @@ typedef enum ac_time_units {
   ac_time_unit_nanoseconds = 3,
 } ac_time_units;
 
+// allocations done through ac_alloc carry header with allocator and size
+// in front of returned pointer
+#define AC_ALLOCATION_HEADER_SIZE 32
+#define AC_MAX_ALLOCATOR_SCOPES 8
+#define AC_MAX_MEMORY_TAGS 32
+
+AC_DEFINE_HANDLE(ac_arena);
+AC_DEFINE_HANDLE(ac_pool);
+AC_DEFINE_HANDLE(ac_heap);
+
+// (user_data, size, alignment)
+typedef void* (*ac_allocator_alloc)(void*, size_t, size_t);
+// (user_data, p, size, alignment), optional. ac_realloc allocates new block
+// and copies when not set or when it returns NULL
+typedef void* (*ac_allocator_realloc)(void*, void*, size_t, size_t);
+// (user_data, p)
+typedef void (*ac_allocator_free)(void*, void*);
+
+typedef struct ac_allocator {
+  void*                user_data;
+  ac_allocator_alloc   cb_alloc;
+  ac_allocator_realloc cb_realloc;
+  ac_allocator_free    cb_free;
+} ac_allocator;
+
+// memory is taken from current allocator when not set, otherwise object
+// itself is placed at start of it and size includes it
+typedef struct ac_arena_info {
+  void*  memory;
+  size_t size;
+} ac_arena_info;
+
+// blocks serving ac_alloc need AC_ALLOCATION_HEADER_SIZE on top of size
+typedef struct ac_pool_info {
+  void*  memory;
+  size_t size;
+  size_t block_size;
+} ac_pool_info;
+
+typedef struct ac_heap_info {
+  void*  memory;
+  size_t size;
+  bool   thread_safe;
+} ac_heap_info;
+
+// engine libraries account their allocations to their own tag, ac_alloc
+// called by application goes to ac_memory_tag_application
+typedef enum ac_memory_tag {
+  ac_memory_tag_application = 0,
+  ac_memory_tag_core = 1,
+  ac_memory_tag_fs = 2,
+  ac_memory_tag_renderer = 3,
+  ac_memory_tag_render_graph = 4,
+  ac_memory_tag_input = 5,
+  ac_memory_tag_window = 6,
+  // first tag free for application, up to AC_MAX_MEMORY_TAGS. tags past it
+  // are counted as ac_memory_tag_application
+  ac_memory_tag_user = 8,
+} ac_memory_tag;
+
+typedef struct ac_memory_tag_stats {
+  uint64_t live_bytes;
+  uint64_t peak_bytes;
+  uint64_t live_allocations;
+  uint64_t total_allocations;
+} ac_memory_tag_stats;
+
+typedef struct ac_memory_stats {
+  ac_memory_tag_stats tags[AC_MAX_MEMORY_TAGS];
+} ac_memory_stats;
+
 typedef struct ac_init_info {
-  const char* app_name;
-  bool        enable_memory_manager;
-  const char* debug_rom;
+  const char*         app_name;
+  bool                enable_memory_manager;
+  // stack trace is captured for every n-th tracked allocation, 0 means 1
+  uint32_t            memory_manager_trace_interval;
+  const char*         debug_rom;
+  // used for every ac_alloc outside of allocator scope, must be thread safe
+  const ac_allocator* allocator;
+  // 0 creates one job thread per cpu except calling one
+  uint32_t            job_thread_count;
+  // jobs on job threads run on pooled fibers, so ac_job_wait inside them
+  // yields fiber instead of blocking thread. 0 runs jobs on thread stacks,
+  // as do platforms without fiber support
+  uint32_t            job_fiber_count;
 } ac_init_info;
 
 AC_API ac_result
@@ -63,6 +144,79 @@ ac_aligned_alloc(size_t size, size_t alignment);
 AC_API void
 ac_free(void* p);
 
+AC_API void*
+ac_alloc_tagged(size_t size, ac_memory_tag tag);
+
+AC_API void*
+ac_calloc_tagged(size_t size, ac_memory_tag tag);
+
+// tag is used only when p is NULL, otherwise allocation keeps its tag
+AC_API void*
+ac_realloc_tagged(void* p, size_t size, ac_memory_tag tag);
+
+AC_API void*
+ac_aligned_alloc_tagged(size_t size, size_t alignment, ac_memory_tag tag);
+
+// counters are kept in every configuration, bytes are requested sizes
+AC_API void
+ac_get_memory_stats(ac_memory_stats* stats);
+
+// allocations done on calling thread go to allocator until pop, allocator
+// must stay alive while any of its allocations are
+AC_API void
+ac_push_allocator(const ac_allocator* allocator);
+
+AC_API void
+ac_pop_allocator(void);
+
+AC_API ac_result
+ac_create_arena(const ac_arena_info* info, ac_arena* arena);
+
+AC_API void
+ac_destroy_arena(ac_arena arena);
+
+AC_API void*
+ac_arena_alloc(ac_arena arena, size_t size, size_t alignment);
+
+AC_API void
+ac_arena_reset(ac_arena arena);
+
+AC_API void
+ac_arena_get_allocator(ac_arena arena, ac_allocator* allocator);
+
+AC_API ac_result
+ac_create_pool(const ac_pool_info* info, ac_pool* pool);
+
+AC_API void
+ac_destroy_pool(ac_pool pool);
+
+AC_API void*
+ac_pool_alloc(ac_pool pool);
+
+AC_API void
+ac_pool_free(ac_pool pool, void* p);
+
+AC_API void
+ac_pool_get_allocator(ac_pool pool, ac_allocator* allocator);
+
+AC_API ac_result
+ac_create_heap(const ac_heap_info* info, ac_heap* heap);
+
+AC_API void
+ac_destroy_heap(ac_heap heap);
+
+AC_API void*
+ac_heap_alloc(ac_heap heap, size_t size, size_t alignment);
+
+AC_API void*
+ac_heap_realloc(ac_heap heap, void* p, size_t size, size_t alignment);
+
+AC_API void
+ac_heap_free(ac_heap heap, void* p);
+
+AC_API void
+ac_heap_get_allocator(ac_heap heap, ac_allocator* allocator);
+
 AC_API void
 ac_log(ac_log_level level, const char* fmt, ...);
 
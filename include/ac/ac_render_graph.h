@@ -32,6 +32,8 @@ AC_DEFINE_HANDLE(ac_rg);
 
 typedef ac_result (*ac_rg_cb_stage)(struct ac_rg_stage*, void*);
 typedef ac_result (*ac_rg_cb_build)(ac_rg_builder, void*);
+typedef bool (*ac_rg_cb_condition)(struct ac_rg_stage*, void*);
+typedef void (*ac_rg_cb_pipeline_ready)(ac_result, ac_pipeline, void*);
 
 typedef enum ac_rg_frame_state {
   ac_rg_frame_state_idle = 0,
@@ -63,6 +65,13 @@ typedef struct ac_rg_builder_stage_info {
   ac_rg_cb_stage      cb_prepare;
   ac_rg_cb_stage      cb_cmd;
   ac_rg_cb_stage      cb_submit;
+  // evaluated every frame, when false stage callbacks are skipped without
+  // recompiling graph. barriers still run and nothing is written, readers
+  // see state resource had before stage. transient resource first written
+  // by skipped stage has undefined contents
+  ac_rg_cb_condition  cb_condition;
+  // relative gpu cost for async compute scheduling, 0 counts as 1
+  uint32_t            cost;
   void*               user_data;
   uint64_t            metadata;
   ac_rg_builder_group group;
@@ -124,6 +133,13 @@ typedef struct ac_rg_pipeline_info {
   ac_channel_bits     color_attachment_discard_bits[AC_MAX_ATTACHMENT_COUNT];
   ac_blend_state_info blend_state_info;
   char const*         name;
+  // compile as job instead of blocking stage recording,
+  // ac_rg_stage_get_pipeline returns ac_result_not_ready until it is done.
+  // compiled right away when there are no job threads
+  bool async;
+  // called from job when compile queued by this call finished
+  ac_rg_cb_pipeline_ready cb_ready;
+  void*                   user_data;
 } ac_rg_pipeline_info;
 
 typedef struct ac_rg_stage {
@@ -138,6 +154,12 @@ typedef struct ac_rg_graph_info {
   char const*    name;
   ac_rg_cb_build cb_build;
   void*          user_data;
+  // 0 or 1 records stages on calling thread, otherwise stages are recorded
+  // by up to that many core jobs and cb_cmd callbacks must be thread safe
+  uint32_t       record_thread_count;
+  // compute stages recorded for graphics queue move to compute queue when
+  // enough independent graphics work can overlap them
+  bool           async_compute;
 } ac_rg_graph_info;
 
 typedef enum ac_rg_validation_object_type {
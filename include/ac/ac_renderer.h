@@ -24,12 +24,14 @@ extern "C"
 #define AC_WHOLE_LEVELS (0ull)
 #define AC_WHOLE_LAYERS (0ull)
 #define AC_SHADER_UNUSED (~0u)
+#define AC_INVALID_BINDLESS_INDEX (~0u)
 
 AC_DEFINE_HANDLE(ac_device);
 AC_DEFINE_HANDLE(ac_queue);
 AC_DEFINE_HANDLE(ac_cmd_pool);
 AC_DEFINE_HANDLE(ac_cmd);
 AC_DEFINE_HANDLE(ac_fence);
+AC_DEFINE_HANDLE(ac_event);
 AC_DEFINE_HANDLE(ac_swapchain);
 AC_DEFINE_HANDLE(ac_sampler);
 AC_DEFINE_HANDLE(ac_image);
@@ -40,6 +42,8 @@ AC_DEFINE_HANDLE(ac_descriptor_buffer);
 AC_DEFINE_HANDLE(ac_pipeline);
 AC_DEFINE_HANDLE(ac_as);
 AC_DEFINE_HANDLE(ac_sbt);
+AC_DEFINE_HANDLE(ac_memory);
+AC_DEFINE_HANDLE(ac_stream);
 
 typedef enum ac_device_debug_bit {
   ac_device_debug_minimal_bit = AC_BIT(0),
@@ -430,12 +434,53 @@ typedef struct ac_device_properties {
   uint32_t    as_instance_size;
 } ac_device_properties;
 
+// global descriptor table owning one space for all pipelines. shaders
+// declare arrays of samplers at s0, srv images at t0, srv buffers at
+// t[srv_image_count], uav images at u0 and uav buffers at u[uav_image_count]
+// and index them with values from ac_*_get_*_index passed in push constants
+typedef struct ac_bindless_info {
+  ac_space space;
+  uint32_t sampler_count;
+  uint32_t srv_image_count;
+  uint32_t srv_buffer_count;
+  uint32_t uav_image_count;
+  uint32_t uav_buffer_count;
+} ac_bindless_info;
+
 typedef struct ac_device_info {
   const ac_wsi*        wsi;
   ac_device_debug_bits debug_bits;
   bool                 force_vulkan;
+  // enabled when any count is set and device supports bindless
+  ac_bindless_info     bindless;
+  // size of each per frame upload region, 0 disables upload ring
+  uint64_t             upload_ring_size;
 } ac_device_info;
 
+// transient data valid until the upload frame it came from is recycled
+typedef struct ac_upload_allocation {
+  ac_buffer buffer;
+  uint64_t  offset;
+  void*     ptr;
+} ac_upload_allocation;
+
+typedef struct ac_stream_info {
+  // staging memory shared by all in flight uploads
+  uint64_t    staging_size;
+  // queue consuming uploaded resources, graphics queue when NULL
+  ac_queue    dst_queue;
+  const char* name;
+} ac_stream_info;
+
+// uploads are visible to queues waiting on fence at value. resources are
+// released from the transfer queue, the consumer records matching acquire
+// barriers: buffers from transfer writes, images from transfer_dst to the
+// layout passed at upload
+typedef struct ac_stream_ticket {
+  ac_fence fence;
+  uint64_t value;
+} ac_stream_ticket;
+
 typedef struct ac_cmd_pool_info {
   ac_queue queue;
 } ac_cmd_pool_info;
@@ -477,6 +522,10 @@ typedef struct ac_image_info {
   ac_clear_value      clear_value;
   ac_image_type       type;
   const char*         name;
+  // when set image is placed in memory at memory_offset instead of getting
+  // own allocation
+  ac_memory           memory;
+  uint64_t            memory_offset;
 } ac_image_info;
 
 typedef struct ac_buffer_info {
@@ -484,8 +533,26 @@ typedef struct ac_buffer_info {
   ac_buffer_usage_bits usage;
   ac_memory_usage      memory_usage;
   const char*          name;
+  // same as for images, memory_usage must match memory
+  ac_memory            memory;
+  uint64_t             memory_offset;
 } ac_buffer_info;
 
+typedef struct ac_memory_requirements {
+  uint64_t size;
+  uint64_t alignment;
+  // resources can share memory only if their type bits intersect
+  uint32_t type_bits;
+} ac_memory_requirements;
+
+typedef struct ac_memory_info {
+  uint64_t        size;
+  uint64_t        alignment;
+  uint32_t        type_bits;
+  ac_memory_usage memory_usage;
+  const char*     name;
+} ac_memory_info;
+
 typedef struct ac_swapchain_info {
   ac_queue          queue;
   ac_swapchain_bits bits;
@@ -723,6 +790,8 @@ typedef struct ac_descriptor_write {
   uint32_t           reg;
   ac_descriptor_type type;
   ac_descriptor*     descriptors;
+  // first array element to write
+  uint32_t           index;
 } ac_descriptor_write;
 
 typedef struct ac_buffer_image_copy {
@@ -820,6 +889,50 @@ ac_create_device(const ac_device_info* info, ac_device* device);
 AC_API void
 ac_destroy_device(ac_device device);
 
+AC_API ac_result
+ac_device_begin_upload_frame(ac_device device);
+
+AC_API ac_result
+ac_device_upload(
+  ac_device             device,
+  uint64_t              size,
+  uint64_t              alignment,
+  ac_upload_allocation* allocation);
+
+AC_API void
+ac_device_end_upload_frame(ac_device device, ac_fence fence, uint64_t value);
+
+AC_API ac_result
+ac_create_stream(
+  ac_device             device,
+  const ac_stream_info* info,
+  ac_stream*            stream);
+
+AC_API void
+ac_destroy_stream(ac_stream stream);
+
+AC_API ac_result
+ac_stream_buffer(
+  ac_stream   stream,
+  ac_buffer   dst,
+  uint64_t    offset,
+  const void* data,
+  uint64_t    size);
+
+// data rows are aligned to image_row_alignment, copy buffer_offset is ignored
+AC_API ac_result
+ac_stream_image(
+  ac_stream                   stream,
+  ac_image                    dst,
+  const ac_buffer_image_copy* copy,
+  ac_image_layout             layout,
+  const void*                 data,
+  uint64_t                    size);
+
+// submits recorded uploads, ticket covers everything streamed so far
+AC_API ac_result
+ac_stream_flush(ac_stream stream, ac_stream_ticket* ticket);
+
 AC_API ac_result
 ac_queue_wait_idle(ac_queue queue);
 
@@ -844,6 +957,12 @@ ac_signal_fence(ac_fence fence, uint64_t value);
 AC_API ac_result
 ac_wait_fence(ac_fence fence, uint64_t value);
 
+AC_API ac_result
+ac_create_event(ac_device device, ac_event* event);
+
+AC_API void
+ac_destroy_event(ac_event event);
+
 AC_API ac_result
 ac_create_swapchain(
   ac_device                device,
@@ -946,6 +1065,27 @@ ac_create_image(ac_device device, const ac_image_info* info, ac_image* image);
 AC_API void
 ac_destroy_image(ac_image image);
 
+AC_API ac_result
+ac_create_memory(
+  ac_device             device,
+  const ac_memory_info* info,
+  ac_memory*            memory);
+
+AC_API void
+ac_destroy_memory(ac_memory memory);
+
+AC_API ac_result
+ac_get_image_memory_requirements(
+  ac_device               device,
+  const ac_image_info*    info,
+  ac_memory_requirements* requirements);
+
+AC_API ac_result
+ac_get_buffer_memory_requirements(
+  ac_device               device,
+  const ac_buffer_info*   info,
+  ac_memory_requirements* requirements);
+
 AC_API void
 ac_update_set(
   ac_descriptor_buffer       buffer,
@@ -987,6 +1127,27 @@ ac_cmd_barrier(
   uint32_t                 image_barrier_count,
   const ac_image_barrier*  image_barriers);
 
+// first half of split barrier, waited on later on the same queue with the
+// same barriers. backends without events do whole barrier on wait
+AC_API void
+ac_cmd_set_event(
+  ac_cmd                   cmd,
+  ac_event                 event,
+  uint32_t                 buffer_barrier_count,
+  const ac_buffer_barrier* buffer_barriers,
+  uint32_t                 image_barrier_count,
+  const ac_image_barrier*  image_barriers);
+
+// second half of split barrier, also unsignals event so it can be set again
+AC_API void
+ac_cmd_wait_event(
+  ac_cmd                   cmd,
+  ac_event                 event,
+  uint32_t                 buffer_barrier_count,
+  const ac_buffer_barrier* buffer_barriers,
+  uint32_t                 image_barrier_count,
+  const ac_image_barrier*  image_barriers);
+
 AC_API void
 ac_cmd_set_scissor(
   ac_cmd   cmd,
@@ -1083,6 +1244,9 @@ ac_cmd_bind_set(
   ac_space             space,
   uint32_t             set);
 
+AC_API void
+ac_cmd_bind_bindless(ac_cmd cmd);
+
 AC_API void
 ac_cmd_dispatch(
   ac_cmd   cmd,
@@ -1154,6 +1318,12 @@ ac_device_support_raytracing(ac_device device);
 AC_API bool
 ac_device_support_mesh_shaders(ac_device device);
 
+AC_API bool
+ac_device_support_placed_resources(ac_device device);
+
+AC_API bool
+ac_device_support_bindless(ac_device device);
+
 AC_API ac_device_properties
 ac_device_get_properties(ac_device device);
 
@@ -1178,6 +1348,10 @@ AC_API ac_image_type
 ac_image_get_type(ac_image image);
 AC_API ac_image_info
 ac_image_get_info(ac_image image);
+AC_API uint32_t
+ac_image_get_srv_index(ac_image image);
+AC_API uint32_t
+ac_image_get_uav_index(ac_image image);
 
 AC_API ac_image
 ac_swapchain_get_image(ac_swapchain swapchain);
@@ -1191,6 +1365,15 @@ ac_buffer_get_mapped_memory(ac_buffer buffer);
 AC_API ac_buffer_info
 ac_buffer_get_info(ac_buffer buffer);
 
+AC_API uint32_t
+ac_buffer_get_srv_index(ac_buffer buffer);
+
+AC_API uint32_t
+ac_buffer_get_uav_index(ac_buffer buffer);
+
+AC_API uint32_t
+ac_sampler_get_index(ac_sampler sampler);
+
 AC_API ac_result
 ac_shader_get_workgroup(ac_shader shader, uint8_t wg[3]);
 
@@ -8,6 +8,7 @@ extern "C"
 #endif
 
 #define AC_MAX_THREAD_NAME (16)
+#define AC_MAX_JOB_THREADS (64)
 
 AC_DEFINE_HANDLE(ac_thread);
 AC_DEFINE_HANDLE(ac_mutex);
@@ -15,6 +16,9 @@ AC_DEFINE_HANDLE(ac_shared_mutex);
 AC_DEFINE_HANDLE(ac_cond);
 
 typedef ac_result (*ac_thread_function)(void*);
+typedef void (*ac_job_function)(void*);
+
+struct ac_job_waiter;
 
 typedef enum ac_thread_priority {
   ac_thread_priority_default = 0,
@@ -30,6 +34,22 @@ typedef struct ac_thread_info {
   const char*        name;
 } ac_thread_info;
 
+typedef struct ac_job {
+  ac_job_function function;
+  void*           data;
+} ac_job;
+
+// zero initialized counter is complete, every job run with it adds one
+// until it finishes. must stay alive until ac_job_wait on it returns
+typedef struct ac_job_counter {
+  volatile int64_t      value;
+  volatile int64_t      busy;
+  struct ac_job_waiter* waiters;
+} ac_job_counter;
+
+AC_API uint32_t
+ac_get_cpu_count(void);
+
 AC_API ac_result
 ac_create_thread(const ac_thread_info* info, ac_thread* thread);
 
@@ -90,6 +110,36 @@ ac_cond_broadcast(ac_cond cv);
 AC_API ac_result
 ac_cond_wait(ac_cond cv, ac_mutex mtx);
 
+// counter may be NULL
+AC_API void
+ac_job_run(const ac_job* jobs, uint32_t count, ac_job_counter* counter);
+
+// jobs are queued once dependency completes, right away when it is NULL.
+// counter may be NULL
+AC_API ac_result
+ac_job_run_after(
+  const ac_job*   jobs,
+  uint32_t        count,
+  ac_job_counter* dependency,
+  ac_job_counter* counter);
+
+// executes queued jobs until counter completes. inside job running on fiber
+// it is suspended instead and may resume on other job thread, so thread
+// locals such as allocator scopes must not be held across it
+AC_API void
+ac_job_wait(ac_job_counter* counter);
+
+AC_API bool
+ac_job_is_complete(const ac_job_counter* counter);
+
+// job threads plus one slot shared by threads outside of job system
+AC_API uint32_t
+ac_job_get_thread_count(void);
+
+// 0 outside of job threads
+AC_API uint32_t
+ac_job_get_thread_index(void);
+
 #if defined(__cplusplus)
 }
 #endif
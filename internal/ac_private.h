@@ -61,6 +61,35 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(AC_MEMORY_TAG)
+#define AC_MEMORY_TAG ac_memory_tag_core
+#endif
+
+// allocations done inside engine libraries are accounted to library tag
+#define ac_alloc(size) ac_alloc_tagged((size), AC_MEMORY_TAG)
+#define ac_calloc(size) ac_calloc_tagged((size), AC_MEMORY_TAG)
+#define ac_realloc(p, size) ac_realloc_tagged((p), (size), AC_MEMORY_TAG)
+#define ac_aligned_alloc(size, alignment)                                      \
+  ac_aligned_alloc_tagged((size), (alignment), AC_MEMORY_TAG)
+
+// hashmap callbacks take no user data, every translation unit gets its own
+// copy bound to its tag
+static inline void*
+ac_hashmap_alloc(size_t size)
+{
+  return ac_alloc(size);
+}
+
+static inline void*
+ac_hashmap_realloc(void* p, size_t size)
+{
+  return ac_realloc(p, size);
+}
+
 #include <c_hashmap/c_hashmap.h>
 #include <c_array/c_array.h>
 
@@ -76,6 +105,128 @@
 
 #define AC_MIN_THREAD_STACK_SIZE 16384
 
+static inline uint64_t
+ac_atomic_add_u64(volatile uint64_t* p, uint64_t value)
+{
+#if defined(_MSC_VER)
+  return (uint64_t)_InterlockedExchangeAdd64(
+           (volatile int64_t*)p,
+           (int64_t)value) +
+         value;
+#else
+  return __atomic_add_fetch(p, value, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline uint64_t
+ac_atomic_load_u64(const volatile uint64_t* p)
+{
+#if defined(_MSC_VER)
+  return *p;
+#else
+  return __atomic_load_n(p, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void
+ac_atomic_max_u64(volatile uint64_t* p, uint64_t value)
+{
+  uint64_t current = ac_atomic_load_u64(p);
+  while (current < value)
+  {
+#if defined(_MSC_VER)
+    uint64_t prev = (uint64_t)_InterlockedCompareExchange64(
+      (volatile int64_t*)p,
+      (int64_t)value,
+      (int64_t)current);
+    if (prev == current)
+    {
+      break;
+    }
+    current = prev;
+#else
+    if (__atomic_compare_exchange_n(
+          p,
+          &current,
+          value,
+          true,
+          __ATOMIC_RELAXED,
+          __ATOMIC_RELAXED))
+    {
+      break;
+    }
+#endif
+  }
+}
+
+// operations below are sequentially consistent
+static inline int64_t
+ac_atomic_load_i64(const volatile int64_t* p)
+{
+#if defined(_MSC_VER)
+  int64_t value = *p;
+  _ReadWriteBarrier();
+  return value;
+#else
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void
+ac_atomic_store_i64(volatile int64_t* p, int64_t value)
+{
+#if defined(_MSC_VER)
+  (void)_InterlockedExchange64(p, value);
+#else
+  __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline int64_t
+ac_atomic_add_i64(volatile int64_t* p, int64_t value)
+{
+#if defined(_MSC_VER)
+  return _InterlockedExchangeAdd64(p, value) + value;
+#else
+  return __atomic_add_fetch(p, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline bool
+ac_atomic_cas_i64(volatile int64_t* p, int64_t expected, int64_t desired)
+{
+#if defined(_MSC_VER)
+  return _InterlockedCompareExchange64(p, desired, expected) == expected;
+#else
+  return __atomic_compare_exchange_n(
+    p,
+    &expected,
+    desired,
+    false,
+    __ATOMIC_SEQ_CST,
+    __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void
+ac_atomic_fence(void)
+{
+#if defined(_MSC_VER)
+  volatile int64_t barrier = 0;
+  (void)_InterlockedOr64(&barrier, 0);
+#else
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+#if defined(_MSC_VER)
+#define AC_THREAD_LOCAL __declspec(thread)
+#elif defined(__cplusplus)
+#define AC_THREAD_LOCAL thread_local
+#else
+#define AC_THREAD_LOCAL _Thread_local
+#endif
+
 static inline void*
 ac_const_cast(const void* p)
 {
@@ -107,6 +258,10 @@ ac_const_cast(const void* p)
 #define AC_INCLUDE_VULKAN 0
 #endif
 
+AC_DEFINE_HANDLE(ac_fiber);
+
+typedef void (*ac_fiber_function)(void*);
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -133,6 +288,32 @@ ac_init_fs(const ac_init_info* info);
 void
 ac_shutdown_fs(void);
 
+ac_result
+ac_init_jobs(const ac_init_info* info);
+
+void
+ac_shutdown_jobs(void);
+
+// calling thread becomes fiber, so other fibers can switch back to it.
+// must be destroyed on same thread
+ac_result
+ac_create_thread_fiber(ac_fiber* fiber);
+
+// function must never return, fiber switches away instead
+ac_result
+ac_create_fiber(
+  uint32_t          stack_size,
+  ac_fiber_function function,
+  void*             data,
+  ac_fiber*         fiber);
+
+void
+ac_destroy_fiber(ac_fiber fiber);
+
+// saves current context into from and continues to
+void
+ac_switch_fiber(ac_fiber from, ac_fiber to);
+
 #if defined(__cplusplus)
 }
 #endif
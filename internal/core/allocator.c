@@ -0,0 +1,833 @@
+#include "ac_private.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define AC_MIN_ALIGNMENT 16
+
+// objects either own memory taken from current allocator or live at start
+// of memory given by user
+static void*
+ac_allocator_place(
+  void*   memory,
+  size_t  size,
+  size_t  object_size,
+  void**  out_begin,
+  size_t* out_size)
+{
+  uint8_t* begin = memory;
+  if (!begin)
+  {
+    begin = ac_alloc(object_size + size);
+    if (!begin)
+    {
+      return NULL;
+    }
+    memset(begin, 0, object_size);
+    *out_begin = begin + object_size;
+    *out_size = size;
+    return begin;
+  }
+
+  uint8_t* object =
+    (uint8_t*)AC_ALIGN_UP((uintptr_t)begin, (uintptr_t)AC_MIN_ALIGNMENT);
+  uint8_t* end = begin + size;
+  if (object + object_size > end)
+  {
+    return NULL;
+  }
+
+  memset(object, 0, object_size);
+  *out_begin = object + object_size;
+  *out_size = (size_t)(end - (object + object_size));
+  return object;
+}
+
+typedef struct ac_arena_internal {
+  uint8_t* memory;
+  size_t   size;
+  size_t   offset;
+  size_t   last;
+  bool     owns_memory;
+} ac_arena_internal;
+
+AC_API ac_result
+ac_create_arena(const ac_arena_info* info, ac_arena* arena_handle)
+{
+  void*  memory;
+  size_t size;
+
+  ac_arena_internal* arena = ac_allocator_place(
+    info->memory,
+    info->size,
+    AC_ALIGN_UP(sizeof(ac_arena_internal), AC_MIN_ALIGNMENT),
+    &memory,
+    &size);
+  if (!arena)
+  {
+    return info->memory ? ac_result_invalid_argument
+                        : ac_result_out_of_host_memory;
+  }
+
+  arena->memory = memory;
+  arena->size = size;
+  arena->owns_memory = info->memory == NULL;
+
+  *arena_handle = (ac_arena)arena;
+  return ac_result_success;
+}
+
+AC_API void
+ac_destroy_arena(ac_arena arena_handle)
+{
+  if (!arena_handle)
+  {
+    return;
+  }
+
+  AC_FROM_HANDLE(arena, ac_arena_internal);
+  if (arena->owns_memory)
+  {
+    ac_free(arena);
+  }
+}
+
+AC_API void*
+ac_arena_alloc(ac_arena arena_handle, size_t size, size_t alignment)
+{
+  AC_FROM_HANDLE(arena, ac_arena_internal);
+
+  alignment = AC_MAX(alignment, 1);
+
+  uintptr_t base = (uintptr_t)arena->memory;
+  size_t    offset =
+    (size_t)(AC_ALIGN_UP(base + arena->offset, (uintptr_t)alignment) - base);
+
+  if (offset > arena->size || arena->size - offset < size)
+  {
+    return NULL;
+  }
+
+  arena->last = offset;
+  arena->offset = offset + size;
+  return arena->memory + offset;
+}
+
+AC_API void
+ac_arena_reset(ac_arena arena_handle)
+{
+  AC_FROM_HANDLE(arena, ac_arena_internal);
+  arena->offset = 0;
+  arena->last = 0;
+}
+
+static void*
+ac_arena_cb_alloc(void* user_data, size_t size, size_t alignment)
+{
+  return ac_arena_alloc(user_data, size, alignment);
+}
+
+// last allocation grows in place, others are copied to the top of arena
+static void*
+ac_arena_cb_realloc(void* user_data, void* p, size_t size, size_t alignment)
+{
+  ac_arena arena_handle = user_data;
+  AC_FROM_HANDLE(arena, ac_arena_internal);
+
+  size_t offset = (size_t)((uint8_t*)p - arena->memory);
+  if (offset == arena->last && arena->size - offset >= size)
+  {
+    arena->offset = offset + size;
+    return p;
+  }
+
+  size_t old_size = arena->offset - offset;
+
+  void* ptr = ac_arena_alloc(arena_handle, size, alignment);
+  if (ptr)
+  {
+    memcpy(ptr, p, AC_MIN(size, old_size));
+  }
+  return ptr;
+}
+
+// only last allocation is given back, everything else waits for reset
+static void
+ac_arena_cb_free(void* user_data, void* p)
+{
+  ac_arena arena_handle = user_data;
+  AC_FROM_HANDLE(arena, ac_arena_internal);
+
+  if ((uint8_t*)p == arena->memory + arena->last)
+  {
+    arena->offset = arena->last;
+  }
+}
+
+AC_API void
+ac_arena_get_allocator(ac_arena arena, ac_allocator* allocator)
+{
+  *allocator = (ac_allocator) {
+    .user_data = arena,
+    .cb_alloc = ac_arena_cb_alloc,
+    .cb_realloc = ac_arena_cb_realloc,
+    .cb_free = ac_arena_cb_free,
+  };
+}
+
+typedef struct ac_pool_internal {
+  uint8_t* memory;
+  size_t   block_size;
+  size_t   block_count;
+  void*    free_list;
+  bool     owns_memory;
+} ac_pool_internal;
+
+AC_API ac_result
+ac_create_pool(const ac_pool_info* info, ac_pool* pool_handle)
+{
+  AC_ASSERT(info->block_size);
+
+  void*  memory;
+  size_t size;
+
+  ac_pool_internal* pool = ac_allocator_place(
+    info->memory,
+    info->size,
+    AC_ALIGN_UP(sizeof(ac_pool_internal), AC_MIN_ALIGNMENT),
+    &memory,
+    &size);
+  if (!pool)
+  {
+    return info->memory ? ac_result_invalid_argument
+                        : ac_result_out_of_host_memory;
+  }
+
+  pool->memory = memory;
+  pool->block_size = AC_ALIGN_UP(
+    AC_MAX(info->block_size, sizeof(void*)),
+    (size_t)AC_MIN_ALIGNMENT);
+  pool->block_count = size / pool->block_size;
+  pool->owns_memory = info->memory == NULL;
+
+  for (size_t i = pool->block_count; i > 0; --i)
+  {
+    void** block = (void**)(pool->memory + (i - 1) * pool->block_size);
+    *block = pool->free_list;
+    pool->free_list = block;
+  }
+
+  *pool_handle = (ac_pool)pool;
+  return ac_result_success;
+}
+
+AC_API void
+ac_destroy_pool(ac_pool pool_handle)
+{
+  if (!pool_handle)
+  {
+    return;
+  }
+
+  AC_FROM_HANDLE(pool, ac_pool_internal);
+  if (pool->owns_memory)
+  {
+    ac_free(pool);
+  }
+}
+
+AC_API void*
+ac_pool_alloc(ac_pool pool_handle)
+{
+  AC_FROM_HANDLE(pool, ac_pool_internal);
+
+  void** block = pool->free_list;
+  if (block)
+  {
+    pool->free_list = *block;
+  }
+  return block;
+}
+
+AC_API void
+ac_pool_free(ac_pool pool_handle, void* p)
+{
+  if (!p)
+  {
+    return;
+  }
+
+  AC_FROM_HANDLE(pool, ac_pool_internal);
+  AC_ASSERT(
+    (uint8_t*)p >= pool->memory &&
+    (uint8_t*)p < pool->memory + pool->block_count * pool->block_size);
+
+  *(void**)p = pool->free_list;
+  pool->free_list = p;
+}
+
+static void*
+ac_pool_cb_alloc(void* user_data, size_t size, size_t alignment)
+{
+  ac_pool pool_handle = user_data;
+  AC_FROM_HANDLE(pool, ac_pool_internal);
+
+  if (size > pool->block_size || alignment > AC_MIN_ALIGNMENT)
+  {
+    return NULL;
+  }
+  return ac_pool_alloc(pool_handle);
+}
+
+static void*
+ac_pool_cb_realloc(void* user_data, void* p, size_t size, size_t alignment)
+{
+  ac_pool pool_handle = user_data;
+  AC_FROM_HANDLE(pool, ac_pool_internal);
+
+  if (size > pool->block_size || alignment > AC_MIN_ALIGNMENT)
+  {
+    return NULL;
+  }
+  return p;
+}
+
+static void
+ac_pool_cb_free(void* user_data, void* p)
+{
+  ac_pool_free(user_data, p);
+}
+
+AC_API void
+ac_pool_get_allocator(ac_pool pool, ac_allocator* allocator)
+{
+  *allocator = (ac_allocator) {
+    .user_data = pool,
+    .cb_alloc = ac_pool_cb_alloc,
+    .cb_realloc = ac_pool_cb_realloc,
+    .cb_free = ac_pool_cb_free,
+  };
+}
+
+// two level segregated fit heap. free blocks are kept in lists by size
+// class, first level is power of two and second level splits it linearly,
+// bitmaps give suitable list in constant time
+#define AC_HEAP_SL_LOG2 4
+#define AC_HEAP_SL_COUNT (1u << AC_HEAP_SL_LOG2)
+#define AC_HEAP_FL_SHIFT (AC_HEAP_SL_LOG2 + 4)
+#define AC_HEAP_FL_MAX 40
+#define AC_HEAP_FL_COUNT (AC_HEAP_FL_MAX - AC_HEAP_FL_SHIFT + 1)
+#define AC_HEAP_SMALL_BLOCK ((size_t)1 << AC_HEAP_FL_SHIFT)
+
+#define AC_HEAP_BLOCK_FREE ((size_t)1)
+#define AC_HEAP_BLOCK_PREV_FREE ((size_t)2)
+#define AC_HEAP_BLOCK_FLAGS (AC_HEAP_BLOCK_FREE | AC_HEAP_BLOCK_PREV_FREE)
+
+typedef struct ac_heap_block {
+  // valid only when previous block is free
+  struct ac_heap_block* prev_phys;
+  // payload size, low bits are flags
+  size_t                size;
+  // payload of free block
+  struct ac_heap_block* next_free;
+  struct ac_heap_block* prev_free;
+} ac_heap_block;
+
+#define AC_HEAP_BLOCK_HEADER (offsetof(ac_heap_block, next_free))
+#define AC_HEAP_MIN_BLOCK (sizeof(ac_heap_block) - AC_HEAP_BLOCK_HEADER)
+
+typedef struct ac_heap_internal {
+  ac_heap_block* free_lists[AC_HEAP_FL_COUNT][AC_HEAP_SL_COUNT];
+  uint32_t       sl_bitmaps[AC_HEAP_FL_COUNT];
+  uint64_t       fl_bitmap;
+  ac_mutex       mtx;
+  bool           owns_memory;
+} ac_heap_internal;
+
+static inline uint32_t
+ac_heap_ffs(uint64_t value)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return (uint32_t)index;
+#else
+  return (uint32_t)__builtin_ctzll(value);
+#endif
+}
+
+static inline uint32_t
+ac_heap_fls(uint64_t value)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return (uint32_t)index;
+#else
+  return 63 - (uint32_t)__builtin_clzll(value);
+#endif
+}
+
+static inline size_t
+ac_heap_block_size(const ac_heap_block* block)
+{
+  return block->size & ~AC_HEAP_BLOCK_FLAGS;
+}
+
+static inline void*
+ac_heap_block_payload(ac_heap_block* block)
+{
+  return (uint8_t*)block + AC_HEAP_BLOCK_HEADER;
+}
+
+static inline ac_heap_block*
+ac_heap_block_from_payload(void* p)
+{
+  return (ac_heap_block*)((uint8_t*)p - AC_HEAP_BLOCK_HEADER);
+}
+
+static inline ac_heap_block*
+ac_heap_block_next(ac_heap_block* block)
+{
+  return (ac_heap_block*)((uint8_t*)ac_heap_block_payload(block) +
+                          ac_heap_block_size(block));
+}
+
+static inline void
+ac_heap_block_set_size(ac_heap_block* block, size_t size)
+{
+  block->size = size | (block->size & AC_HEAP_BLOCK_FLAGS);
+}
+
+// marks block free or used and tells next physical block about it
+static inline void
+ac_heap_block_mark(ac_heap_block* block, bool free)
+{
+  ac_heap_block* next = ac_heap_block_next(block);
+  if (free)
+  {
+    block->size |= AC_HEAP_BLOCK_FREE;
+    next->size |= AC_HEAP_BLOCK_PREV_FREE;
+    next->prev_phys = block;
+  }
+  else
+  {
+    block->size &= ~AC_HEAP_BLOCK_FREE;
+    next->size &= ~AC_HEAP_BLOCK_PREV_FREE;
+  }
+}
+
+static inline void
+ac_heap_mapping(size_t size, uint32_t* fl, uint32_t* sl)
+{
+  if (size < AC_HEAP_SMALL_BLOCK)
+  {
+    *fl = 0;
+    *sl = (uint32_t)(size / (AC_HEAP_SMALL_BLOCK / AC_HEAP_SL_COUNT));
+    return;
+  }
+
+  uint32_t bit = ac_heap_fls(size);
+  *sl = (uint32_t)(size >> (bit - AC_HEAP_SL_LOG2)) ^ AC_HEAP_SL_COUNT;
+  *fl = bit - (AC_HEAP_FL_SHIFT - 1);
+}
+
+static void
+ac_heap_insert(ac_heap_internal* heap, ac_heap_block* block)
+{
+  uint32_t fl, sl;
+  ac_heap_mapping(ac_heap_block_size(block), &fl, &sl);
+
+  ac_heap_block* head = heap->free_lists[fl][sl];
+  block->next_free = head;
+  block->prev_free = NULL;
+  if (head)
+  {
+    head->prev_free = block;
+  }
+
+  heap->free_lists[fl][sl] = block;
+  heap->fl_bitmap |= (uint64_t)1 << fl;
+  heap->sl_bitmaps[fl] |= 1u << sl;
+}
+
+static void
+ac_heap_remove(ac_heap_internal* heap, ac_heap_block* block)
+{
+  uint32_t fl, sl;
+  ac_heap_mapping(ac_heap_block_size(block), &fl, &sl);
+
+  if (block->next_free)
+  {
+    block->next_free->prev_free = block->prev_free;
+  }
+
+  if (block->prev_free)
+  {
+    block->prev_free->next_free = block->next_free;
+    return;
+  }
+
+  heap->free_lists[fl][sl] = block->next_free;
+  if (!block->next_free)
+  {
+    heap->sl_bitmaps[fl] &= ~(1u << sl);
+    if (!heap->sl_bitmaps[fl])
+    {
+      heap->fl_bitmap &= ~((uint64_t)1 << fl);
+    }
+  }
+}
+
+// first block from list whose every block fits size
+static ac_heap_block*
+ac_heap_find(ac_heap_internal* heap, size_t size)
+{
+  if (size >= AC_HEAP_SMALL_BLOCK)
+  {
+    size += ((size_t)1 << (ac_heap_fls(size) - AC_HEAP_SL_LOG2)) - 1;
+  }
+
+  uint32_t fl, sl;
+  ac_heap_mapping(size, &fl, &sl);
+  if (fl >= AC_HEAP_FL_COUNT)
+  {
+    return NULL;
+  }
+
+  uint32_t sl_map = heap->sl_bitmaps[fl] & (~0u << sl);
+  if (!sl_map)
+  {
+    uint64_t fl_map = heap->fl_bitmap & (~(uint64_t)0 << (fl + 1));
+    if (!fl_map)
+    {
+      return NULL;
+    }
+
+    fl = ac_heap_ffs(fl_map);
+    sl_map = heap->sl_bitmaps[fl];
+  }
+
+  return heap->free_lists[fl][ac_heap_ffs(sl_map)];
+}
+
+// splits tail of used block off into free block
+static void
+ac_heap_trim(ac_heap_internal* heap, ac_heap_block* block, size_t size)
+{
+  size_t block_size = ac_heap_block_size(block);
+  if (block_size < size + sizeof(ac_heap_block))
+  {
+    return;
+  }
+
+  ac_heap_block_set_size(block, size);
+
+  ac_heap_block* rest = ac_heap_block_next(block);
+  rest->size = block_size - size - AC_HEAP_BLOCK_HEADER;
+
+  ac_heap_block* next = ac_heap_block_next(rest);
+  if (next->size & AC_HEAP_BLOCK_FREE)
+  {
+    ac_heap_remove(heap, next);
+    ac_heap_block_set_size(
+      rest,
+      ac_heap_block_size(rest) + AC_HEAP_BLOCK_HEADER +
+        ac_heap_block_size(next));
+  }
+
+  ac_heap_block_mark(rest, true);
+  ac_heap_insert(heap, rest);
+}
+
+static inline size_t
+ac_heap_adjust_size(size_t size)
+{
+  return AC_ALIGN_UP(AC_MAX(size, AC_HEAP_MIN_BLOCK), (size_t)AC_MIN_ALIGNMENT);
+}
+
+static void*
+ac_heap_alloc_locked(ac_heap_internal* heap, size_t size, size_t alignment)
+{
+  size = ac_heap_adjust_size(size);
+
+  // room to move payload to alignment and leave free block in front
+  size_t gap = alignment > AC_MIN_ALIGNMENT
+                 ? alignment + sizeof(ac_heap_block)
+                 : 0;
+
+  ac_heap_block* block = ac_heap_find(heap, size + gap);
+  if (!block)
+  {
+    return NULL;
+  }
+
+  ac_heap_remove(heap, block);
+  ac_heap_block_mark(block, false);
+
+  if (gap)
+  {
+    uintptr_t payload = (uintptr_t)ac_heap_block_payload(block);
+    uintptr_t aligned = AC_ALIGN_UP(payload, (uintptr_t)alignment);
+    while (aligned != payload && aligned - payload < sizeof(ac_heap_block))
+    {
+      aligned += alignment;
+    }
+
+    if (aligned != payload)
+    {
+      size_t         lead = aligned - payload;
+      ac_heap_block* moved = ac_heap_block_from_payload((void*)aligned);
+
+      moved->size = ac_heap_block_size(block) - lead;
+      ac_heap_block_set_size(block, lead - AC_HEAP_BLOCK_HEADER);
+
+      ac_heap_block_mark(block, true);
+      ac_heap_insert(heap, block);
+      moved->size |= AC_HEAP_BLOCK_PREV_FREE;
+      block = moved;
+    }
+  }
+
+  ac_heap_trim(heap, block, size);
+  return ac_heap_block_payload(block);
+}
+
+static void
+ac_heap_free_locked(ac_heap_internal* heap, void* p)
+{
+  ac_heap_block* block = ac_heap_block_from_payload(p);
+  AC_ASSERT(!(block->size & AC_HEAP_BLOCK_FREE));
+
+  if (block->size & AC_HEAP_BLOCK_PREV_FREE)
+  {
+    ac_heap_block* prev = block->prev_phys;
+    ac_heap_remove(heap, prev);
+    ac_heap_block_set_size(
+      prev,
+      ac_heap_block_size(prev) + AC_HEAP_BLOCK_HEADER +
+        ac_heap_block_size(block));
+    block = prev;
+  }
+
+  ac_heap_block* next = ac_heap_block_next(block);
+  if (next->size & AC_HEAP_BLOCK_FREE)
+  {
+    ac_heap_remove(heap, next);
+    ac_heap_block_set_size(
+      block,
+      ac_heap_block_size(block) + AC_HEAP_BLOCK_HEADER +
+        ac_heap_block_size(next));
+  }
+
+  ac_heap_block_mark(block, true);
+  ac_heap_insert(heap, block);
+}
+
+static void*
+ac_heap_realloc_locked(
+  ac_heap_internal* heap,
+  void*             p,
+  size_t            size,
+  size_t            alignment)
+{
+  ac_heap_block* block = ac_heap_block_from_payload(p);
+  size_t         adjusted = ac_heap_adjust_size(size);
+  size_t         current = ac_heap_block_size(block);
+
+  if (adjusted > current)
+  {
+    ac_heap_block* next = ac_heap_block_next(block);
+    if (
+      !(next->size & AC_HEAP_BLOCK_FREE) ||
+      current + AC_HEAP_BLOCK_HEADER + ac_heap_block_size(next) < adjusted)
+    {
+      void* ptr = ac_heap_alloc_locked(heap, size, alignment);
+      if (ptr)
+      {
+        memcpy(ptr, p, current);
+        ac_heap_free_locked(heap, p);
+      }
+      return ptr;
+    }
+
+    ac_heap_remove(heap, next);
+    ac_heap_block_set_size(
+      block,
+      current + AC_HEAP_BLOCK_HEADER + ac_heap_block_size(next));
+    ac_heap_block_mark(block, false);
+  }
+
+  ac_heap_trim(heap, block, adjusted);
+  return p;
+}
+
+AC_API ac_result
+ac_create_heap(const ac_heap_info* info, ac_heap* heap_handle)
+{
+  void*  memory;
+  size_t size;
+
+  ac_heap_internal* heap = ac_allocator_place(
+    info->memory,
+    info->size,
+    AC_ALIGN_UP(sizeof(ac_heap_internal), AC_MIN_ALIGNMENT),
+    &memory,
+    &size);
+  if (!heap)
+  {
+    return info->memory ? ac_result_invalid_argument
+                        : ac_result_out_of_host_memory;
+  }
+
+  heap->owns_memory = info->memory == NULL;
+
+  // one free block followed by empty used sentinel
+  size_t overhead = AC_HEAP_BLOCK_HEADER * 2;
+  size = size > overhead ? (size - overhead) & ~(size_t)(AC_MIN_ALIGNMENT - 1)
+                         : 0;
+  if (size < AC_HEAP_MIN_BLOCK || size >= ((size_t)1 << AC_HEAP_FL_MAX))
+  {
+    if (heap->owns_memory)
+    {
+      ac_free(heap);
+    }
+    return ac_result_invalid_argument;
+  }
+
+  if (info->thread_safe)
+  {
+    ac_create_mutex(&heap->mtx);
+  }
+
+  ac_heap_block* block = memory;
+  block->size = size;
+
+  ac_heap_block* sentinel = ac_heap_block_next(block);
+  sentinel->size = 0;
+
+  ac_heap_block_mark(block, true);
+  ac_heap_insert(heap, block);
+
+  *heap_handle = (ac_heap)heap;
+  return ac_result_success;
+}
+
+AC_API void
+ac_destroy_heap(ac_heap heap_handle)
+{
+  if (!heap_handle)
+  {
+    return;
+  }
+
+  AC_FROM_HANDLE(heap, ac_heap_internal);
+
+  if (heap->mtx)
+  {
+    ac_destroy_mutex(heap->mtx);
+  }
+
+  if (heap->owns_memory)
+  {
+    ac_free(heap);
+  }
+}
+
+AC_API void*
+ac_heap_alloc(ac_heap heap_handle, size_t size, size_t alignment)
+{
+  AC_FROM_HANDLE(heap, ac_heap_internal);
+
+  if (heap->mtx)
+  {
+    ac_mutex_lock(heap->mtx);
+  }
+
+  void* ptr = ac_heap_alloc_locked(heap, size, alignment);
+
+  if (heap->mtx)
+  {
+    ac_mutex_unlock(heap->mtx);
+  }
+
+  return ptr;
+}
+
+AC_API void*
+ac_heap_realloc(ac_heap heap_handle, void* p, size_t size, size_t alignment)
+{
+  if (!p)
+  {
+    return ac_heap_alloc(heap_handle, size, alignment);
+  }
+
+  AC_FROM_HANDLE(heap, ac_heap_internal);
+
+  if (heap->mtx)
+  {
+    ac_mutex_lock(heap->mtx);
+  }
+
+  void* ptr = ac_heap_realloc_locked(heap, p, size, alignment);
+
+  if (heap->mtx)
+  {
+    ac_mutex_unlock(heap->mtx);
+  }
+
+  return ptr;
+}
+
+AC_API void
+ac_heap_free(ac_heap heap_handle, void* p)
+{
+  if (!p)
+  {
+    return;
+  }
+
+  AC_FROM_HANDLE(heap, ac_heap_internal);
+
+  if (heap->mtx)
+  {
+    ac_mutex_lock(heap->mtx);
+  }
+
+  ac_heap_free_locked(heap, p);
+
+  if (heap->mtx)
+  {
+    ac_mutex_unlock(heap->mtx);
+  }
+}
+
+static void*
+ac_heap_cb_alloc(void* user_data, size_t size, size_t alignment)
+{
+  return ac_heap_alloc(user_data, size, alignment);
+}
+
+static void*
+ac_heap_cb_realloc(void* user_data, void* p, size_t size, size_t alignment)
+{
+  return ac_heap_realloc(user_data, p, size, alignment);
+}
+
+static void
+ac_heap_cb_free(void* user_data, void* p)
+{
+  ac_heap_free(user_data, p);
+}
+
+AC_API void
+ac_heap_get_allocator(ac_heap heap, ac_allocator* allocator)
+{
+  *allocator = (ac_allocator) {
+    .user_data = heap,
+    .cb_alloc = ac_heap_cb_alloc,
+    .cb_realloc = ac_heap_cb_realloc,
+    .cb_free = ac_heap_cb_free,
+  };
+}
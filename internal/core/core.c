@@ -10,16 +10,177 @@
 #include "memory_manager.h"
 #endif
 
-AC_API void*
-ac_alloc(size_t size)
+#undef ac_alloc
+#undef ac_calloc
+#undef ac_realloc
+#undef ac_aligned_alloc
+
+typedef struct ac_allocation_header {
+  const ac_allocator* allocator;
+  size_t              size;
+  uint32_t            offset;
+  uint32_t            alignment;
+  uint32_t            tag;
+} ac_allocation_header;
+
+AC_STATIC_ASSERT(sizeof(ac_allocation_header) <= AC_ALLOCATION_HEADER_SIZE);
+
+typedef struct ac_memory_tag_counters {
+  volatile uint64_t live_bytes;
+  volatile uint64_t peak_bytes;
+  volatile uint64_t live_allocations;
+  volatile uint64_t total_allocations;
+} ac_memory_tag_counters;
+
+static ac_memory_tag_counters ac_memory_counters[AC_MAX_MEMORY_TAGS];
+
+static void*
+ac_system_alloc(void* user_data, size_t size, size_t alignment)
 {
-  void* ptr = NULL;
+  AC_UNUSED(user_data);
+#if (AC_PLATFORM_WINDOWS) || (AC_PLATFORM_XBOX)
+  return _aligned_malloc(size, alignment);
+#else
+  if (alignment <= 16)
+  {
+    return malloc(size);
+  }
+  return aligned_alloc(alignment, AC_ALIGN_UP(size, alignment));
+#endif
+}
+
+static void*
+ac_system_realloc(void* user_data, void* p, size_t size, size_t alignment)
+{
+  AC_UNUSED(user_data);
+#if (AC_PLATFORM_WINDOWS) || (AC_PLATFORM_XBOX)
+  return _aligned_realloc(p, size, alignment);
+#else
+  if (alignment > 16)
+  {
+    return NULL;
+  }
+  return realloc(p, size);
+#endif
+}
 
+static void
+ac_system_free(void* user_data, void* p)
+{
+  AC_UNUSED(user_data);
 #if (AC_PLATFORM_WINDOWS) || (AC_PLATFORM_XBOX)
-  ptr = _aligned_malloc(size, 2);
+  _aligned_free(p);
 #else
-  ptr = malloc(size);
+  free(p);
 #endif
+}
+
+static const ac_allocator ac_system_allocator = {
+  .cb_alloc = ac_system_alloc,
+  .cb_realloc = ac_system_realloc,
+  .cb_free = ac_system_free,
+};
+
+static struct {
+  ac_allocator        installed;
+  const ac_allocator* global;
+} ac_allocators = {
+  .global = &ac_system_allocator,
+};
+
+static AC_THREAD_LOCAL const ac_allocator*
+  ac_allocator_scopes[AC_MAX_ALLOCATOR_SCOPES];
+static AC_THREAD_LOCAL uint32_t ac_allocator_scope_count;
+
+static inline const ac_allocator*
+ac_current_allocator(void)
+{
+  if (ac_allocator_scope_count)
+  {
+    return ac_allocator_scopes[ac_allocator_scope_count - 1];
+  }
+  return ac_allocators.global;
+}
+
+static inline ac_allocation_header*
+ac_get_allocation_header(void* p)
+{
+  return (ac_allocation_header*)p - 1;
+}
+
+static inline void
+ac_memory_counters_add(uint32_t tag, size_t size)
+{
+  ac_memory_tag_counters* counters = &ac_memory_counters[tag];
+
+  uint64_t live = ac_atomic_add_u64(&counters->live_bytes, size);
+  ac_atomic_max_u64(&counters->peak_bytes, live);
+  ac_atomic_add_u64(&counters->live_allocations, 1);
+  ac_atomic_add_u64(&counters->total_allocations, 1);
+}
+
+static inline void
+ac_memory_counters_remove(uint32_t tag, size_t size)
+{
+  ac_memory_tag_counters* counters = &ac_memory_counters[tag];
+
+  ac_atomic_add_u64(&counters->live_bytes, 0 - (uint64_t)size);
+  ac_atomic_add_u64(&counters->live_allocations, ~(uint64_t)0);
+}
+
+static inline void
+ac_memory_counters_resize(uint32_t tag, size_t old_size, size_t size)
+{
+  ac_memory_tag_counters* counters = &ac_memory_counters[tag];
+
+  uint64_t live =
+    ac_atomic_add_u64(&counters->live_bytes, (uint64_t)size - old_size);
+  ac_atomic_max_u64(&counters->peak_bytes, live);
+}
+
+static void*
+ac_alloc_internal(
+  const ac_allocator* allocator,
+  size_t              size,
+  size_t              alignment,
+  uint32_t            tag)
+{
+  // counters are indexed by tag, so bad tag must not reach them in release
+  AC_ASSERT(tag < AC_MAX_MEMORY_TAGS);
+  if (tag >= AC_MAX_MEMORY_TAGS)
+  {
+    tag = ac_memory_tag_application;
+  }
+
+  size_t offset = AC_MAX(alignment, AC_ALLOCATION_HEADER_SIZE);
+
+  uint8_t* block = allocator->cb_alloc(
+    allocator->user_data,
+    size + offset,
+    AC_MAX(alignment, 16));
+  if (!block)
+  {
+    return NULL;
+  }
+
+  void* ptr = block + offset;
+
+  ac_allocation_header* header = ac_get_allocation_header(ptr);
+  header->allocator = allocator;
+  header->size = size;
+  header->offset = (uint32_t)offset;
+  header->alignment = (uint32_t)alignment;
+  header->tag = tag;
+
+  ac_memory_counters_add(tag, size);
+
+  return ptr;
+}
+
+AC_API void*
+ac_alloc_tagged(size_t size, ac_memory_tag tag)
+{
+  void* ptr = ac_alloc_internal(ac_current_allocator(), size, 16, tag);
 
 #if (AC_INCLUDE_DEBUG)
   ac_memory_manager_register_allocation(ptr, size);
@@ -29,11 +190,9 @@ ac_alloc(size_t size)
 }
 
 AC_API void*
-ac_calloc(size_t size)
+ac_calloc_tagged(size_t size, ac_memory_tag tag)
 {
-  void* ptr = NULL;
-#if (AC_PLATFORM_WINDOWS) || (AC_PLATFORM_XBOX)
-  ptr = _aligned_malloc(size, 2);
+  void* ptr = ac_alloc_internal(ac_current_allocator(), size, 16, tag);
   if (!ptr)
   {
     return ptr;
@@ -41,10 +200,6 @@ ac_calloc(size_t size)
 
   memset(ptr, 0, size);
 
-#else
-  ptr = calloc(1, size);
-#endif
-
 #if (AC_INCLUDE_DEBUG)
   ac_memory_manager_register_allocation(ptr, size);
 #endif
@@ -53,19 +208,65 @@ ac_calloc(size_t size)
 }
 
 AC_API void*
-ac_realloc(void* p, size_t size)
+ac_realloc_tagged(void* p, size_t size, ac_memory_tag tag)
 {
+  if (!p)
+  {
+    return ac_alloc_tagged(size, tag);
+  }
+
+  ac_allocation_header* header = ac_get_allocation_header(p);
+  const ac_allocator*   allocator = header->allocator;
+  size_t                offset = header->offset;
+  size_t                alignment = header->alignment;
+  size_t                old_size = header->size;
+  uint32_t              old_tag = header->tag;
+  uint8_t*              block = (uint8_t*)p - offset;
+
   void* ptr = NULL;
 
+  if (allocator->cb_realloc)
+  {
+    uint8_t* new_block = allocator->cb_realloc(
+      allocator->user_data,
+      block,
+      size + offset,
+      AC_MAX(alignment, 16));
+    if (new_block)
+    {
+      ptr = new_block + offset;
+      ac_get_allocation_header(ptr)->size = size;
+      ac_memory_counters_resize(old_tag, old_size, size);
+    }
+  }
+
+  if (!ptr)
+  {
+    ptr = ac_alloc_internal(allocator, size, alignment, old_tag);
+    if (!ptr)
+    {
+      return NULL;
+    }
+
+    memcpy(ptr, p, AC_MIN(size, old_size));
+    ac_memory_counters_remove(old_tag, old_size);
+    allocator->cb_free(allocator->user_data, block);
+  }
+
 #if (AC_INCLUDE_DEBUG)
   ac_memory_manager_register_deallocation(p);
+  ac_memory_manager_register_allocation(ptr, size);
 #endif
 
-#if (AC_PLATFORM_WINDOWS) || (AC_PLATFORM_XBOX)
-  ptr = _aligned_realloc(p, size, 2);
-#else
-  ptr = realloc(p, size);
-#endif
+  return ptr;
+}
+
+AC_API void*
+ac_aligned_alloc_tagged(size_t size, size_t alignment, ac_memory_tag tag)
+{
+  alignment = AC_MAX(alignment, sizeof(void*));
+
+  void* ptr = ac_alloc_internal(ac_current_allocator(), size, alignment, tag);
 
 #if (AC_INCLUDE_DEBUG)
   ac_memory_manager_register_allocation(ptr, size);
@@ -74,39 +275,78 @@ ac_realloc(void* p, size_t size)
   return ptr;
 }
 
+AC_API void*
+ac_alloc(size_t size)
+{
+  return ac_alloc_tagged(size, ac_memory_tag_application);
+}
+
+AC_API void*
+ac_calloc(size_t size)
+{
+  return ac_calloc_tagged(size, ac_memory_tag_application);
+}
+
+AC_API void*
+ac_realloc(void* p, size_t size)
+{
+  return ac_realloc_tagged(p, size, ac_memory_tag_application);
+}
+
+AC_API void*
+ac_aligned_alloc(size_t size, size_t alignment)
+{
+  return ac_aligned_alloc_tagged(size, alignment, ac_memory_tag_application);
+}
+
 AC_API void
 ac_free(void* p)
 {
+  if (!p)
+  {
+    return;
+  }
+
 #if (AC_INCLUDE_DEBUG)
   ac_memory_manager_register_deallocation(p);
 #endif
 
-#if (AC_PLATFORM_WINDOWS) || (AC_PLATFORM_XBOX)
-  _aligned_free(p);
-#else
-  free(p);
-#endif
+  ac_allocation_header* header = ac_get_allocation_header(p);
+  const ac_allocator*   allocator = header->allocator;
+
+  ac_memory_counters_remove(header->tag, header->size);
+  allocator->cb_free(allocator->user_data, (uint8_t*)p - header->offset);
 }
 
-AC_API void*
-ac_aligned_alloc(size_t size, size_t alignment)
+AC_API void
+ac_get_memory_stats(ac_memory_stats* stats)
 {
-  void* ptr = NULL;
-
-  alignment = AC_MAX(alignment, sizeof(void*));
-  size = AC_ALIGN_UP(size, alignment);
+  for (uint32_t i = 0; i < AC_MAX_MEMORY_TAGS; ++i)
+  {
+    ac_memory_tag_counters* counters = &ac_memory_counters[i];
 
-#if (AC_PLATFORM_WINDOWS) || (AC_PLATFORM_XBOX)
-  ptr = _aligned_malloc(size, alignment);
-#else
-  ptr = aligned_alloc(alignment, size);
-#endif
+    stats->tags[i] = (ac_memory_tag_stats) {
+      .live_bytes = ac_atomic_load_u64(&counters->live_bytes),
+      .peak_bytes = ac_atomic_load_u64(&counters->peak_bytes),
+      .live_allocations = ac_atomic_load_u64(&counters->live_allocations),
+      .total_allocations = ac_atomic_load_u64(&counters->total_allocations),
+    };
+  }
+}
 
-#if (AC_INCLUDE_DEBUG)
-  ac_memory_manager_register_allocation(ptr, size);
-#endif
+AC_API void
+ac_push_allocator(const ac_allocator* allocator)
+{
+  AC_ASSERT(allocator);
+  AC_ASSERT(ac_allocator_scope_count < AC_MAX_ALLOCATOR_SCOPES);
+  ac_allocator_scopes[ac_allocator_scope_count++] = allocator;
+}
 
-  return ptr;
+AC_API void
+ac_pop_allocator(void)
+{
+  AC_ASSERT(ac_allocator_scope_count);
+  --ac_allocator_scope_count;
 }
 
 AC_API ac_result
@@ -114,23 +354,35 @@ ac_init(const ac_init_info* info)
 {
   AC_ASSERT(info->app_name);
 
+  if (info->allocator)
+  {
+    ac_allocators.installed = *info->allocator;
+    ac_allocators.global = &ac_allocators.installed;
+  }
+
   AC_RIF(ac_init_time());
   AC_RIF(ac_init_fs(info));
   AC_RIF(ac_init_log());
 
+  // before jobs, so job threads never allocate while manager is set up and
+  // everything jobs allocate is tracked until ac_shutdown_jobs frees it
 #if (AC_INCLUDE_DEBUG)
   if (info->enable_memory_manager)
   {
-    ac_memory_manager_init();
+    ac_memory_manager_init(info);
   }
 #endif
 
+  AC_RIF(ac_init_jobs(info));
+
   return ac_result_success;
 }
 
 AC_API void
 ac_shutdown(void)
 {
+  ac_shutdown_jobs();
+
 #if (AC_INCLUDE_DEBUG)
   ac_memory_manager_shutdown();
 #endif
@@ -138,4 +390,6 @@ ac_shutdown(void)
   ac_shutdown_log();
   ac_shutdown_fs();
   ac_shutdown_time();
+
+  ac_allocators.global = &ac_system_allocator;
 }
@@ -1,3 +1,4 @@
+#define AC_MEMORY_TAG ac_memory_tag_fs
 #include "ac_private.h"
 
 #if (AC_PLATFORM_APPLE)
@@ -0,0 +1,825 @@
+#include "ac_private.h"
+
+#define AC_JOB_DEQUE_SIZE 4096
+#define AC_JOB_THREAD_STACK_SIZE (512 * 1024)
+#define AC_JOB_FIBER_STACK_SIZE (256 * 1024)
+#define AC_CACHE_LINE_SIZE 64
+
+// thread local address must not be cached across fiber switch, fiber may
+// resume on other thread
+#if defined(_MSC_VER)
+#define AC_JOB_NOINLINE __declspec(noinline)
+#else
+#define AC_JOB_NOINLINE __attribute__((noinline))
+#endif
+
+struct ac_job_fiber;
+
+typedef struct ac_job_entry {
+  ac_job          job;
+  ac_job_counter* counter;
+} ac_job_entry;
+
+// either jobs queued after counter or fiber suspended on it
+typedef struct ac_job_waiter {
+  struct ac_job_waiter* next;
+  ac_job_counter*       counter;
+  uint32_t              count;
+  ac_job*               jobs;
+  struct ac_job_fiber*  fiber;
+} ac_job_waiter;
+
+typedef struct ac_job_fiber {
+  ac_fiber             fiber;
+  ac_job_entry         entry;
+  ac_job_waiter        waiter;
+  // free list or ready queue
+  struct ac_job_fiber* next;
+} ac_job_fiber;
+
+// chase-lev deque, owner pushes and takes at bottom, others steal at top.
+// bounded, so entries are copied out and never freed
+typedef struct ac_job_deque {
+  volatile int64_t top;
+  uint8_t          top_pad[AC_CACHE_LINE_SIZE - sizeof(int64_t)];
+  volatile int64_t bottom;
+  uint8_t          bottom_pad[AC_CACHE_LINE_SIZE - sizeof(int64_t)];
+  ac_job_entry     entries[AC_JOB_DEQUE_SIZE];
+} ac_job_deque;
+
+typedef struct ac_job_thread {
+  ac_job_deque  deque;
+  ac_thread     thread;
+  uint32_t      index;
+  uint32_t      seed;
+  // thread stack, fibers switch back to it when job ends or waits
+  ac_fiber      scheduler;
+  ac_job_fiber* fiber;
+  // handled once fiber switched out, before that other thread could resume it
+  ac_job_fiber* released;
+  ac_job_fiber* suspended;
+} ac_job_thread;
+
+typedef struct ac_job_system {
+  ac_job_thread* threads;
+  uint32_t       thread_count;
+  uint32_t       started_thread_count;
+  // guards injected queue, fibers and sleeping
+  ac_mutex       mtx;
+  ac_cond        cond;
+  array_t(ac_job_entry) injected;
+  size_t           injected_head;
+  volatile int64_t injected_count;
+  ac_job_fiber*    fibers;
+  uint32_t         fiber_count;
+  ac_job_fiber*    free_fibers;
+  ac_job_fiber*    ready_head;
+  ac_job_fiber*    ready_tail;
+  volatile int64_t ready_count;
+  // guards waiters of every counter
+  ac_mutex         waiters_mtx;
+  volatile int64_t pending;
+  volatile int64_t sleeping;
+  bool             exit;
+} ac_job_system;
+
+static ac_job_system ac_jobs;
+
+static AC_THREAD_LOCAL ac_job_thread* ac_job_current_thread;
+
+static AC_JOB_NOINLINE ac_job_thread*
+ac_job_get_current_thread(void)
+{
+  return ac_job_current_thread;
+}
+
+static bool
+ac_job_deque_push(ac_job_deque* deque, const ac_job_entry* entry)
+{
+  int64_t bottom = deque->bottom;
+  int64_t top = ac_atomic_load_i64(&deque->top);
+
+  if (bottom - top >= AC_JOB_DEQUE_SIZE)
+  {
+    return false;
+  }
+
+  deque->entries[bottom % AC_JOB_DEQUE_SIZE] = *entry;
+  ac_atomic_store_i64(&deque->bottom, bottom + 1);
+  return true;
+}
+
+static bool
+ac_job_deque_take(ac_job_deque* deque, ac_job_entry* entry)
+{
+  int64_t bottom = deque->bottom - 1;
+  ac_atomic_store_i64(&deque->bottom, bottom);
+  ac_atomic_fence();
+  int64_t top = ac_atomic_load_i64(&deque->top);
+
+  if (top > bottom)
+  {
+    ac_atomic_store_i64(&deque->bottom, bottom + 1);
+    return false;
+  }
+
+  *entry = deque->entries[bottom % AC_JOB_DEQUE_SIZE];
+  if (top != bottom)
+  {
+    return true;
+  }
+
+  // last entry, race thieves for it
+  bool taken = ac_atomic_cas_i64(&deque->top, top, top + 1);
+  ac_atomic_store_i64(&deque->bottom, bottom + 1);
+  return taken;
+}
+
+static bool
+ac_job_deque_steal(ac_job_deque* deque, ac_job_entry* entry)
+{
+  int64_t top = ac_atomic_load_i64(&deque->top);
+  ac_atomic_fence();
+  int64_t bottom = ac_atomic_load_i64(&deque->bottom);
+
+  if (top >= bottom)
+  {
+    return false;
+  }
+
+  // copy can be torn by owner reusing slot, then cas fails and it is dropped
+  *entry = deque->entries[top % AC_JOB_DEQUE_SIZE];
+  return ac_atomic_cas_i64(&deque->top, top, top + 1);
+}
+
+static void
+ac_job_wake(void)
+{
+  if (ac_atomic_load_i64(&ac_jobs.sleeping) == 0)
+  {
+    return;
+  }
+
+  ac_mutex_lock(ac_jobs.mtx);
+  ac_cond_broadcast(ac_jobs.cond);
+  ac_mutex_unlock(ac_jobs.mtx);
+}
+
+static void
+ac_job_push(const ac_job* jobs, uint32_t count, ac_job_counter* counter)
+{
+  ac_job_thread* thread = ac_job_get_current_thread();
+
+  uint32_t pushed = 0;
+  if (thread)
+  {
+    for (; pushed < count; ++pushed)
+    {
+      ac_job_entry entry = {
+        .job = jobs[pushed],
+        .counter = counter,
+      };
+      if (!ac_job_deque_push(&thread->deque, &entry))
+      {
+        break;
+      }
+    }
+  }
+
+  // threads outside of job system and full deques go through shared queue
+  if (pushed < count)
+  {
+    ac_mutex_lock(ac_jobs.mtx);
+    for (uint32_t i = pushed; i < count; ++i)
+    {
+      ac_job_entry entry = {
+        .job = jobs[i],
+        .counter = counter,
+      };
+      array_append(ac_jobs.injected, entry);
+    }
+    ac_atomic_add_i64(&ac_jobs.injected_count, count - pushed);
+    ac_mutex_unlock(ac_jobs.mtx);
+  }
+
+  ac_atomic_add_i64(&ac_jobs.pending, count);
+  ac_job_wake();
+}
+
+static void
+ac_job_resume(ac_job_fiber* fiber)
+{
+  fiber->next = NULL;
+
+  ac_mutex_lock(ac_jobs.mtx);
+  if (ac_jobs.ready_tail)
+  {
+    ac_jobs.ready_tail->next = fiber;
+  }
+  else
+  {
+    ac_jobs.ready_head = fiber;
+  }
+  ac_jobs.ready_tail = fiber;
+  ac_atomic_add_i64(&ac_jobs.ready_count, 1);
+  ac_mutex_unlock(ac_jobs.mtx);
+
+  ac_job_wake();
+}
+
+static ac_job_fiber*
+ac_job_pop_ready(void)
+{
+  if (ac_atomic_load_i64(&ac_jobs.ready_count) <= 0)
+  {
+    return NULL;
+  }
+
+  ac_mutex_lock(ac_jobs.mtx);
+  ac_job_fiber* fiber = ac_jobs.ready_head;
+  if (fiber)
+  {
+    ac_jobs.ready_head = fiber->next;
+    if (!ac_jobs.ready_head)
+    {
+      ac_jobs.ready_tail = NULL;
+    }
+    ac_atomic_add_i64(&ac_jobs.ready_count, -1);
+  }
+  ac_mutex_unlock(ac_jobs.mtx);
+
+  return fiber;
+}
+
+static ac_job_fiber*
+ac_job_alloc_fiber(void)
+{
+  ac_mutex_lock(ac_jobs.mtx);
+  ac_job_fiber* fiber = ac_jobs.free_fibers;
+  if (fiber)
+  {
+    ac_jobs.free_fibers = fiber->next;
+  }
+  ac_mutex_unlock(ac_jobs.mtx);
+
+  return fiber;
+}
+
+static void
+ac_job_free_fiber(ac_job_fiber* fiber)
+{
+  ac_mutex_lock(ac_jobs.mtx);
+  fiber->next = ac_jobs.free_fibers;
+  ac_jobs.free_fibers = fiber;
+  ac_mutex_unlock(ac_jobs.mtx);
+}
+
+static void
+ac_job_suspend(ac_job_fiber* fiber)
+{
+  ac_job_counter* counter = fiber->waiter.counter;
+
+  // same as ac_job_run_after, completion takes waiters under lock
+  ac_mutex_lock(ac_jobs.waiters_mtx);
+  bool queued = ac_atomic_load_i64(&counter->value) != 0;
+  if (queued)
+  {
+    fiber->waiter.next = counter->waiters;
+    counter->waiters = &fiber->waiter;
+  }
+  ac_mutex_unlock(ac_jobs.waiters_mtx);
+
+  if (!queued)
+  {
+    ac_job_resume(fiber);
+  }
+}
+
+static bool
+ac_job_pop_injected(ac_job_entry* entry)
+{
+  if (ac_atomic_load_i64(&ac_jobs.injected_count) <= 0)
+  {
+    return false;
+  }
+
+  bool found = false;
+
+  ac_mutex_lock(ac_jobs.mtx);
+  if (ac_jobs.injected_head < array_size(ac_jobs.injected))
+  {
+    *entry = ac_jobs.injected[ac_jobs.injected_head++];
+    if (ac_jobs.injected_head == array_size(ac_jobs.injected))
+    {
+      array_clear(ac_jobs.injected);
+      ac_jobs.injected_head = 0;
+    }
+    ac_atomic_add_i64(&ac_jobs.injected_count, -1);
+    found = true;
+  }
+  ac_mutex_unlock(ac_jobs.mtx);
+
+  return found;
+}
+
+static bool
+ac_job_get(ac_job_entry* entry)
+{
+  ac_job_thread* thread = ac_job_get_current_thread();
+
+  bool found = thread && ac_job_deque_take(&thread->deque, entry);
+
+  if (!found)
+  {
+    found = ac_job_pop_injected(entry);
+  }
+
+  if (!found && ac_jobs.thread_count)
+  {
+    uint32_t start = 0;
+    if (thread)
+    {
+      thread->seed = thread->seed * 1664525u + 1013904223u;
+      start = thread->seed;
+    }
+
+    for (uint32_t i = 0; i < ac_jobs.thread_count && !found; ++i)
+    {
+      ac_job_thread* victim =
+        &ac_jobs.threads[(start + i) % ac_jobs.thread_count];
+      if (victim != thread)
+      {
+        found = ac_job_deque_steal(&victim->deque, entry);
+      }
+    }
+  }
+
+  if (found)
+  {
+    ac_atomic_add_i64(&ac_jobs.pending, -1);
+  }
+
+  return found;
+}
+
+static void
+ac_job_counter_add(ac_job_counter* counter, uint32_t count)
+{
+  // busy is held from zero until last job is done with counter, owner may
+  // release it as soon as both drop to zero
+  ac_atomic_add_i64(&counter->busy, 1);
+
+  if (ac_atomic_add_i64(&counter->value, count) != count)
+  {
+    ac_atomic_add_i64(&counter->busy, -1);
+  }
+}
+
+static void
+ac_job_complete(ac_job_counter* counter)
+{
+  if (ac_atomic_add_i64(&counter->value, -1) != 0)
+  {
+    return;
+  }
+
+  ac_mutex_lock(ac_jobs.waiters_mtx);
+  ac_job_waiter* waiters = counter->waiters;
+  counter->waiters = NULL;
+  ac_mutex_unlock(ac_jobs.waiters_mtx);
+
+  ac_atomic_add_i64(&counter->busy, -1);
+
+  while (waiters)
+  {
+    // resumed fiber may reuse its waiter right away
+    ac_job_waiter* next = waiters->next;
+    if (waiters->fiber)
+    {
+      ac_job_resume(waiters->fiber);
+    }
+    else
+    {
+      ac_job_push(waiters->jobs, waiters->count, waiters->counter);
+      ac_free(waiters);
+    }
+    waiters = next;
+  }
+
+  ac_job_wake();
+}
+
+static void
+ac_job_execute(const ac_job_entry* entry)
+{
+  entry->job.function(entry->job.data);
+
+  if (entry->counter)
+  {
+    ac_job_complete(entry->counter);
+  }
+}
+
+static void
+ac_job_fiber_function(void* data)
+{
+  ac_job_fiber* fiber = data;
+
+  for (;;)
+  {
+    ac_job_execute(&fiber->entry);
+
+    ac_job_thread* thread = ac_job_get_current_thread();
+    thread->released = fiber;
+    ac_switch_fiber(fiber->fiber, thread->scheduler);
+  }
+}
+
+static void
+ac_job_switch(ac_job_thread* thread, ac_job_fiber* fiber)
+{
+  thread->fiber = fiber;
+  ac_switch_fiber(thread->scheduler, fiber->fiber);
+  thread->fiber = NULL;
+
+  if (thread->released)
+  {
+    ac_job_free_fiber(thread->released);
+    thread->released = NULL;
+  }
+
+  if (thread->suspended)
+  {
+    ac_job_suspend(thread->suspended);
+    thread->suspended = NULL;
+  }
+}
+
+// only called on thread stack, never inside fiber
+static bool
+ac_job_run_one(ac_job_thread* thread)
+{
+  bool fibers = thread && thread->scheduler;
+
+  if (fibers)
+  {
+    ac_job_fiber* fiber = ac_job_pop_ready();
+    if (fiber)
+    {
+      ac_job_switch(thread, fiber);
+      return true;
+    }
+  }
+
+  ac_job_entry entry;
+  if (!ac_job_get(&entry))
+  {
+    return false;
+  }
+
+  // when every fiber is suspended job runs on thread stack and blocks in wait
+  ac_job_fiber* fiber = fibers ? ac_job_alloc_fiber() : NULL;
+  if (fiber)
+  {
+    fiber->entry = entry;
+    ac_job_switch(thread, fiber);
+  }
+  else
+  {
+    ac_job_execute(&entry);
+  }
+
+  return true;
+}
+
+static bool
+ac_job_has_work(const ac_job_thread* thread)
+{
+  if (ac_atomic_load_i64(&ac_jobs.pending) > 0)
+  {
+    return true;
+  }
+
+  return thread && thread->scheduler &&
+         ac_atomic_load_i64(&ac_jobs.ready_count) > 0;
+}
+
+static ac_result
+ac_job_thread_function(void* data)
+{
+  ac_job_thread* thread = data;
+  ac_job_current_thread = thread;
+
+  if (ac_jobs.fiber_count)
+  {
+    if (ac_create_thread_fiber(&thread->scheduler) != ac_result_success)
+    {
+      ac_destroy_fiber(thread->scheduler);
+      thread->scheduler = NULL;
+    }
+  }
+
+  for (;;)
+  {
+    if (ac_job_run_one(thread))
+    {
+      continue;
+    }
+
+    ac_mutex_lock(ac_jobs.mtx);
+    ac_atomic_add_i64(&ac_jobs.sleeping, 1);
+    while (!ac_jobs.exit && !ac_job_has_work(thread))
+    {
+      ac_cond_wait(ac_jobs.cond, ac_jobs.mtx);
+    }
+    ac_atomic_add_i64(&ac_jobs.sleeping, -1);
+    bool exit = ac_jobs.exit;
+    ac_mutex_unlock(ac_jobs.mtx);
+
+    if (exit)
+    {
+      break;
+    }
+  }
+
+  ac_destroy_fiber(thread->scheduler);
+  thread->scheduler = NULL;
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_job_create_fibers(uint32_t count)
+{
+  ac_jobs.fibers = ac_calloc(sizeof(ac_job_fiber) * count);
+  if (!ac_jobs.fibers)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ac_job_fiber* fiber = &ac_jobs.fibers[i];
+    fiber->waiter.fiber = fiber;
+
+    // counted before check, failed fiber may be partially created
+    ++ac_jobs.fiber_count;
+
+    AC_RIF(ac_create_fiber(
+      AC_JOB_FIBER_STACK_SIZE,
+      ac_job_fiber_function,
+      fiber,
+      &fiber->fiber));
+
+    fiber->next = ac_jobs.free_fibers;
+    ac_jobs.free_fibers = fiber;
+  }
+
+  return ac_result_success;
+}
+
+static void
+ac_job_destroy_fibers(void)
+{
+  // every job finished, so fibers are back in free list
+  for (uint32_t i = 0; i < ac_jobs.fiber_count; ++i)
+  {
+    ac_destroy_fiber(ac_jobs.fibers[i].fiber);
+  }
+
+  ac_free(ac_jobs.fibers);
+  ac_jobs.fibers = NULL;
+  ac_jobs.fiber_count = 0;
+  ac_jobs.free_fibers = NULL;
+}
+
+static ac_result
+ac_job_create_system(const ac_init_info* info)
+{
+  AC_ZERO(ac_jobs);
+
+  ac_create_mutex(&ac_jobs.mtx);
+  ac_create_mutex(&ac_jobs.waiters_mtx);
+  ac_create_cond(&ac_jobs.cond);
+
+  uint32_t count = info->job_thread_count;
+  if (!count)
+  {
+    count = ac_get_cpu_count() - 1;
+  }
+  count = AC_MIN(count, AC_MAX_JOB_THREADS);
+
+  if (!count)
+  {
+    return ac_result_success;
+  }
+
+  ac_jobs.threads = ac_calloc(sizeof(ac_job_thread) * count);
+  if (!ac_jobs.threads)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  if (
+    info->job_fiber_count &&
+    ac_job_create_fibers(info->job_fiber_count) != ac_result_success)
+  {
+    // platforms without fiber support run jobs on thread stacks instead
+    AC_WARN("[ job ] fibers are not available, jobs run on thread stacks");
+    ac_job_destroy_fibers();
+  }
+
+  // set before start, threads steal from every deque
+  ac_jobs.thread_count = count;
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ac_job_thread* thread = &ac_jobs.threads[i];
+    thread->index = i + 1;
+    thread->seed = i + 1;
+
+    ac_result res = ac_create_thread(
+      &(ac_thread_info) {
+        .stack_size = AC_JOB_THREAD_STACK_SIZE,
+        .function_data = thread,
+        .function = ac_job_thread_function,
+        .name = "ac job",
+      },
+      &thread->thread);
+    if (res != ac_result_success)
+    {
+      return res;
+    }
+
+    ++ac_jobs.started_thread_count;
+  }
+
+  return ac_result_success;
+}
+
+ac_result
+ac_init_jobs(const ac_init_info* info)
+{
+  ac_result res = ac_job_create_system(info);
+  if (res != ac_result_success)
+  {
+    // joins threads already started and frees everything created so far
+    ac_shutdown_jobs();
+  }
+  return res;
+}
+
+void
+ac_shutdown_jobs(void)
+{
+  if (ac_jobs.mtx)
+  {
+    ac_mutex_lock(ac_jobs.mtx);
+    ac_jobs.exit = true;
+    ac_cond_broadcast(ac_jobs.cond);
+    ac_mutex_unlock(ac_jobs.mtx);
+  }
+
+  for (uint32_t i = 0; i < ac_jobs.started_thread_count; ++i)
+  {
+    (void)ac_destroy_thread(ac_jobs.threads[i].thread);
+  }
+
+  ac_job_destroy_fibers();
+  ac_free(ac_jobs.threads);
+  array_free(ac_jobs.injected);
+  ac_destroy_cond(ac_jobs.cond);
+  ac_destroy_mutex(ac_jobs.waiters_mtx);
+  ac_destroy_mutex(ac_jobs.mtx);
+
+  AC_ZERO(ac_jobs);
+}
+
+AC_API void
+ac_job_run(const ac_job* jobs, uint32_t count, ac_job_counter* counter)
+{
+  if (!count)
+  {
+    return;
+  }
+
+  if (counter)
+  {
+    ac_job_counter_add(counter, count);
+  }
+
+  ac_job_push(jobs, count, counter);
+}
+
+AC_API ac_result
+ac_job_run_after(
+  const ac_job*   jobs,
+  uint32_t        count,
+  ac_job_counter* dependency,
+  ac_job_counter* counter)
+{
+  if (!count)
+  {
+    return ac_result_success;
+  }
+
+  if (!dependency)
+  {
+    ac_job_run(jobs, count, counter);
+    return ac_result_success;
+  }
+
+  ac_job_waiter* waiter =
+    ac_calloc(sizeof(ac_job_waiter) + sizeof(ac_job) * count);
+  if (!waiter)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  waiter->counter = counter;
+  waiter->count = count;
+  waiter->jobs = (ac_job*)(waiter + 1);
+  memcpy(waiter->jobs, jobs, sizeof(ac_job) * count);
+
+  if (counter)
+  {
+    ac_job_counter_add(counter, count);
+  }
+
+  // completion takes waiters under same lock after value drops to zero
+  ac_mutex_lock(ac_jobs.waiters_mtx);
+  bool queued = ac_atomic_load_i64(&dependency->value) != 0;
+  if (queued)
+  {
+    waiter->next = dependency->waiters;
+    dependency->waiters = waiter;
+  }
+  ac_mutex_unlock(ac_jobs.waiters_mtx);
+
+  if (!queued)
+  {
+    ac_job_push(waiter->jobs, waiter->count, waiter->counter);
+    ac_free(waiter);
+  }
+
+  return ac_result_success;
+}
+
+AC_API bool
+ac_job_is_complete(const ac_job_counter* counter)
+{
+  return ac_atomic_load_i64(&counter->value) == 0 &&
+         ac_atomic_load_i64(&counter->busy) == 0;
+}
+
+AC_API void
+ac_job_wait(ac_job_counter* counter)
+{
+  ac_job_thread* thread = ac_job_get_current_thread();
+
+  if (thread && thread->fiber)
+  {
+    while (!ac_job_is_complete(counter))
+    {
+      // suspended by scheduler after switch, resumed by completion
+      ac_job_fiber* fiber = thread->fiber;
+      fiber->waiter.counter = counter;
+      thread->suspended = fiber;
+      ac_switch_fiber(fiber->fiber, thread->scheduler);
+
+      thread = ac_job_get_current_thread();
+    }
+
+    return;
+  }
+
+  while (!ac_job_is_complete(counter))
+  {
+    if (ac_job_run_one(thread))
+    {
+      continue;
+    }
+
+    ac_mutex_lock(ac_jobs.mtx);
+    ac_atomic_add_i64(&ac_jobs.sleeping, 1);
+    while (!ac_job_is_complete(counter) && !ac_job_has_work(thread))
+    {
+      ac_cond_wait(ac_jobs.cond, ac_jobs.mtx);
+    }
+    ac_atomic_add_i64(&ac_jobs.sleeping, -1);
+    ac_mutex_unlock(ac_jobs.mtx);
+  }
+}
+
+AC_API uint32_t
+ac_job_get_thread_count(void)
+{
+  return ac_jobs.thread_count + 1;
+}
+
+AC_API uint32_t
+ac_job_get_thread_index(void)
+{
+  ac_job_thread* thread = ac_job_get_current_thread();
+  return thread ? thread->index : 0;
+}
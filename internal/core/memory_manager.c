@@ -16,6 +16,16 @@ ac_memory_manager_allocation_compare(const void* a, const void* b, void* udata)
   return (a0->ptr != a1->ptr);
 }
 
+static inline uint64_t
+ac_memory_manager_hash_ptr(const void* p)
+{
+  uint64_t x = (uintptr_t)p;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return x;
+}
+
 static uint64_t
 ac_memory_manager_allocation_hash(
   const void* item,
@@ -25,28 +35,62 @@ ac_memory_manager_allocation_hash(
   AC_UNUSED(seed0);
   AC_UNUSED(seed1);
   const ac_memory_manager_allocation* b = item;
-  return (uintptr_t)b->ptr;
+  return ac_memory_manager_hash_ptr(b->ptr);
+}
+
+static inline ac_memory_manager_shard*
+ac_memory_manager_get_shard(const void* p)
+{
+  uint64_t hash = ac_memory_manager_hash_ptr(p);
+  return &manager.shards[(hash >> 32) % AC_MEMORY_MANAGER_SHARD_COUNT];
+}
+
+// sampling counter is per thread, no shared state is touched to decide
+static ac_stack_trace
+ac_memory_manager_sample_stack_trace(void)
+{
+  static AC_THREAD_LOCAL uint32_t counter;
+
+  if (++counter < manager.trace_interval)
+  {
+    return NULL;
+  }
+  counter = 0;
+
+  ac_stack_trace trace;
+  if (ac_memory_manager_create_stack_trace(&trace) != ac_result_success)
+  {
+    return NULL;
+  }
+  return trace;
 }
 
 void
-ac_memory_manager_init(void)
+ac_memory_manager_init(const ac_init_info* info)
 {
   AC_ZERO(manager);
 
-  manager.allocation_map = hashmap_new_with_allocator(
-    malloc,
-    realloc,
-    free,
-    sizeof(ac_memory_manager_allocation),
-    0,
-    0,
-    0,
-    ac_memory_manager_allocation_hash,
-    ac_memory_manager_allocation_compare,
-    NULL,
-    NULL);
-
-  ac_create_mutex(&manager.mutex);
+  manager.trace_interval = AC_MAX(info->memory_manager_trace_interval, 1);
+
+  for (uint32_t i = 0; i < AC_MEMORY_MANAGER_SHARD_COUNT; ++i)
+  {
+    ac_memory_manager_shard* shard = &manager.shards[i];
+
+    shard->allocation_map = hashmap_new_with_allocator(
+      malloc,
+      realloc,
+      free,
+      sizeof(ac_memory_manager_allocation),
+      0,
+      0,
+      0,
+      ac_memory_manager_allocation_hash,
+      ac_memory_manager_allocation_compare,
+      NULL,
+      NULL);
+
+    ac_create_mutex(&shard->mutex);
+  }
 
   manager.inited = true;
 
@@ -63,32 +107,39 @@ ac_memory_manager_shutdown(void)
 
   manager.inited = false;
 
-  ac_destroy_mutex(manager.mutex);
-
-  size_t                        iter = 0;
-  ac_memory_manager_allocation* allocation;
-
   uint32_t leak_count = 0;
   size_t   total_leaked = 0;
 
-  while (hashmap_iter(manager.allocation_map, &iter, (void**)&allocation))
+  for (uint32_t i = 0; i < AC_MEMORY_MANAGER_SHARD_COUNT; ++i)
   {
-    if (allocation->freed)
+    ac_memory_manager_shard* shard = &manager.shards[i];
+
+    ac_destroy_mutex(shard->mutex);
+
+    size_t                        iter = 0;
+    ac_memory_manager_allocation* allocation;
+
+    while (hashmap_iter(shard->allocation_map, &iter, (void**)&allocation))
     {
-      continue;
-    }
-    AC_ERROR(
-      "[ memory manager ] unfreed allocation %p %zu (bytes)",
-      allocation->ptr,
-      allocation->size);
+      if (allocation->freed)
+      {
+        continue;
+      }
+      AC_ERROR(
+        "[ memory manager ] unfreed allocation %p %zu (bytes)",
+        allocation->ptr,
+        allocation->size);
 
-    ac_memory_manager_print_stack_trace(allocation->stack_trace);
-    ac_memory_manager_destroy_stack_trace(allocation->stack_trace);
+      ac_memory_manager_print_stack_trace(allocation->stack_trace);
+      ac_memory_manager_destroy_stack_trace(allocation->stack_trace);
 
-    AC_DEBUGBREAK();
+      AC_DEBUGBREAK();
 
-    total_leaked += allocation->size;
-    leak_count++;
+      total_leaked += allocation->size;
+      leak_count++;
+    }
+
+    hashmap_free(shard->allocation_map);
   }
 
   if (leak_count)
@@ -102,7 +153,6 @@ ac_memory_manager_shutdown(void)
   {
     AC_INFO("[ memory manager ] no leaks detected");
   }
-  hashmap_free(manager.allocation_map);
 }
 
 void
@@ -118,24 +168,18 @@ ac_memory_manager_register_allocation(void* p, size_t size)
     return;
   }
 
-  ac_mutex_lock(manager.mutex);
-
-  ac_stack_trace trace;
-  if (ac_memory_manager_create_stack_trace(&trace) != ac_result_success)
-  {
-    trace = NULL;
-  }
-
   ac_memory_manager_allocation allocation = {
     .ptr = p,
     .size = size,
     .freed = false,
-    .stack_trace = trace,
+    .stack_trace = ac_memory_manager_sample_stack_trace(),
   };
 
-  (void)hashmap_set(manager.allocation_map, &allocation);
+  ac_memory_manager_shard* shard = ac_memory_manager_get_shard(p);
 
-  ac_mutex_unlock(manager.mutex);
+  ac_mutex_lock(shard->mutex);
+  (void)hashmap_set(shard->allocation_map, &allocation);
+  ac_mutex_unlock(shard->mutex);
 }
 
 void
@@ -151,37 +195,46 @@ ac_memory_manager_register_deallocation(void* p)
     return;
   }
 
-  ac_mutex_lock(manager.mutex);
+  ac_memory_manager_shard* shard = ac_memory_manager_get_shard(p);
+
+  ac_mutex_lock(shard->mutex);
 
   ac_memory_manager_allocation* allocation = hashmap_get(
-    manager.allocation_map,
+    shard->allocation_map,
     &(ac_memory_manager_allocation) {
       .ptr = p,
     });
 
+  ac_stack_trace trace = NULL;
+  bool           double_free = false;
+
+  if (allocation)
+  {
+    double_free = allocation->freed;
+    trace = allocation->stack_trace;
+    allocation->freed = true;
+    allocation->stack_trace = NULL;
+  }
+
+  ac_mutex_unlock(shard->mutex);
+
+  ac_memory_manager_destroy_stack_trace(trace);
+
   if (!allocation)
   {
     AC_ERROR("[ memory manager ] freed memory wasn't allocated");
     AC_DEBUGBREAK();
   }
-  else
+  else if (double_free)
   {
-    if (allocation->freed)
+    AC_ERROR("[ memory manager ] double free detected");
+    if (ac_memory_manager_create_stack_trace(&trace) == ac_result_success)
     {
-      AC_ERROR("[ memory manager ] double free detected");
-      ac_stack_trace trace;
-      if (ac_memory_manager_create_stack_trace(&trace) == ac_result_success)
-      {
-        ac_memory_manager_print_stack_trace(trace);
-        ac_memory_manager_destroy_stack_trace(trace);
-      }
-      AC_DEBUGBREAK();
+      ac_memory_manager_print_stack_trace(trace);
+      ac_memory_manager_destroy_stack_trace(trace);
     }
-
-    allocation->freed = true;
+    AC_DEBUGBREAK();
   }
-
-  ac_mutex_unlock(manager.mutex);
 }
 
 #endif
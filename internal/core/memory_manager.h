@@ -11,10 +11,19 @@ typedef struct ac_memory_manager_allocation {
   ac_stack_trace stack_trace;
 } ac_memory_manager_allocation;
 
-typedef struct ac_memory_manager {
+// allocations are spread over shards by address, so threads allocating at
+// the same time rarely meet on one mutex
+#define AC_MEMORY_MANAGER_SHARD_COUNT 64
+
+typedef struct ac_memory_manager_shard {
   struct hashmap* allocation_map;
-  bool            inited;
   ac_mutex        mutex;
+} ac_memory_manager_shard;
+
+typedef struct ac_memory_manager {
+  ac_memory_manager_shard shards[AC_MEMORY_MANAGER_SHARD_COUNT];
+  uint32_t                trace_interval;
+  bool                    inited;
 } ac_memory_manager;
 
 #if defined(__cplusplus)
@@ -23,7 +32,7 @@ extern "C"
 #endif
 
 void
-ac_memory_manager_init(void);
+ac_memory_manager_init(const ac_init_info* info);
 
 void
 ac_memory_manager_shutdown(void);
@@ -34,6 +43,7 @@ ac_memory_manager_register_allocation(void* p, size_t size);
 void
 ac_memory_manager_register_deallocation(void* p);
 
+// captures only return addresses, symbols are resolved when printing
 ac_result
 ac_memory_manager_create_stack_trace(ac_stack_trace* trace);
 
@@ -5,9 +5,11 @@
 #include <execinfo.h>
 #include "memory_manager.h"
 
+#define AC_MAX_STACK_FRAMES 62
+
 typedef struct ac_unix_stack_trace {
   uint32_t frame_count;
-  char**   frames;
+  void*    frames[AC_MAX_STACK_FRAMES];
 } ac_unix_stack_trace;
 
 ac_result
@@ -15,16 +17,14 @@ ac_memory_manager_create_stack_trace(ac_stack_trace* trace)
 {
   *trace = NULL;
 
-  ac_unix_stack_trace* p = calloc(1, sizeof(ac_unix_stack_trace));
+  ac_unix_stack_trace* p = malloc(sizeof(ac_unix_stack_trace));
   if (!p)
   {
     return ac_result_out_of_host_memory;
   }
   *trace = p;
 
-  void* bt[1024];
-  p->frame_count = (uint32_t)backtrace(bt, 1024);
-  p->frames = backtrace_symbols(bt, (int32_t)p->frame_count);
+  p->frame_count = (uint32_t)backtrace(p->frames, AC_MAX_STACK_FRAMES);
 
   return ac_result_success;
 }
@@ -39,23 +39,24 @@ ac_memory_manager_print_stack_trace(ac_stack_trace trace)
 
   ac_unix_stack_trace* p = (ac_unix_stack_trace*)trace;
 
+  char** symbols = backtrace_symbols(p->frames, (int32_t)p->frame_count);
+  if (!symbols)
+  {
+    return;
+  }
+
   for (uint32_t i = 2; i < p->frame_count; i++)
   {
-    ac_print(NULL, "\t %d : %s\n", i - 2, &p->frames[i][1]);
+    ac_print(NULL, "\t %d : %s\n", i - 2, &symbols[i][1]);
   }
+
+  free(symbols);
 }
 
 void
 ac_memory_manager_destroy_stack_trace(ac_stack_trace trace)
 {
-  if (!trace)
-  {
-    return;
-  }
-
-  ac_unix_stack_trace* p = (ac_unix_stack_trace*)trace;
-  free(p->frames);
-  free(p);
+  free(trace);
 }
 
 #endif
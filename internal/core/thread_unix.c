@@ -5,6 +5,10 @@
 #include <pthread.h>
 #include <limits.h>
 #include <unistd.h>
+#if (AC_PLATFORM_LINUX)
+#include <ucontext.h>
+#include <sys/mman.h>
+#endif
 
 AC_STATIC_ASSERT(AC_MAX_THREAD_NAME <= 16);
 
@@ -29,6 +33,16 @@ typedef struct ac_cond_internal {
   pthread_cond_t cond;
 } ac_cond_internal;
 
+// ucontext is deprecated on apple, fibers are linux only there
+typedef struct ac_fiber_internal {
+#if (AC_PLATFORM_LINUX)
+  ucontext_t context;
+#endif
+  void*             stack;
+  ac_fiber_function function;
+  void*             data;
+} ac_fiber_internal;
+
 static void*
 ac_unix_start_routine(void* thread_handle)
 {
@@ -52,6 +66,13 @@ ac_unix_start_routine(void* thread_handle)
   return value;
 }
 
+AC_API uint32_t
+ac_get_cpu_count(void)
+{
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (uint32_t)count : 1;
+}
+
 AC_API ac_result
 ac_create_thread(const ac_thread_info* info, ac_thread* p)
 {
@@ -357,4 +378,144 @@ ac_cond_wait(ac_cond c, ac_mutex m)
   }
 }
 
+#if (AC_PLATFORM_LINUX)
+
+// makecontext passes only int arguments, so pointer is split in halves
+static void
+ac_unix_fiber_start(uint32_t low, uint32_t high)
+{
+  uint64_t address = ((uint64_t)high << 32) | low;
+  ac_fiber fiber = (ac_fiber)(uintptr_t)address;
+
+  fiber->function(fiber->data);
+
+  AC_ASSERT(0);
+}
+
+#endif
+
+ac_result
+ac_create_thread_fiber(ac_fiber* p)
+{
+  AC_ASSERT(p);
+
+#if (AC_PLATFORM_LINUX)
+  ac_fiber fiber = ac_calloc(sizeof(ac_fiber_internal));
+  *p = fiber;
+
+  if (!fiber)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  // context is filled on first switch away from thread
+  return ac_result_success;
+#else
+  *p = NULL;
+  return ac_result_unknown_error;
+#endif
+}
+
+ac_result
+ac_create_fiber(
+  uint32_t          stack_size,
+  ac_fiber_function function,
+  void*             data,
+  ac_fiber*         p)
+{
+  AC_ASSERT(p);
+  AC_ASSERT(function);
+
+#if (AC_PLATFORM_LINUX)
+  ac_fiber fiber = ac_calloc(sizeof(ac_fiber_internal));
+  *p = fiber;
+
+  if (!fiber)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  fiber->function = function;
+  fiber->data = data;
+
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t stack_size_aligned =
+    AC_ALIGN_UP(AC_MAX(stack_size, AC_MIN_THREAD_STACK_SIZE), page_size);
+
+  // lowest page is guard, stack grows down so overflow faults right away
+  // instead of corrupting neighbouring memory
+  fiber->stack = ac_aligned_alloc(stack_size_aligned + page_size, page_size);
+  if (!fiber->stack)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  if (mprotect(fiber->stack, page_size, PROT_NONE) != 0)
+  {
+    return ac_result_unknown_error;
+  }
+
+  if (getcontext(&fiber->context) != 0)
+  {
+    return ac_result_unknown_error;
+  }
+
+  fiber->context.uc_stack.ss_sp = (uint8_t*)fiber->stack + page_size;
+  fiber->context.uc_stack.ss_size = stack_size_aligned;
+  fiber->context.uc_link = NULL;
+
+  uint64_t address = (uintptr_t)fiber;
+
+  makecontext(
+    &fiber->context,
+    (void (*)(void))ac_unix_fiber_start,
+    2,
+    (uint32_t)address,
+    (uint32_t)(address >> 32));
+
+  return ac_result_success;
+#else
+  AC_UNUSED(stack_size);
+  AC_UNUSED(function);
+  AC_UNUSED(data);
+
+  *p = NULL;
+  return ac_result_unknown_error;
+#endif
+}
+
+void
+ac_destroy_fiber(ac_fiber fiber)
+{
+  if (!fiber)
+  {
+    return;
+  }
+
+#if (AC_PLATFORM_LINUX)
+  // allocator may write to guard page once block is given back
+  if (fiber->stack)
+  {
+    (void)mprotect(fiber->stack, sysconf(_SC_PAGESIZE), PROT_READ | PROT_WRITE);
+  }
+#endif
+
+  ac_free(fiber->stack);
+  ac_free(fiber);
+}
+
+void
+ac_switch_fiber(ac_fiber from, ac_fiber to)
+{
+  AC_ASSERT(from);
+  AC_ASSERT(to);
+
+#if (AC_PLATFORM_LINUX)
+  (void)swapcontext(&from->context, &to->context);
+#else
+  AC_UNUSED(from);
+  AC_UNUSED(to);
+#endif
+}
+
 #endif
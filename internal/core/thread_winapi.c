@@ -26,6 +26,13 @@ typedef struct ac_cond_internal {
   CONDITION_VARIABLE cond;
 } ac_cond_internal;
 
+typedef struct ac_fiber_internal {
+  void*             fiber;
+  bool              thread;
+  ac_fiber_function function;
+  void*             data;
+} ac_fiber_internal;
+
 static unsigned int
 ac_winapi_thread_proc(void* thread_handle)
 {
@@ -38,6 +45,24 @@ ac_winapi_thread_proc(void* thread_handle)
   return (unsigned int)res;
 }
 
+static void WINAPI
+ac_winapi_fiber_proc(void* fiber_handle)
+{
+  ac_fiber_internal* fiber = fiber_handle;
+
+  fiber->function(fiber->data);
+
+  AC_ASSERT(0);
+}
+
+AC_API uint32_t
+ac_get_cpu_count(void)
+{
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return AC_MAX(info.dwNumberOfProcessors, 1);
+}
+
 AC_API ac_result
 ac_create_thread(const ac_thread_info* info, ac_thread* p)
 {
@@ -321,4 +346,92 @@ ac_cond_wait(ac_cond c, ac_mutex m)
   }
 }
 
+ac_result
+ac_create_thread_fiber(ac_fiber* p)
+{
+  AC_ASSERT(p);
+
+  ac_fiber fiber = ac_calloc(sizeof(ac_fiber_internal));
+  *p = fiber;
+
+  if (!fiber)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  fiber->thread = true;
+  fiber->fiber = ConvertThreadToFiber(NULL);
+  if (!fiber->fiber)
+  {
+    return ac_result_unknown_error;
+  }
+
+  return ac_result_success;
+}
+
+ac_result
+ac_create_fiber(
+  uint32_t          stack_size,
+  ac_fiber_function function,
+  void*             data,
+  ac_fiber*         p)
+{
+  AC_ASSERT(p);
+  AC_ASSERT(function);
+
+  ac_fiber fiber = ac_calloc(sizeof(ac_fiber_internal));
+  *p = fiber;
+
+  if (!fiber)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  fiber->function = function;
+  fiber->data = data;
+  fiber->fiber = CreateFiber(
+    AC_MAX(stack_size, AC_MIN_THREAD_STACK_SIZE),
+    ac_winapi_fiber_proc,
+    fiber);
+  if (!fiber->fiber)
+  {
+    return ac_result_unknown_error;
+  }
+
+  return ac_result_success;
+}
+
+void
+ac_destroy_fiber(ac_fiber fiber)
+{
+  if (!fiber)
+  {
+    return;
+  }
+
+  if (fiber->fiber)
+  {
+    if (fiber->thread)
+    {
+      (void)ConvertFiberToThread();
+    }
+    else
+    {
+      DeleteFiber(fiber->fiber);
+    }
+  }
+
+  ac_free(fiber);
+}
+
+void
+ac_switch_fiber(ac_fiber from, ac_fiber to)
+{
+  AC_ASSERT(from);
+  AC_ASSERT(to);
+  AC_UNUSED(from);
+
+  SwitchToFiber(to->fiber);
+}
+
 #endif
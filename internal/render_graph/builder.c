@@ -15,6 +15,12 @@ typedef enum ac_rg_resource_use_add_mode {
   ac_rg_resource_use_add_mode_continue = 2,
 } ac_rg_resource_use_add_mode;
 
+static inline void
+ac_rg_hash_combine(uint64_t* hash, uint64_t value)
+{
+  *hash ^= value + 0x9e3779b97f4a7c15ull + (*hash << 6) + (*hash >> 2);
+}
+
 static inline void
 ac_rg_destroy_resource_state(ac_rg_builder_resource state)
 {
@@ -268,14 +274,7 @@ ac_rg_add_resource_use(
   }
   case ac_rg_resource_use_add_mode_edit:
   {
-    for (insert_index = 0; insert_index < array_size(resource->states);
-         ++insert_index)
-    {
-      if (resource->states[insert_index] == state)
-      {
-        break;
-      }
-    }
+    insert_index = ac_rg_state_index(state);
 
     if (array_size(state->uses) && state->uses[0].specifics.access_write.access)
     {
@@ -298,6 +297,7 @@ ac_rg_add_resource_use(
     state->resource = resource;
 
     array_insert(resource->states, insert_index, state);
+    ac_rg_resource_index_states(resource, insert_index);
   }
 
   if (stage && info)
@@ -938,6 +938,12 @@ ac_rg_builder_create_resource(
     return NULL;
   }
 
+  resource->record_index = UINT32_MAX;
+  if (builder->is_recording)
+  {
+    resource->record_index = (uint32_t)array_size(builder->resources);
+  }
+
   array_append(builder->resources, resource);
 
   bool is_image = info->image_info ||
@@ -1635,6 +1641,11 @@ ac_rg_builder_create_stage(
   }
 
   stage->info = *info;
+  stage->record_index = UINT32_MAX;
+  if (builder->is_recording)
+  {
+    stage->record_index = (uint32_t)array_size(builder->stages);
+  }
 
   array_append(builder->stages, stage);
   return stage;
@@ -1688,15 +1699,9 @@ ac_rg_remove_resource_use(
     return;
   }
 
-  for (size_t i = 0; i < array_size(resource->states); ++i)
-  {
-    if (resource->states[i] != state)
-    {
-      continue;
-    }
-    array_remove(resource->states, i);
-    break;
-  }
+  uint32_t index = ac_rg_state_index(state);
+  array_remove(resource->states, index);
+  ac_rg_resource_index_states(resource, index);
 
   ac_rg_destroy_resource_state(state);
 }
@@ -1745,6 +1750,7 @@ ac_rg_builder_apply_zero_state(
 
       ac_rg_destroy_resource_state(resource->states[0]);
       array_remove(resource->states, 0);
+      ac_rg_resource_index_states(resource, 0);
     }
     return;
   }
@@ -2173,6 +2179,8 @@ ac_rg_builder_apply_export(ac_rg_builder builder)
     }
     }
 
+    export->target = resource;
+
     resource->export.is_active = true;
     resource->export.signal = export->connection.signal;
     resource->export.wait = export->connection.wait;
@@ -2339,247 +2347,902 @@ ac_rg_builder_stage_is_time(ac_rg_builder builder, ac_rg_builder_stage stage)
   return true;
 }
 
-static ac_result
-ac_rg_builder_sort_stages(ac_rg_builder builder)
+typedef struct ac_rg_stage_position {
+  uint64_t signature;
+  uint32_t position;
+} ac_rg_stage_position;
+
+static uint64_t
+ac_rg_stage_position_hash(const void* item, uint64_t seed0, uint64_t seed1)
 {
-  // timeline already initialized
-  AC_ASSERT(array_size(builder->timeline) == 0);
+  const ac_rg_stage_position* position = item;
+  return hashmap_murmur(
+    &position->signature,
+    sizeof(position->signature),
+    seed0,
+    seed1);
+}
 
-  array_reserve(builder->timeline, array_size(builder->stages));
+static int32_t
+ac_rg_stage_position_compare(const void* a, const void* b, void* udata)
+{
+  AC_UNUSED(udata);
+  const ac_rg_stage_position* pa = a;
+  const ac_rg_stage_position* pb = b;
+  return (pa->signature > pb->signature) - (pa->signature < pb->signature);
+}
 
-  for (size_t i = 0; i < array_size(builder->resources); ++i)
+// identifies stage between recompilations, same stage recorded twice is
+// distinguished by occurrence index
+static ac_result
+ac_rg_builder_compute_stage_signatures(ac_rg_builder builder)
+{
+  struct hashmap* occurrences = hashmap_new_with_allocator(
+    ac_hashmap_alloc,
+    ac_hashmap_realloc,
+    ac_free,
+    sizeof(ac_rg_stage_position),
+    array_size(builder->stages),
+    0,
+    0,
+    ac_rg_stage_position_hash,
+    ac_rg_stage_position_compare,
+    NULL,
+    NULL);
+  if (!occurrences)
   {
-    ac_rg_graph_resource* resource = builder->resources[i];
-
-    resource->timeline_state = (ac_rg_builder_timeline_state) {
-      .state = 0,
-      .use_count = 0,
-    };
-
-#if 0
-		while ( resource->timeline_state.state < array_size( resource->states ) &&
-		        array_size(
-		          resource->states[ resource->timeline_state.state ]->uses ) == 0 )
-		{
-			++resource->timeline_state.state;
-		}
-#endif
+    return ac_result_out_of_host_memory;
   }
 
-  array_t(ac_rg_builder_stage) unused_stages[ac_queue_type_count];
-  AC_ZERO(unused_stages);
-
-  for (uint32_t i = 0; i < array_size(builder->stages); ++i)
+  for (size_t i = 0; i < array_size(builder->stages); ++i)
   {
-    ac_rg_builder_stage stage = builder->stages[i];
-    array_append(unused_stages[stage->info.commands], stage);
-  }
+    ac_rg_builder_stage       stage = builder->stages[i];
+    ac_rg_builder_stage_info* info = &stage->info;
 
-  bool stage_used[ac_queue_type_count];
-  bool single_stage_used;
+    uint64_t signature = 0;
+    if (info->name)
+    {
+      signature = hashmap_murmur(info->name, strlen(info->name), 0, 0);
+    }
 
-  do
-  {
-    single_stage_used = false;
+    ac_rg_hash_combine(&signature, info->queue);
+    ac_rg_hash_combine(&signature, info->commands);
+    ac_rg_hash_combine(&signature, (uint64_t)(uintptr_t)info->cb_prepare);
+    ac_rg_hash_combine(&signature, (uint64_t)(uintptr_t)info->cb_cmd);
+    ac_rg_hash_combine(&signature, (uint64_t)(uintptr_t)info->cb_submit);
 
-    for (int qi = 0; qi < ac_queue_type_count; ++qi)
+    ac_rg_stage_position  key = {.signature = signature};
+    ac_rg_stage_position* occurrence = hashmap_get(occurrences, &key);
+    if (occurrence)
     {
-      do
+      ++occurrence->position;
+      key.position = occurrence->position;
+    }
+    else
+    {
+      (void)hashmap_set(occurrences, &key);
+      if (hashmap_oom(occurrences))
       {
-        stage_used[qi] = false;
-
-        for (uint32_t si = 0; si < array_size(unused_stages[qi]);)
-        {
-          if (!ac_rg_builder_stage_is_time(builder, unused_stages[qi][si]))
-          {
-            ++si;
-            continue;
-          }
-
-          stage_used[qi] = true;
-          single_stage_used = true;
-          array_remove(unused_stages[qi], si);
-        }
+        hashmap_free(occurrences);
+        return ac_result_out_of_host_memory;
       }
-      while (stage_used[qi]);
     }
-  }
-  while (single_stage_used);
-
-  for (int qi = 0; qi < ac_queue_type_count; ++qi)
-  {
-    size_t unresolved_stage_count = array_size(unused_stages[qi]);
-    if (unresolved_stage_count)
-    {
-      AC_RG_MESSAGE(
-        &builder->rg->callback,
-        &(ac_rg_validation_message_internal) {
-          .id = ac_rg_message_id_error_cyclic_stage_dependencies,
-        });
 
-      builder->result = ac_result_bad_usage;
-      return ac_result_bad_usage;
-    }
-    array_free(unused_stages[qi]);
+    ac_rg_hash_combine(&signature, key.position);
+    stage->signature = signature;
   }
 
-  if (array_size(builder->timeline) == 0)
-  {
-    array_free(builder->timeline);
-    return ac_result_canceled;
-  }
+  hashmap_free(occurrences);
   return ac_result_success;
 }
 
-static inline void
-ac_rg_destroy_graph_stage_barrier(ac_rg_graph_stage_barrier* barrier)
+static inline ac_rg_builder_resource
+ac_rg_builder_resource_prev_state(ac_rg_builder_resource state)
 {
-  array_free(barrier->buffers);
-  array_free(barrier->images);
-
-  array_free(barrier->buffer_nodes);
-  array_free(barrier->image_nodes);
+  uint32_t index = ac_rg_state_index(state);
+  return index ? state->resource->states[index - 1] : NULL;
 }
 
-static inline void
-ac_rg_destroy_graph_stage_subpass(ac_rg_graph_stage_subpass* subpass)
+static inline bool
+ac_rg_ready_queue_less(ac_rg_builder_stage a, ac_rg_builder_stage b)
 {
-  array_free(subpass->images);
-  array_free(subpass->buffers);
-  array_free(subpass->attachments);
+  return a->sort_key < b->sort_key;
 }
 
-static inline void
-ac_rg_destroy_graph_stage(ac_rg_graph_stage* stage)
+static void
+ac_rg_ready_queue_push(
+  array_t(ac_rg_builder_stage) * queue,
+  ac_rg_builder_stage stage)
 {
-  array_free(stage->fences_signal);
-  array_free(stage->fences_wait);
+  stage->sort_queued = true;
+  array_append(*queue, stage);
 
-  for (size_t si = 0; si < array_size(stage->subpasses); ++si)
+  ac_rg_builder_stage* heap = *queue;
+  size_t               i = array_size(heap) - 1;
+  while (i > 0)
   {
-    ac_rg_destroy_graph_stage_subpass(&stage->subpasses[si]);
+    size_t parent = (i - 1) / 2;
+    if (!ac_rg_ready_queue_less(heap[i], heap[parent]))
+    {
+      break;
+    }
+    ac_rg_builder_stage tmp = heap[i];
+    heap[i] = heap[parent];
+    heap[parent] = tmp;
+    i = parent;
   }
-  array_free(stage->subpasses);
+}
 
-  ac_rg_destroy_graph_stage_barrier(&stage->barrier_beg);
-  ac_rg_destroy_graph_stage_barrier(&stage->barrier_end);
+static ac_rg_builder_stage
+ac_rg_ready_queue_pop(array_t(ac_rg_builder_stage) * queue)
+{
+  ac_rg_builder_stage* heap = *queue;
+  size_t               size = array_size(heap) - 1;
+  ac_rg_builder_stage  top = heap[0];
 
-  ac_free(stage);
+  heap[0] = heap[size];
+  array_resize(*queue, size);
+
+  size_t i = 0;
+  for (;;)
+  {
+    size_t min = i;
+    size_t l = i * 2 + 1;
+    size_t r = l + 1;
+    if (l < size && ac_rg_ready_queue_less(heap[l], heap[min]))
+    {
+      min = l;
+    }
+    if (r < size && ac_rg_ready_queue_less(heap[r], heap[min]))
+    {
+      min = r;
+    }
+    if (min == i)
+    {
+      break;
+    }
+    ac_rg_builder_stage tmp = heap[i];
+    heap[i] = heap[min];
+    heap[min] = tmp;
+    i = min;
+  }
+
+  top->sort_queued = false;
+  return top;
 }
 
-static inline void
-ac_rg_destroy_graph_stages(ac_rg_builder builder)
+// stage placed in timeline advanced its resources, uses of their current
+// states are the only stages which could become ready
+static void
+ac_rg_ready_queue_wake(
+  array_t(ac_rg_builder_stage) * queue,
+  array_t(ac_rg_builder_resource) states)
 {
-  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  for (size_t i = 0; i < array_size(states); ++i)
   {
-    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
-
-    for (size_t si = 0; si < array_size(*stages); ++si)
+    ac_rg_graph_resource* resource = states[i]->resource;
+    if (resource->timeline_state.state >= array_size(resource->states))
     {
-      ac_rg_destroy_graph_stage((*stages)[si]);
+      continue;
     }
 
-    array_free(*stages);
-    *stages = NULL;
+    ac_rg_builder_resource state =
+      resource->states[resource->timeline_state.state];
+
+    for (size_t ui = 0; ui < array_size(state->uses); ++ui)
+    {
+      ac_rg_builder_stage stage = state->uses[ui].builder_stage;
+      if (stage && !stage->sort_queued && !stage->sort_placed)
+      {
+        ac_rg_ready_queue_push(queue, stage);
+      }
+    }
   }
 }
 
-ac_rg_graph_resource_reference
-ac_rg_graph_resource_next_use(ac_rg_graph_resource_reference use)
+// lists stages in order of sort_key as far as dependencies allow. readiness
+// is decided by ac_rg_builder_stage_is_time. queue is seeded with every stage
+// once, stage which is not ready yet is dropped and pushed again only when
+// stage sharing its resources is placed, so each stage is queued at most once
+// per placed neighbour. stages left unplaced form a cycle
+static ac_result
+ac_rg_builder_sort_ready(ac_rg_builder builder, bool* out_sorted)
 {
-  if (use.state < 0)
+  *out_sorted = false;
+
+  size_t count = array_size(builder->stages);
+
+  array_t(ac_rg_builder_stage) queue = NULL;
+  array_reserve(queue, count);
+
+  for (size_t i = 0; i < count; ++i)
   {
-    use.state = 0;
-    use.use = 0;
-    return use;
+    builder->stages[i]->sort_queued = false;
+    builder->stages[i]->sort_placed = false;
   }
 
-  ac_rg_builder_resource state = use.resource->states[use.state];
-
-  if (use.use + 1 < array_size(state->uses))
+  for (size_t i = 0; i < count; ++i)
   {
-    ++use.use;
-    return use;
+    ac_rg_ready_queue_push(&queue, builder->stages[i]);
   }
 
-  if ((size_t)(use.state + 1) < array_size(use.resource->states))
+  size_t placed = 0;
+
+  while (array_size(queue))
   {
-    ++use.state;
-    use.use = 0;
-    return use;
+    ac_rg_builder_stage stage = ac_rg_ready_queue_pop(&queue);
+    if (!ac_rg_builder_stage_is_time(builder, stage))
+    {
+      continue;
+    }
+
+    stage->sort_placed = true;
+    ++placed;
+
+    ac_rg_ready_queue_wake(&queue, stage->resource_states);
+    ac_rg_ready_queue_wake(&queue, stage->resolve_dst);
   }
 
-  use.resource = 0;
-  return use;
+  array_free(queue);
+
+  *out_sorted = placed == count;
+  return ac_result_success;
 }
 
-ac_rg_graph_resource_reference
-ac_rg_graph_resource_prev_use(ac_rg_graph_resource_reference use)
+// breaks ties of critical path keys by position in previous timeline,
+// stages which are new go right after stage recorded before them. graph is
+// still compiled in full, hint only keeps unchanged part of timeline in the
+// same order between recompiles
+static ac_result
+ac_rg_builder_apply_timeline_hint(ac_rg_builder builder)
 {
-  if (use.state < 0)
+  array_t(uint64_t) prev_timeline = builder->cache.timeline;
+
+  struct hashmap* positions = hashmap_new_with_allocator(
+    ac_hashmap_alloc,
+    ac_hashmap_realloc,
+    ac_free,
+    sizeof(ac_rg_stage_position),
+    array_size(prev_timeline),
+    0,
+    0,
+    ac_rg_stage_position_hash,
+    ac_rg_stage_position_compare,
+    NULL,
+    NULL);
+  if (!positions)
   {
-    use.resource = NULL;
-    return use;
+    return ac_result_out_of_host_memory;
   }
 
-  if (use.use != 0)
+  for (uint32_t i = 0; i < array_size(prev_timeline); ++i)
   {
-    --use.use;
-    return use;
+    ac_rg_stage_position position = {
+      .signature = prev_timeline[i],
+      .position = i,
+    };
+    (void)hashmap_set(positions, &position);
+    if (hashmap_oom(positions))
+    {
+      hashmap_free(positions);
+      return ac_result_out_of_host_memory;
+    }
   }
 
-  if (use.state == 0)
+  uint64_t anchor = 0;
+  for (size_t i = 0; i < array_size(builder->stages); ++i)
   {
-    use.resource = NULL;
-    return use;
-  }
+    ac_rg_builder_stage stage = builder->stages[i];
 
-  --use.state;
-  use.use = array_size(use.resource->states[use.state]->uses);
-  if (use.use == 0)
-  {
-    use.resource = NULL;
-  }
-  else
-  {
-    --use.use;
+    ac_rg_stage_position* position = hashmap_get(
+      positions,
+      &(ac_rg_stage_position) {.signature = stage->signature});
+
+    uint64_t hint;
+    if (position)
+    {
+      hint = (uint64_t)position->position * 2 + 1;
+      anchor = hint + 1;
+    }
+    else
+    {
+      hint = anchor;
+    }
+
+    hint = AC_MIN(hint, (uint64_t)UINT32_MAX);
+    stage->sort_key = (stage->sort_key & ~(uint64_t)UINT32_MAX) | hint;
   }
-  return use;
+
+  hashmap_free(positions);
+  return ac_result_success;
 }
 
-static void
-ac_rg_graph_stage_add_fence(
-  array_t(ac_fence_submit_info) * array,
-  ac_fence_submit_info   info,
-  ac_pipeline_stage_bits extra_stages)
+static inline uint64_t
+ac_rg_builder_stage_cost(ac_rg_builder_stage stage)
 {
-  info.stages |= extra_stages;
+  return stage->info.cost ? stage->info.cost : 1;
+}
 
-  for (size_t i = 0; i < array_size(*array); ++i)
+// appends (pred << 32 | stage) edge for every stage using previous state of
+// stage resources and for writers of the same state. uses timeline_index as
+// index into builder stages
+static void
+ac_rg_builder_stage_edges(
+  ac_rg_builder_stage stage,
+  array_t(uint64_t) * edges)
+{
+  for (size_t i = 0; i < array_size(stage->resource_states); ++i)
   {
-    ac_fence_submit_info* fence = (*array) + i;
-    if (fence->fence != info.fence)
-    {
-      continue;
-    }
+    ac_rg_builder_resource state = stage->resource_states[i];
+    ac_rg_builder_resource prev_state =
+      ac_rg_builder_resource_prev_state(state);
 
-    if (fence->value == info.value)
+    for (int pass = 0; pass < 2; ++pass)
     {
-      fence->stages |= info.stages;
-      return;
+      ac_rg_builder_resource src = pass ? state : prev_state;
+      if (!src)
+      {
+        continue;
+      }
+
+      for (size_t ui = 0; ui < array_size(src->uses); ++ui)
+      {
+        ac_rg_graph_resource_use* use = &src->uses[ui];
+        ac_rg_builder_stage       pred = use->builder_stage;
+
+        if (
+          !pred || pred == stage ||
+          (pass && !use->specifics.access_write.access))
+        {
+          continue;
+        }
+
+        array_append(
+          *edges,
+          ((uint64_t)pred->timeline_index << 32) | stage->timeline_index);
+      }
     }
-    break;
   }
+}
 
-  array_append(*array, info);
+static int
+ac_rg_edge_compare(const void* a, const void* b)
+{
+  uint64_t ea = *(const uint64_t*)a;
+  uint64_t eb = *(const uint64_t*)b;
+  return (ea > eb) - (ea < eb);
 }
 
-static void
-ac_rg_graph_add_external_sync(
-  ac_rg_graph_stage*             stage,
-  ac_rg_graph_resource_reference use_reference)
+// keys stages by longest cost path from stage to end of graph, so stages on
+// critical path and producers are listed first and consumers as late as
+// possible
+static ac_result
+ac_rg_builder_compute_critical_path_sort_keys(ac_rg_builder builder)
 {
-  ac_rg_graph_resource* resource = use_reference.resource;
+  size_t count = array_size(builder->stages);
+  if (!count)
+  {
+    return ac_result_success;
+  }
+
+  array_t(uint64_t) edges = NULL;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    builder->stages[i]->timeline_index = (uint32_t)i;
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    ac_rg_builder_stage_edges(builder->stages[i], &edges);
+  }
+
+  qsort(edges, array_size(edges), sizeof(uint64_t), ac_rg_edge_compare);
+
+  uint64_t* heights = ac_calloc(count * sizeof(uint64_t));
+  // offsets (count + 1), cursors, stack, marks
+  uint32_t* scratch = ac_calloc((count * 4 + 1) * sizeof(uint32_t));
+  if (!heights || !scratch)
+  {
+    ac_free(heights);
+    ac_free(scratch);
+    array_free(edges);
+    return ac_result_out_of_host_memory;
+  }
+
+  uint32_t* offsets = scratch;
+  uint32_t* cursors = offsets + count + 1;
+  uint32_t* stack = cursors + count;
+  uint32_t* marks = stack + count;
+
+  for (size_t e = 0; e < array_size(edges); ++e)
+  {
+    ++offsets[(edges[e] >> 32) + 1];
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    offsets[i + 1] += offsets[i];
+  }
+
+  // iterative dfs over successors, edges closing cycle are ignored, cycles
+  // are reported by sort
+  for (uint32_t root = 0; root < count; ++root)
+  {
+    if (marks[root])
+    {
+      continue;
+    }
+
+    size_t sp = 0;
+    stack[sp++] = root;
+    cursors[root] = offsets[root];
+    marks[root] = 1;
+
+    while (sp)
+    {
+      uint32_t node = stack[sp - 1];
+
+      if (cursors[node] < offsets[node + 1])
+      {
+        uint32_t next = (uint32_t)edges[cursors[node]++];
+        if (marks[next] == 0)
+        {
+          cursors[next] = offsets[next];
+          marks[next] = 1;
+          stack[sp++] = next;
+        }
+        else if (marks[next] == 2)
+        {
+          heights[node] = AC_MAX(heights[node], heights[next]);
+        }
+        continue;
+      }
+
+      heights[node] += ac_rg_builder_stage_cost(builder->stages[node]);
+      marks[node] = 2;
+
+      if (--sp)
+      {
+        uint32_t parent = stack[sp - 1];
+        heights[parent] = AC_MAX(heights[parent], heights[node]);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    uint64_t height = AC_MIN(heights[i], (uint64_t)UINT32_MAX);
+    builder->stages[i]->sort_key = ((UINT32_MAX - height) << 32) | i;
+  }
+
+  ac_free(heights);
+  ac_free(scratch);
+  array_free(edges);
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_rg_builder_sort_stages(ac_rg_builder builder)
+{
+  // timeline already initialized
+  AC_ASSERT(array_size(builder->timeline) == 0);
+
+  array_reserve(builder->timeline, array_size(builder->stages));
+
+  for (size_t i = 0; i < array_size(builder->resources); ++i)
+  {
+    ac_rg_graph_resource* resource = builder->resources[i];
+
+    resource->timeline_state = (ac_rg_builder_timeline_state) {
+      .state = 0,
+      .use_count = 0,
+    };
+
+#if 0
+		while ( resource->timeline_state.state < array_size( resource->states ) &&
+		        array_size(
+		          resource->states[ resource->timeline_state.state ]->uses ) == 0 )
+		{
+			++resource->timeline_state.state;
+		}
+#endif
+  }
+
+  ac_result res = ac_rg_builder_compute_stage_signatures(builder);
+  if (res != ac_result_success)
+  {
+    builder->result = res;
+    return res;
+  }
+
+  res = ac_rg_builder_compute_critical_path_sort_keys(builder);
+
+  if (res == ac_result_success && array_size(builder->cache.timeline))
+  {
+    res = ac_rg_builder_apply_timeline_hint(builder);
+  }
+
+  bool sorted = false;
+  if (res == ac_result_success)
+  {
+    res = ac_rg_builder_sort_ready(builder, &sorted);
+  }
+
+  if (res != ac_result_success)
+  {
+    builder->result = res;
+    return res;
+  }
+
+  if (!sorted)
+  {
+    AC_RG_MESSAGE(
+      &builder->rg->callback,
+      &(ac_rg_validation_message_internal) {
+        .id = ac_rg_message_id_error_cyclic_stage_dependencies,
+      });
+
+    builder->result = ac_result_bad_usage;
+    return ac_result_bad_usage;
+  }
+
+  array_resize(builder->cache.timeline, array_size(builder->timeline));
+  for (size_t i = 0; i < array_size(builder->timeline); ++i)
+  {
+    builder->cache.timeline[i] = builder->timeline[i]->signature;
+  }
+
+  if (array_size(builder->timeline) == 0)
+  {
+    array_free(builder->timeline);
+    return ac_result_canceled;
+  }
+  return ac_result_success;
+}
+
+static bool
+ac_rg_builder_stage_can_run_async(ac_rg_builder_stage stage)
+{
+  if (
+    stage->info.commands != ac_queue_type_compute ||
+    stage->info.queue != ac_queue_type_graphics)
+  {
+    return false;
+  }
+
+  // queue ownership of resources living outside of graph is not transferred
+  for (size_t i = 0; i < array_size(stage->resource_states); ++i)
+  {
+    ac_rg_graph_resource* resource = stage->resource_states[i]->resource;
+
+    if (
+      resource->rg_resource || resource->import.is_active ||
+      resource->export.is_active)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static inline bool
+ac_rg_bit_test(const uint64_t* bits, uint32_t index)
+{
+  return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+// stage depends on every stage using previous state of its resources and on
+// writers of the same state
+static void
+ac_rg_builder_stage_ancestors(
+  ac_rg_builder_stage stage,
+  uint64_t*           ancestors,
+  size_t              words)
+{
+  uint64_t* dst = ancestors + stage->timeline_index * words;
+
+  for (size_t i = 0; i < array_size(stage->resource_states); ++i)
+  {
+    ac_rg_builder_resource state = stage->resource_states[i];
+    ac_rg_builder_resource prev_state =
+      ac_rg_builder_resource_prev_state(state);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      ac_rg_builder_resource src = pass ? state : prev_state;
+      if (!src)
+      {
+        continue;
+      }
+
+      for (size_t ui = 0; ui < array_size(src->uses); ++ui)
+      {
+        ac_rg_graph_resource_use* use = &src->uses[ui];
+        ac_rg_builder_stage       pred = use->builder_stage;
+
+        if (
+          !pred || pred->timeline_index >= stage->timeline_index ||
+          (pass && !use->specifics.access_write.access))
+        {
+          continue;
+        }
+
+        const uint64_t* src_bits = ancestors + pred->timeline_index * words;
+        for (size_t w = 0; w < words; ++w)
+        {
+          dst[w] |= src_bits[w];
+        }
+        dst[pred->timeline_index / 64] |= 1ull << (pred->timeline_index % 64);
+      }
+    }
+  }
+}
+
+// stages can run at the same time when neither depends on other
+static inline bool
+ac_rg_builder_stages_overlap(
+  const uint64_t* ancestors,
+  size_t          words,
+  uint32_t        a,
+  uint32_t        b)
+{
+  return a != b && !ac_rg_bit_test(ancestors + a * words, b) &&
+         !ac_rg_bit_test(ancestors + b * words, a);
+}
+
+// moves compute stages to compute queue when graphics stages neither
+// depending on them nor being their dependency have enough unclaimed cost
+// to cover their cost. moved stage claims that cost, so graphics work is
+// overlapped by one compute stage only, and stage whose own cost is claimed
+// stays on graphics. cross queue waits are inserted by synchronisation as
+// for any other stage
+static ac_result
+ac_rg_builder_schedule_async_compute(ac_rg_builder builder)
+{
+  const uint32_t* queue_map = builder->rg->device->queue_map;
+
+  if (
+    !builder->info.async_compute ||
+    queue_map[ac_queue_type_compute] == queue_map[ac_queue_type_graphics])
+  {
+    return ac_result_success;
+  }
+
+  size_t count = array_size(builder->timeline);
+  size_t words = (count + 63) / 64;
+
+  uint64_t* ancestors = ac_calloc(count * words * sizeof(uint64_t));
+  // graphics cost not yet overlapped by moved stage
+  uint64_t* available = ac_calloc(count * sizeof(uint64_t));
+  if (!ancestors || !available)
+  {
+    ac_free(ancestors);
+    ac_free(available);
+    return ac_result_out_of_host_memory;
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    builder->timeline[i]->timeline_index = (uint32_t)i;
+    available[i] = ac_rg_builder_stage_cost(builder->timeline[i]);
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    ac_rg_builder_stage_ancestors(builder->timeline[i], ancestors, words);
+  }
+
+  for (uint32_t ci = 0; ci < count; ++ci)
+  {
+    ac_rg_builder_stage stage = builder->timeline[ci];
+    uint64_t            cost = ac_rg_builder_stage_cost(stage);
+
+    if (!ac_rg_builder_stage_can_run_async(stage) || available[ci] < cost)
+    {
+      continue;
+    }
+
+    uint64_t overlap = 0;
+    for (uint32_t gi = 0; gi < count && overlap < cost; ++gi)
+    {
+      ac_rg_builder_stage other = builder->timeline[gi];
+
+      if (
+        queue_map[other->info.queue] == queue_map[ac_queue_type_graphics] &&
+        ac_rg_builder_stages_overlap(ancestors, words, ci, gi))
+      {
+        overlap += available[gi];
+      }
+    }
+
+    if (overlap < cost)
+    {
+      continue;
+    }
+
+    stage->info.queue = ac_queue_type_compute;
+    available[ci] = 0;
+
+    for (uint32_t gi = 0; gi < count && cost; ++gi)
+    {
+      ac_rg_builder_stage other = builder->timeline[gi];
+
+      if (
+        queue_map[other->info.queue] == queue_map[ac_queue_type_graphics] &&
+        ac_rg_builder_stages_overlap(ancestors, words, ci, gi))
+      {
+        uint64_t claimed = AC_MIN(available[gi], cost);
+        available[gi] -= claimed;
+        cost -= claimed;
+      }
+    }
+  }
+
+  ac_free(ancestors);
+  ac_free(available);
+
+  return ac_result_success;
+}
+
+static inline void
+ac_rg_destroy_graph_stage_barrier(ac_rg_graph_stage_barrier* barrier)
+{
+  array_free(barrier->buffers);
+  array_free(barrier->images);
+
+  array_free(barrier->buffer_nodes);
+  array_free(barrier->image_nodes);
+}
+
+static inline void
+ac_rg_destroy_graph_stage_subpass(ac_rg_graph_stage_subpass* subpass)
+{
+  array_free(subpass->images);
+  array_free(subpass->buffers);
+  array_free(subpass->attachments);
+}
+
+static inline void
+ac_rg_destroy_graph_stage(ac_rg_graph_stage* stage)
+{
+  array_free(stage->fences_signal);
+  array_free(stage->fences_wait);
+
+  for (size_t si = 0; si < array_size(stage->subpasses); ++si)
+  {
+    ac_rg_destroy_graph_stage_subpass(&stage->subpasses[si]);
+  }
+  array_free(stage->subpasses);
+
+  ac_rg_destroy_graph_stage_barrier(&stage->barrier_beg);
+  ac_rg_destroy_graph_stage_barrier(&stage->barrier_end);
+
+  for (size_t i = 0; i < array_size(stage->splits_wait); ++i)
+  {
+    ac_rg_destroy_graph_stage_barrier(&stage->splits_wait[i].barrier);
+  }
+  array_free(stage->splits_wait);
+  array_free(stage->splits_set);
+
+  ac_free(stage);
+}
+
+static inline void
+ac_rg_destroy_graph_stages(ac_rg_builder builder)
+{
+  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
+
+    for (size_t si = 0; si < array_size(*stages); ++si)
+    {
+      ac_rg_destroy_graph_stage((*stages)[si]);
+    }
+
+    array_free(*stages);
+    *stages = NULL;
+  }
+}
+
+ac_rg_graph_resource_reference
+ac_rg_graph_resource_next_use(ac_rg_graph_resource_reference use)
+{
+  if (use.state < 0)
+  {
+    use.state = 0;
+    use.use = 0;
+    return use;
+  }
+
+  ac_rg_builder_resource state = use.resource->states[use.state];
+
+  if (use.use + 1 < array_size(state->uses))
+  {
+    ++use.use;
+    return use;
+  }
+
+  if ((size_t)(use.state + 1) < array_size(use.resource->states))
+  {
+    ++use.state;
+    use.use = 0;
+    return use;
+  }
+
+  use.resource = 0;
+  return use;
+}
+
+ac_rg_graph_resource_reference
+ac_rg_graph_resource_prev_use(ac_rg_graph_resource_reference use)
+{
+  if (use.state < 0)
+  {
+    use.resource = NULL;
+    return use;
+  }
+
+  if (use.use != 0)
+  {
+    --use.use;
+    return use;
+  }
+
+  if (use.state == 0)
+  {
+    use.resource = NULL;
+    return use;
+  }
+
+  --use.state;
+  use.use = array_size(use.resource->states[use.state]->uses);
+  if (use.use == 0)
+  {
+    use.resource = NULL;
+  }
+  else
+  {
+    --use.use;
+  }
+  return use;
+}
+
+static void
+ac_rg_graph_stage_add_fence(
+  array_t(ac_fence_submit_info) * array,
+  ac_fence_submit_info   info,
+  ac_pipeline_stage_bits extra_stages)
+{
+  info.stages |= extra_stages;
+
+  for (size_t i = 0; i < array_size(*array); ++i)
+  {
+    ac_fence_submit_info* fence = (*array) + i;
+    if (fence->fence != info.fence)
+    {
+      continue;
+    }
+
+    if (fence->value == info.value)
+    {
+      fence->stages |= info.stages;
+      return;
+    }
+    break;
+  }
+
+  array_append(*array, info);
+}
+
+static void
+ac_rg_graph_add_external_sync(
+  ac_rg_graph_stage*             stage,
+  ac_rg_graph_resource_reference use_reference)
+{
+  ac_rg_graph_resource* resource = use_reference.resource;
 
   if (
     (resource->import.wait.fence || resource->export.wait.fence) &&
@@ -2685,6 +3348,7 @@ ac_rg_create_graph_subpass(
   ac_rg_graph_stage_subpass* subpass)
 {
   *subpass = (ac_rg_graph_stage_subpass) {
+    .builder_stage = builder_stage,
     .stage_info = builder_stage->info,
     .index = index,
   };
@@ -2798,6 +3462,16 @@ ac_rg_graph_acquire_resource(
     return ac_result_success;
   }
 
+  if (resource->is_aliased)
+  {
+    ac_rg_alias_frame* frame =
+      &builder->aliasing.frames[builder->cmd.frame_pending];
+
+    resource->buffer_or_image = frame->resources[resource->alias_index];
+    resource->is_transient = true;
+    return ac_result_success;
+  }
+
   void* src_info = NULL;
 
   switch (resource->type)
@@ -2870,6 +3544,7 @@ ac_rg_graph_acquire_resource(
   if (rg_resource)
   {
     resource->buffer_or_image = rg_resource->buffer_or_image;
+    resource->is_transient = true;
   }
   return result;
 }
@@ -2966,6 +3641,41 @@ ac_rg_fill_render_pass_info(ac_rg_graph_stage* stage)
       }
     }
   }
+
+  ac_rg_pipeline_key* key = &stage->pipeline_key;
+  key->size = 0;
+
+  ac_rg_pipeline_key_push_u8(key, rendering->color_attachment_count);
+
+  uint32_t samples = 1;
+
+  for (uint32_t i = 0; i < rendering->color_attachment_count; ++i)
+  {
+    ac_image image = rendering->color_attachments[i].image;
+    ac_rg_pipeline_key_push_u16(key, ac_image_get_format(image));
+
+    if (i == 0)
+    {
+      samples = ac_image_get_samples(image);
+    }
+  }
+
+  ac_image depth = rendering->depth_attachment.image;
+  if (depth)
+  {
+    ac_rg_pipeline_key_push_u16(key, ac_image_get_format(depth));
+
+    if (!rendering->color_attachment_count)
+    {
+      samples = ac_image_get_samples(depth);
+    }
+  }
+  else
+  {
+    ac_rg_pipeline_key_push_u16(key, ac_format_undefined);
+  }
+
+  ac_rg_pipeline_key_push_u8(key, samples);
 }
 
 typedef struct ac_rg_dependency {
@@ -3187,9 +3897,28 @@ ac_rg_graph_add_stage_dependency(
     dependency->timeline = time;
   }
 
-  dependency->wait_stage_bits |= this_specifics->access_read.stages;
-  dependency->wait_stage_bits |= this_specifics->access_write.stages;
-  AC_ASSERT(dependency->wait_stage_bits);
+  dependency->wait_stage_bits |= this_specifics->access_read.stages;
+  dependency->wait_stage_bits |= this_specifics->access_write.stages;
+  AC_ASSERT(dependency->wait_stage_bits);
+}
+
+static ac_rg_graph_stage_barrier*
+ac_rg_graph_stage_get_split(ac_rg_graph_stage* stage, ac_rg_graph_stage* src)
+{
+  for (size_t i = 0; i < array_size(stage->splits_wait); ++i)
+  {
+    if (stage->splits_wait[i].src == src)
+    {
+      return &stage->splits_wait[i].barrier;
+    }
+  }
+
+  ac_rg_graph_stage_split split = {
+    .src = src,
+  };
+  array_append(stage->splits_wait, split);
+
+  return &array_back(stage->splits_wait).barrier;
 }
 
 static void
@@ -3238,7 +3967,15 @@ ac_rg_graph_barrier_after_stage(
   else if (is_new_layout || (ctx->sync.dst_access && ctx->sync.src_access))
   {
     ac_rg_graph_stage_barrier* dst;
-    if (next_stage)
+    if (
+      next_stage && this_stage &&
+      this_stage->queue_index == next_stage->queue_index &&
+      next_stage->stage_index > this_stage->stage_index + 1)
+    {
+      // other stages run in between, let them overlap with the barrier
+      dst = ac_rg_graph_stage_get_split(next_stage, this_stage);
+    }
+    else if (next_stage)
     {
       dst = &next_stage->barrier_beg;
     }
@@ -3302,9 +4039,22 @@ ac_rg_graph_resource_sync(
 
   ac_rg_resource_use_specifics* this_specifics = &this_use->specifics;
 
+  // memory of aliased resource was used by other resources before
+  ac_rg_resource_access* alias_previous = NULL;
+  if (this_use_reference.resource->is_aliased)
+  {
+    uint32_t index = this_use_reference.resource->alias_index;
+    ac_rg_alias_resource* alias = &builder->aliasing.resources[index];
+
+    if (alias->previous.stages)
+    {
+      alias_previous = &alias->previous;
+    }
+  }
+
   if (
     !prev_use_reference.resource &&
-    (this_use_reference.resource->rg_resource ||
+    (this_use_reference.resource->rg_resource || alias_previous ||
      (this_use_reference.resource->import.image_layout !=
       this_specifics->image_layout)))
   {
@@ -3330,6 +4080,11 @@ ac_rg_graph_resource_sync(
       AC_ZERO(import_specifics);
       import_specifics.image_layout = ctx.resource->import.image_layout;
 
+      if (alias_previous)
+      {
+        import_specifics.access_write = *alias_previous;
+      }
+
       external_specifics = &import_specifics;
     }
 
@@ -3540,386 +4295,1000 @@ ac_rg_graph_resource_sync(
 
     if (!keep_going)
     {
-      break;
+      break;
+    }
+  }
+  while (next_stage);
+
+  ac_free(subresource_states);
+}
+
+static inline void
+ac_rg_graph_barrier_fill_stages(ac_rg_graph_stage_barrier* barrier)
+{
+  // TODO check if Synchronisation 2 already does that
+  for (size_t bi = 0; bi < array_size(barrier->images); ++bi)
+  {
+    ac_image_barrier* image = &barrier->images[bi];
+
+    if (image->src_stage == 0)
+    {
+      image->src_stage = ac_pipeline_stage_top_of_pipe_bit;
+    }
+    if (image->dst_stage == 0)
+    {
+      image->dst_stage = ac_pipeline_stage_bottom_of_pipe_bit;
+    }
+  }
+
+  for (size_t bi = 0; bi < array_size(barrier->buffers); ++bi)
+  {
+    ac_buffer_barrier* buffer = &barrier->buffers[bi];
+
+    if (buffer->src_stage == 0)
+    {
+      buffer->src_stage = ac_pipeline_stage_top_of_pipe_bit;
+    }
+    if (buffer->dst_stage == 0)
+    {
+      buffer->dst_stage = ac_pipeline_stage_bottom_of_pipe_bit;
+    }
+  }
+}
+
+static void
+ac_rg_initialize_stage_synchronisation(
+  ac_rg_builder      builder,
+  ac_rg_graph_stage* stage)
+{
+  for (size_t si = 0; si < array_size(stage->subpasses); ++si)
+  {
+    ac_rg_graph_stage_subpass* subpass = &stage->subpasses[si];
+    for (size_t ui = 0; ui < array_size(subpass->images); ++ui)
+    {
+      ac_rg_graph_resource_sync(builder, subpass->images[ui]);
+    }
+
+    for (size_t ui = 0; ui < array_size(subpass->attachments); ++ui)
+    {
+      ac_rg_graph_resource_reference use = subpass->attachments[ui];
+      ac_rg_graph_resource_sync(builder, use);
+
+      ac_rg_builder_resource state =
+        ac_rg_graph_resource_dereference_state(use);
+
+      if (use.use == 0 && state->image_resolve_dst)
+      {
+        ac_rg_graph_resource_sync(
+          builder,
+          (ac_rg_graph_resource_reference) {
+            .resource = state->image_resolve_dst->resource,
+            .state = 0,
+            .use = 0,
+          });
+      }
+    }
+
+    for (size_t ui = 0; ui < array_size(subpass->buffers); ++ui)
+    {
+      ac_rg_graph_resource_sync(builder, subpass->buffers[ui]);
+    }
+  }
+
+  ac_rg_graph_barrier_fill_stages(&stage->barrier_beg);
+  ac_rg_graph_barrier_fill_stages(&stage->barrier_end);
+}
+
+static inline void
+ac_rg_graph_barrier_move(
+  ac_rg_graph_stage_barrier* dst,
+  ac_rg_graph_stage_barrier* src)
+{
+  for (size_t i = 0; i < array_size(src->images); ++i)
+  {
+    array_append(dst->images, src->images[i]);
+  }
+
+  for (size_t i = 0; i < array_size(src->buffers); ++i)
+  {
+    array_append(dst->buffers, src->buffers[i]);
+  }
+
+  for (size_t i = 0; i < array_size(src->image_nodes); ++i)
+  {
+    array_append(dst->image_nodes, src->image_nodes[i]);
+  }
+
+  for (size_t i = 0; i < array_size(src->buffer_nodes); ++i)
+  {
+    array_append(dst->buffer_nodes, src->buffer_nodes[i]);
+  }
+
+  array_clear(src->images);
+  array_clear(src->buffers);
+  array_clear(src->image_nodes);
+  array_clear(src->buffer_nodes);
+}
+
+static inline bool
+ac_rg_graph_stage_has_waits(ac_rg_graph_stage* stage)
+{
+  if (array_size(stage->fences_wait))
+  {
+    return true;
+  }
+
+  for (uint32_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    if (qi != stage->queue_index && stage->dependencies[qi].wait_stage_bits)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// assigns split events and merges barriers of neighbouring stages so there
+// is one barrier call between them
+static void
+ac_rg_finalize_stage_barriers(ac_rg_builder builder)
+{
+  builder->split_count = 0;
+
+  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    array_t(ac_rg_graph_stage*) stages = builder->stage_queues[qi];
+
+    for (size_t si = 0; si < array_size(stages); ++si)
+    {
+      ac_rg_graph_stage* stage = stages[si];
+
+      for (size_t i = 0; i < array_size(stage->splits_wait); ++i)
+      {
+        ac_rg_graph_stage_split* split = &stage->splits_wait[i];
+
+        ac_rg_graph_barrier_fill_stages(&split->barrier);
+
+        split->event = builder->split_count++;
+        array_append(split->src->splits_set, split);
+      }
+
+      if (si == 0 || ac_rg_graph_stage_has_waits(stage))
+      {
+        continue;
+      }
+
+      ac_rg_graph_stage_barrier* prev_end = &stages[si - 1]->barrier_end;
+
+      bool has_prev_end =
+        array_size(prev_end->images) || array_size(prev_end->buffers);
+
+      if (has_prev_end)
+      {
+        ac_rg_graph_barrier_move(prev_end, &stage->barrier_beg);
+      }
+    }
+  }
+}
+
+static void
+ac_rg_clear_synchronisation(ac_rg_builder builder)
+{
+  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
+
+    for (size_t si = 0; si < array_size(*stages); ++si)
+    {
+      ac_rg_graph_stage* stage = (*stages)[si];
+
+      AC_ZERO(stage->dependencies);
+
+      for (size_t i = 0; i < AC_COUNTOF(stage->dependencies); ++i)
+      {
+        stage->dependencies[i].wait_stage_bits = 0;
+      }
+
+      array_clear(stage->fences_wait);
+      array_clear(stage->fences_signal);
+
+      array_clear(stage->barrier_beg.images);
+      array_clear(stage->barrier_beg.buffers);
+      array_clear(stage->barrier_beg.image_nodes);
+      array_clear(stage->barrier_beg.buffer_nodes);
+
+      array_clear(stage->barrier_end.images);
+      array_clear(stage->barrier_end.buffers);
+      array_clear(stage->barrier_end.image_nodes);
+      array_clear(stage->barrier_end.buffer_nodes);
+
+      for (size_t i = 0; i < array_size(stage->splits_wait); ++i)
+      {
+        ac_rg_destroy_graph_stage_barrier(&stage->splits_wait[i].barrier);
+      }
+      array_clear(stage->splits_wait);
+      array_clear(stage->splits_set);
+    }
+  }
+}
+
+static bool
+ac_rg_check_can_merge_subpass(
+  ac_rg_builder_stage stage1,
+  ac_rg_builder_stage stage2)
+{
+  // TODO fix barriers when subpasses are merged to single stage
+  if (!AC_RG_TODO)
+  {
+    return false;
+  }
+
+  size_t att_1_count = stage1->attachment_count;
+  size_t att_2_count = stage2->attachment_count;
+  if ((att_1_count == 0 && att_2_count == 0) || att_1_count != att_2_count)
+  {
+    return false;
+  }
+
+  for (size_t ui = 0; ui < att_1_count; ++ui)
+  {
+    ac_rg_builder_resource state1 = stage1->resource_states[ui];
+    if (state1->image_resolve_dst)
+    {
+      return false;
+    }
+
+    ac_rg_builder_resource state2 = stage2->resource_states[ui];
+
+    if (state1->resource != state2->resource)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static ac_result
+ac_rg_create_graph_stages(ac_rg_builder builder)
+{
+  array_t(ac_rg_builder_stage) timeline = builder->timeline;
+
+  ac_rg_builder_stage const* pass_begin = timeline;
+
+  size_t iend = array_size(timeline);
+
+  for (size_t i = 0; i < iend; ++i)
+  {
+    if (
+      i + 1 < iend &&
+      ac_rg_check_can_merge_subpass(timeline[i], timeline[i + 1]))
+    {
+      continue;
+    }
+
+    uint32_t q_i = builder->rg->device->queue_map[(*pass_begin)->info.queue];
+
+    array_t(ac_rg_graph_stage*)* queue = &builder->stage_queues[q_i];
+
+    ac_rg_builder_stage* pass_end = timeline + i + 1;
+
+    ac_rg_graph_stage* stage;
+
+    ac_result res = ac_rg_create_graph_stage(
+      builder,
+      pass_begin,
+      pass_end,
+      (uint32_t)array_size(*queue),
+      &stage);
+    if (res != ac_result_success)
+    {
+      builder->result = res;
+      ac_rg_destroy_graph_stages(builder);
+      return res;
     }
+
+    array_append(*queue, stage);
+
+    pass_begin = pass_end;
   }
-  while (next_stage);
 
-  ac_free(subresource_states);
+  return ac_result_success;
 }
 
-static void
-ac_rg_initialize_stage_synchronisation(
-  ac_rg_builder      builder,
-  ac_rg_graph_stage* stage)
+static ac_result
+ac_rg_update_graph_stages(ac_rg_builder builder)
 {
-  for (size_t si = 0; si < array_size(stage->subpasses); ++si)
+  ac_result res = ac_rg_aliasing_acquire_frame(builder);
+  if (res != ac_result_success)
   {
-    ac_rg_graph_stage_subpass* subpass = &stage->subpasses[si];
-    for (size_t ui = 0; ui < array_size(subpass->images); ++ui)
-    {
-      ac_rg_graph_resource_sync(builder, subpass->images[ui]);
-    }
+    return res;
+  }
 
-    for (size_t ui = 0; ui < array_size(subpass->attachments); ++ui)
+  for (size_t ri = 0; ri < array_size(builder->resources); ++ri)
+  {
+    ac_rg_graph_resource* resource = builder->resources[ri];
+
+    res = ac_rg_graph_acquire_resource(
+      builder,
+      &builder->rg->timelines.signaling_values,
+      resource);
+    if (res != ac_result_success)
     {
-      ac_rg_graph_resource_reference use = subpass->attachments[ui];
-      ac_rg_graph_resource_sync(builder, use);
+      return res;
+    }
 
-      ac_rg_builder_resource state =
-        ac_rg_graph_resource_dereference_state(use);
+    AC_ASSERT(resource->buffer_or_image);
 
-      if (use.use == 0 && state->image_resolve_dst)
+    if (AC_INCLUDE_DEBUG)
+    {
+      for (size_t bri = 0; bri < ri; ++bri)
       {
-        ac_rg_graph_resource_sync(
-          builder,
-          (ac_rg_graph_resource_reference) {
-            .resource = state->image_resolve_dst->resource,
-            .state = 0,
-            .use = 0,
-          });
+        AC_ASSERT(
+          builder->resources[bri]->buffer_or_image !=
+          resource->buffer_or_image);
       }
     }
+  }
 
-    for (size_t ui = 0; ui < array_size(subpass->buffers); ++ui)
+  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
+
+    for (size_t si = 0; si < array_size(*stages); ++si)
     {
-      ac_rg_graph_resource_sync(builder, subpass->buffers[ui]);
+      ac_rg_graph_stage* stage = (*stages)[si];
+
+      if (!stage->is_render_pass)
+      {
+        continue;
+      }
+
+      ac_rg_fill_render_pass_info(stage);
     }
   }
 
-  for (size_t bi = 0; bi < array_size(stage->barrier_beg.images); ++bi)
+  ac_rg_clear_synchronisation(builder);
+
+  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
   {
-    ac_image_barrier* image = &stage->barrier_beg.images[bi];
-    // TODO check if Synchronisation 2 already does that
-    if (image->src_stage == 0)
-    {
-      image->src_stage = ac_pipeline_stage_top_of_pipe_bit;
-    }
-    if (image->dst_stage == 0)
+    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
+
+    for (size_t si = 0; si < array_size(*stages); ++si)
     {
-      image->dst_stage = ac_pipeline_stage_bottom_of_pipe_bit;
+      ac_rg_graph_stage* stage = (*stages)[si];
+      ac_rg_initialize_stage_synchronisation(builder, stage);
     }
   }
 
-  for (size_t bi = 0; bi < array_size(stage->barrier_end.images); ++bi)
+  ac_rg_finalize_stage_barriers(builder);
+
+  return ac_result_success;
+}
+
+static void
+ac_rg_builder_clean(ac_rg_builder builder)
+{
+  array_clear(builder->resource_mappings);
+  array_clear(builder->timeline);
+
+  for (size_t i = 0; i < array_size(builder->stages); ++i)
+  {
+    ac_rg_destroy_builder_stage(builder->stages[i]);
+  }
+  array_clear(builder->stages);
+
+  for (size_t i = 0; i < array_size(builder->resources); ++i)
   {
-    ac_image_barrier* image = &stage->barrier_end.images[bi];
+    ac_rg_destroy_resource_internal(builder->resources[i]);
+  }
+  array_clear(builder->resources);
 
-    if (image->src_stage == 0)
-    {
-      image->src_stage = ac_pipeline_stage_top_of_pipe_bit;
-    }
-    if (image->dst_stage == 0)
-    {
-      image->dst_stage = ac_pipeline_stage_bottom_of_pipe_bit;
-    }
+  array_clear(builder->deferred_exports);
+  array_clear(builder->groups);
+
+  builder->result = ac_result_success;
+}
+
+static void
+ac_rg_builder_swap_state(ac_rg_builder builder, ac_rg_builder_state* state)
+{
+  ac_rg_builder_state tmp = {
+    .resource_mappings = builder->resource_mappings,
+    .resources = builder->resources,
+    .stages = builder->stages,
+    .deferred_exports = builder->deferred_exports,
+    .timeline = builder->timeline,
+    .groups = builder->groups,
+  };
+  memcpy(tmp.stage_queues, builder->stage_queues, sizeof tmp.stage_queues);
+
+  builder->resource_mappings = state->resource_mappings;
+  builder->resources = state->resources;
+  builder->stages = state->stages;
+  builder->deferred_exports = state->deferred_exports;
+  builder->timeline = state->timeline;
+  builder->groups = state->groups;
+  memcpy(builder->stage_queues, state->stage_queues, sizeof tmp.stage_queues);
+
+  *state = tmp;
+}
+
+static void
+ac_rg_builder_clean_state(ac_rg_builder builder, ac_rg_builder_state* state)
+{
+  ac_result result = builder->result;
+
+  ac_rg_builder_swap_state(builder, state);
+  ac_rg_destroy_graph_stages(builder);
+  ac_rg_builder_clean(builder);
+  ac_rg_builder_swap_state(builder, state);
+
+  builder->result = result;
+}
+
+static void
+ac_rg_builder_free_state(ac_rg_builder builder)
+{
+  ac_rg_destroy_graph_stages(builder);
+  ac_rg_builder_clean(builder);
+
+  array_free(builder->resource_mappings);
+  array_free(builder->timeline);
+  array_free(builder->stages);
+  array_free(builder->resources);
+  array_free(builder->deferred_exports);
+  array_free(builder->groups);
+}
+
+void
+ac_rg_destroy_builder(ac_rg_builder builder)
+{
+  ac_rg_builder_free_state(builder);
+
+  ac_rg_builder_swap_state(builder, &builder->scratch);
+  ac_rg_builder_free_state(builder);
+
+  array_free(builder->cache.stages);
+  array_free(builder->cache.resources);
+  array_free(builder->cache.timeline);
+  array_free(builder->cache.key);
+  AC_ZERO(builder->cache);
+  array_free(builder->key);
+
+  ac_rg_destroy_aliasing(builder);
+}
+
+static inline uint64_t
+ac_rg_hash_state_reference(ac_rg_builder_resource state)
+{
+  if (!state)
+  {
+    return UINT64_MAX;
   }
 
-  for (size_t bi = 0; bi < array_size(stage->barrier_beg.buffers); ++bi)
+  // stored index, key stays linear in number of references
+  return ((uint64_t)state->resource->record_index << 32) | state->index;
+}
+
+static inline void
+ac_rg_key_append(array_t(uint64_t) * key, uint64_t value)
+{
+  array_append(*key, value);
+}
+
+static inline void
+ac_rg_key_image_info(array_t(uint64_t) * key, const ac_image_info* info)
+{
+  ac_rg_key_append(key, info->width);
+  ac_rg_key_append(key, info->height);
+  ac_rg_key_append(key, info->format);
+  ac_rg_key_append(key, info->samples);
+  ac_rg_key_append(key, info->layers);
+  ac_rg_key_append(key, info->levels);
+  ac_rg_key_append(key, info->usage);
+  ac_rg_key_append(key, info->type);
+}
+
+static inline void
+ac_rg_key_buffer_info(array_t(uint64_t) * key, const ac_buffer_info* info)
+{
+  ac_rg_key_append(key, info->size);
+  ac_rg_key_append(key, info->usage);
+  ac_rg_key_append(key, info->memory_usage);
+}
+
+static inline void
+ac_rg_key_resource_access(
+  array_t(uint64_t) * key,
+  const ac_rg_resource_access* access)
+{
+  ac_rg_key_append(key, access->stages);
+  ac_rg_key_append(key, access->access);
+}
+
+// key of everything recorded by cb_build that affects compilation. names,
+// callbacks, user data, imported handles and fence values are not part
+// of it, they are patched into the cached graph every frame
+static void
+ac_rg_builder_fill_key(ac_rg_builder builder, array_t(uint64_t) * key)
+{
+  array_clear(*key);
+
+  ac_rg_key_append(key, array_size(builder->stages));
+  ac_rg_key_append(key, array_size(builder->resources));
+  ac_rg_key_append(key, array_size(builder->groups));
+  ac_rg_key_append(key, array_size(builder->deferred_exports));
+
+  for (size_t i = 0; i < array_size(builder->stages); ++i)
   {
-    ac_buffer_barrier* buffer = &stage->barrier_beg.buffers[bi];
+    ac_rg_builder_stage stage = builder->stages[i];
 
-    if (buffer->src_stage == 0)
+    ac_rg_key_append(key, stage->info.queue);
+    ac_rg_key_append(key, stage->info.commands);
+    ac_rg_key_append(key, stage->info.cost);
+    ac_rg_key_append(key, stage->info.cb_condition != NULL);
+    ac_rg_key_append(key, (uint64_t)(uintptr_t)stage->info.group);
+    ac_rg_key_append(key, stage->attachment_count);
+
+    ac_rg_key_append(key, array_size(stage->resource_states));
+    for (size_t j = 0; j < array_size(stage->resource_states); ++j)
     {
-      buffer->src_stage = ac_pipeline_stage_top_of_pipe_bit;
+      ac_rg_key_append(
+        key,
+        ac_rg_hash_state_reference(stage->resource_states[j]));
     }
-    if (buffer->dst_stage == 0)
+
+    ac_rg_key_append(key, array_size(stage->resolve_dst));
+    for (size_t j = 0; j < array_size(stage->resolve_dst); ++j)
     {
-      buffer->dst_stage = ac_pipeline_stage_bottom_of_pipe_bit;
+      ac_rg_key_append(
+        key,
+        ac_rg_hash_state_reference(stage->resolve_dst[j]));
     }
   }
 
-  for (size_t bi = 0; bi < array_size(stage->barrier_end.buffers); ++bi)
+  for (size_t i = 0; i < array_size(builder->resources); ++i)
   {
-    ac_buffer_barrier* buffer = &stage->barrier_end.buffers[bi];
+    ac_rg_graph_resource* resource = builder->resources[i];
 
-    if (buffer->src_stage == 0)
+    ac_rg_key_append(key, resource->type);
+    ac_rg_key_append(key, resource->do_clear);
+    ac_rg_key_append(key, resource->import.is_active);
+    ac_rg_key_append(key, resource->import.image_layout);
+    ac_rg_key_append(key, (uint64_t)(uintptr_t)resource->rg_resource);
+
+    if (resource->type == ac_rg_resource_type_image)
     {
-      buffer->src_stage = ac_pipeline_stage_top_of_pipe_bit;
+      ac_rg_key_image_info(key, &resource->image_info);
     }
-    if (buffer->dst_stage == 0)
+    else
     {
-      buffer->dst_stage = ac_pipeline_stage_bottom_of_pipe_bit;
+      ac_rg_key_buffer_info(key, &resource->buffer_info);
     }
-  }
-}
-
-static void
-ac_rg_clear_synchronisation(ac_rg_builder builder)
-{
-  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
-  {
-    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
 
-    for (size_t si = 0; si < array_size(*stages); ++si)
+    ac_rg_key_append(key, array_size(resource->states));
+    for (size_t si = 0; si < array_size(resource->states); ++si)
     {
-      ac_rg_graph_stage* stage = (*stages)[si];
+      ac_rg_builder_resource state = resource->states[si];
 
-      AC_ZERO(stage->dependencies);
+      ac_rg_key_append(key, state->is_exported);
+      ac_rg_key_append(key, state->is_imported);
+      ac_rg_key_append(key, state->is_read_only);
+      ac_rg_key_append(
+        key,
+        ac_rg_hash_state_reference(state->image_resolve_dst));
 
-      for (size_t i = 0; i < AC_COUNTOF(stage->dependencies); ++i)
+      ac_rg_key_append(key, array_size(state->uses));
+      for (size_t ui = 0; ui < array_size(state->uses); ++ui)
       {
-        stage->dependencies[i].wait_stage_bits = 0;
+        ac_rg_graph_resource_use* use = &state->uses[ui];
+
+        ac_rg_key_append(key, use->builder_stage->record_index);
+        ac_rg_key_append(key, use->usage_bits);
+        ac_rg_key_append(key, use->token);
+        ac_rg_key_resource_access(key, &use->specifics.access_read);
+        ac_rg_key_resource_access(key, &use->specifics.access_write);
+        ac_rg_key_append(key, use->specifics.image_layout);
+        ac_rg_key_append(key, use->specifics.image_range.base_layer);
+        ac_rg_key_append(key, use->specifics.image_range.layers);
+        ac_rg_key_append(key, use->specifics.image_range.base_level);
+        ac_rg_key_append(key, use->specifics.image_range.levels);
       }
+    }
+  }
 
-      array_clear(stage->fences_wait);
-      array_clear(stage->fences_signal);
+  for (size_t i = 0; i < array_size(builder->deferred_exports); ++i)
+  {
+    ac_rg_builder_deferred_resource_export* export =
+      &builder->deferred_exports[i];
 
-      array_clear(stage->barrier_beg.images);
-      array_clear(stage->barrier_beg.buffers);
-      array_clear(stage->barrier_beg.image_nodes);
-      array_clear(stage->barrier_beg.buffer_nodes);
+    ac_rg_key_append(key, ac_rg_hash_state_reference(export->state));
+    ac_rg_key_append(key, (uint64_t)(uintptr_t)export->rg_resource);
 
-      array_clear(stage->barrier_end.images);
-      array_clear(stage->barrier_end.buffers);
-      array_clear(stage->barrier_end.image_nodes);
-      array_clear(stage->barrier_end.buffer_nodes);
+    if (export->state->resource->type == ac_rg_resource_type_image)
+    {
+      ac_rg_key_image_info(key, &export->image_info);
+    }
+    else
+    {
+      ac_rg_key_buffer_info(key, &export->buffer_info);
     }
   }
 }
 
-static bool
-ac_rg_check_can_merge_subpass(
-  ac_rg_builder_stage stage1,
-  ac_rg_builder_stage stage2)
+static uint64_t
+ac_rg_key_hash(array_t(uint64_t) key)
 {
-  // TODO fix barriers when subpasses are merged to single stage
-  if (!AC_RG_TODO)
-  {
-    return false;
-  }
-
-  size_t att_1_count = stage1->attachment_count;
-  size_t att_2_count = stage2->attachment_count;
-  if ((att_1_count == 0 && att_2_count == 0) || att_1_count != att_2_count)
+  uint64_t hash = 0;
+  for (size_t i = 0; i < array_size(key); ++i)
   {
-    return false;
+    ac_rg_hash_combine(&hash, key[i]);
   }
+  return hash;
+}
 
-  for (size_t ui = 0; ui < att_1_count; ++ui)
-  {
-    ac_rg_builder_resource state1 = stage1->resource_states[ui];
-    if (state1->image_resolve_dst)
-    {
-      return false;
-    }
-
-    ac_rg_builder_resource state2 = stage2->resource_states[ui];
-
-    if (state1->resource != state2->resource)
-    {
-      return false;
-    }
+// hash only picks candidate, whole key is compared so collision can not
+// replay graph compiled for different recording
+static bool
+ac_rg_key_equal(array_t(uint64_t) a, array_t(uint64_t) b)
+{
+  size_t size = array_size(a);
+  if (size != array_size(b))
+  {
+    return false;
   }
 
-  return true;
+  return !size || memcmp(a, b, size * sizeof(uint64_t)) == 0;
 }
 
-static ac_result
-ac_rg_create_graph_stages(ac_rg_builder builder)
+static void
+ac_rg_builder_fill_cache(
+  ac_rg_builder builder,
+  uint64_t      hash,
+  size_t        recorded_stage_count,
+  size_t        recorded_resource_count)
 {
-  array_t(ac_rg_builder_stage) timeline = builder->timeline;
-
-  ac_rg_builder_stage const* pass_begin = timeline;
+  ac_rg_builder_cache* cache = &builder->cache;
 
-  size_t iend = array_size(timeline);
+  array_clear(cache->stages);
+  array_resize(cache->stages, recorded_stage_count);
+  array_clear(cache->resources);
+  array_resize(cache->resources, recorded_resource_count);
 
-  for (size_t i = 0; i < iend; ++i)
+  for (size_t i = 0; i < array_size(builder->stages); ++i)
   {
-    if (
-      i + 1 < iend &&
-      ac_rg_check_can_merge_subpass(timeline[i], timeline[i + 1]))
+    ac_rg_builder_stage stage = builder->stages[i];
+    if (stage->record_index != UINT32_MAX)
     {
-      continue;
+      cache->stages[stage->record_index] = stage;
     }
+  }
 
-    uint32_t q_i = builder->rg->device->queue_map[(*pass_begin)->info.queue];
-
-    array_t(ac_rg_graph_stage*)* queue = &builder->stage_queues[q_i];
-
-    ac_rg_builder_stage* pass_end = timeline + i + 1;
-
-    ac_rg_graph_stage* stage;
-
-    ac_result res = ac_rg_create_graph_stage(
-      builder,
-      pass_begin,
-      pass_end,
-      (uint32_t)array_size(*queue),
-      &stage);
-    if (res != ac_result_success)
+  for (size_t i = 0; i < array_size(builder->resources); ++i)
+  {
+    ac_rg_graph_resource* resource = builder->resources[i];
+    if (resource->record_index != UINT32_MAX)
     {
-      builder->result = res;
-      ac_rg_destroy_graph_stages(builder);
-      return res;
+      cache->resources[resource->record_index] = resource;
     }
-
-    array_append(*queue, stage);
-
-    pass_begin = pass_end;
   }
 
-  return ac_result_success;
+  array_t(uint64_t) key = cache->key;
+  cache->key = builder->key;
+  builder->key = key;
+
+  cache->hash = hash;
+  cache->is_valid = true;
 }
 
-static ac_result
-ac_rg_update_graph_stages(ac_rg_builder builder)
+// moves per frame data of the new recording (builder) into the compiled
+// graph (compiled), both recordings have the same key
+static void
+ac_rg_builder_apply_cache(
+  ac_rg_builder        builder,
+  ac_rg_builder_state* compiled)
 {
-  for (size_t ri = 0; ri < array_size(builder->resources); ++ri)
-  {
-    ac_rg_graph_resource* resource = builder->resources[ri];
+  ac_rg_builder_cache* cache = &builder->cache;
 
-    ac_result res = ac_rg_graph_acquire_resource(
-      builder,
-      &builder->rg->timelines.signaling_values,
-      resource);
-    if (res != ac_result_success)
+  AC_ASSERT(array_size(cache->stages) == array_size(builder->stages));
+  AC_ASSERT(array_size(cache->resources) == array_size(builder->resources));
+  AC_ASSERT(array_size(compiled->groups) == array_size(builder->groups));
+
+  for (size_t i = 0; i < array_size(builder->stages); ++i)
+  {
+    ac_rg_builder_stage dst = cache->stages[i];
+    if (dst)
     {
-      return res;
+      // queue could be reassigned by async compute scheduling
+      ac_queue_type queue = dst->info.queue;
+      dst->info = builder->stages[i]->info;
+      dst->info.queue = queue;
     }
+  }
 
-    AC_ASSERT(resource->buffer_or_image);
+  for (size_t i = 0; i < array_size(builder->groups); ++i)
+  {
+    compiled->groups[i].info = builder->groups[i].info;
+  }
 
-    if (AC_INCLUDE_DEBUG)
+  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    for (size_t si = 0; si < array_size(compiled->stage_queues[qi]); ++si)
     {
-      for (size_t bri = 0; bri < ri; ++bri)
+      ac_rg_graph_stage* stage = compiled->stage_queues[qi][si];
+
+      for (size_t spi = 0; spi < array_size(stage->subpasses); ++spi)
       {
-        AC_ASSERT(
-          builder->resources[bri]->buffer_or_image !=
-          resource->buffer_or_image);
+        ac_rg_graph_stage_subpass* subpass = &stage->subpasses[spi];
+        subpass->stage_info = subpass->builder_stage->info;
       }
     }
   }
 
-  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  for (size_t i = 0; i < array_size(compiled->resources); ++i)
   {
-    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
+    ac_rg_graph_resource* resource = compiled->resources[i];
+    if (resource->is_transient)
+    {
+      resource->buffer_or_image = NULL;
+    }
+  }
 
-    for (size_t si = 0; si < array_size(*stages); ++si)
+  for (size_t i = 0; i < array_size(builder->resources); ++i)
+  {
+    ac_rg_graph_resource* src = builder->resources[i];
+    ac_rg_graph_resource* dst = cache->resources[i];
+    if (!dst)
     {
-      ac_rg_graph_stage* stage = (*stages)[si];
+      continue;
+    }
 
-      if (!stage->is_render_pass)
-      {
-        continue;
-      }
+    dst->name = src->name;
 
-      ac_rg_fill_render_pass_info(stage);
+    if (dst->type == ac_rg_resource_type_image)
+    {
+      dst->image_info.name = src->image_info.name;
+      dst->image_info.clear_value = src->image_info.clear_value;
+    }
+    else
+    {
+      dst->buffer_info.name = src->buffer_info.name;
     }
-  }
 
-  ac_rg_clear_synchronisation(builder);
+    if (src->import.is_active)
+    {
+      dst->buffer_or_image = src->buffer_or_image;
+      dst->import.wait = src->import.wait;
+      dst->import.signal = src->import.signal;
+    }
+  }
 
-  for (size_t qi = 0; qi < ac_queue_type_count; ++qi)
+  for (size_t i = 0; i < array_size(builder->deferred_exports); ++i)
   {
-    array_t(ac_rg_graph_stage*)* stages = &builder->stage_queues[qi];
+    ac_rg_builder_deferred_resource_export* src =
+      &builder->deferred_exports[i];
+    ac_rg_builder_deferred_resource_export* dst =
+      &compiled->deferred_exports[i];
 
-    for (size_t si = 0; si < array_size(*stages); ++si)
+    ac_rg_graph_resource* resource = dst->target;
+
+    dst->connection = src->connection;
+
+    resource->export.signal = src->connection.signal;
+    resource->export.wait = src->connection.wait;
+    resource->export.image_layout = src->connection.image_layout;
+
+    if (dst->rg_resource)
     {
-      ac_rg_graph_stage* stage = (*stages)[si];
-      ac_rg_initialize_stage_synchronisation(builder, stage);
+      resource->buffer_or_image = dst->rg_resource->buffer_or_image;
+    }
+    else if (resource->type == ac_rg_resource_type_image)
+    {
+      resource->image = src->connection.image;
+    }
+    else
+    {
+      resource->buffer = src->connection.buffer;
     }
   }
-
-  return ac_result_success;
 }
 
-static void
-ac_rg_builder_clean(ac_rg_builder builder)
+static inline bool
+ac_rg_resource_is_transient(const ac_rg_graph_resource* resource)
 {
-  array_clear(builder->resource_mappings);
-  array_clear(builder->timeline);
-
-  for (size_t i = 0; i < array_size(builder->stages); ++i)
-  {
-    ac_rg_destroy_builder_stage(builder->stages[i]);
-  }
-  array_clear(builder->stages);
+  return !resource->rg_resource && !resource->import.is_active &&
+         !resource->export.is_active;
+}
 
-  for (size_t i = 0; i < array_size(builder->resources); ++i)
+static inline void
+ac_rg_builder_conditional_stage_first_write(
+  ac_rg_builder          builder,
+  ac_rg_builder_stage    stage,
+  ac_rg_builder_resource state)
+{
+  if (
+    ac_rg_builder_resource_prev_state(state) ||
+    !ac_rg_resource_is_transient(state->resource))
   {
-    ac_rg_destroy_resource_internal(builder->resources[i]);
+    return;
   }
-  array_clear(builder->resources);
 
-  array_clear(builder->deferred_exports);
-  array_clear(builder->groups);
+  // message compiles out without AC_INCLUDE_DEBUG
+  AC_UNUSED(builder);
+  AC_UNUSED(stage);
 
-  builder->result = ac_result_success;
+  AC_RG_MESSAGE(
+    &builder->rg->callback,
+    &(ac_rg_validation_message_internal) {
+      .id = ac_rg_message_id_info_conditional_stage_first_write,
+      .stage = stage,
+      .state1 = state,
+    });
 }
 
-void
-ac_rg_destroy_builder(ac_rg_builder builder)
+// skipped stage runs its barriers but writes nothing. memory of resource
+// stays the same for its whole lifetime, so readers of state written by
+// skipped stage see previous state and pass-through edges fold without
+// recompiling. first write of transient resource has nothing to forward,
+// its readers see undefined contents unless they are skipped as well
+static void
+ac_rg_builder_check_conditional_stages(ac_rg_builder builder)
 {
-  ac_rg_destroy_graph_stages(builder);
+  for (size_t i = 0; i < array_size(builder->stages); ++i)
+  {
+    ac_rg_builder_stage stage = builder->stages[i];
+    if (!stage->info.cb_condition)
+    {
+      continue;
+    }
 
-  ac_rg_builder_clean(builder);
+    for (size_t j = 0; j < array_size(stage->resource_states); ++j)
+    {
+      ac_rg_builder_resource state = stage->resource_states[j];
 
-  array_free(builder->timeline);
-  array_free(builder->stages);
-  array_free(builder->resources);
-  array_free(builder->deferred_exports);
-}
+      ac_rg_graph_resource_use* use =
+        ac_rg_builder_find_resource_use(state, stage);
 
-ac_result
-ac_rg_prepare_graph(ac_rg_builder builder)
-{
-  ac_rg_destroy_graph_stages(builder);
-  ac_rg_builder_clean(builder);
+      if (use->specifics.access_write.access)
+      {
+        ac_rg_builder_conditional_stage_first_write(builder, stage, state);
+      }
+    }
 
-  AC_ASSERT(builder->info.cb_build);
+    for (size_t j = 0; j < array_size(stage->resolve_dst); ++j)
+    {
+      ac_rg_builder_conditional_stage_first_write(
+        builder,
+        stage,
+        stage->resolve_dst[j]);
+    }
+  }
+}
 
+static ac_result
+ac_rg_builder_compile(ac_rg_builder builder)
+{
   ac_result res;
 
-  res = builder->info.cb_build(builder, builder->info.user_data);
+  res = ac_rg_builder_apply_zero_states(builder);
   if (res != ac_result_success)
   {
     return res;
   }
 
-  if (builder->result != ac_result_success)
+  ac_rg_builder_remove_unused_stages_and_resources(builder);
+
+  res = ac_rg_builder_determine_resources_create_info(builder);
+  if (res != ac_result_success)
   {
-    return builder->result;
+    return res;
   }
 
-  res = ac_rg_builder_apply_zero_states(builder);
+  res = ac_rg_builder_apply_export(builder);
   if (res != ac_result_success)
   {
     return res;
   }
 
-  ac_rg_builder_remove_unused_stages_and_resources(builder);
+  ac_rg_builder_check_conditional_stages(builder);
 
-  res = ac_rg_builder_determine_resources_create_info(builder);
+  res = ac_rg_builder_apply_zero_states(builder);
   if (res != ac_result_success)
   {
     return res;
   }
 
-  res = ac_rg_builder_apply_export(builder);
+
+  res = ac_rg_builder_sort_stages(builder);
   if (res != ac_result_success)
   {
     return res;
   }
 
-  res = ac_rg_builder_apply_zero_states(builder);
+  res = ac_rg_builder_schedule_async_compute(builder);
   if (res != ac_result_success)
   {
     return res;
   }
 
-  res = ac_rg_builder_sort_stages(builder);
+  res = ac_rg_create_graph_stages(builder);
   if (res != ac_result_success)
   {
     return res;
   }
 
-  res = ac_rg_create_graph_stages(builder);
+  return ac_rg_aliasing_plan(builder);
+}
+
+ac_result
+ac_rg_prepare_graph(ac_rg_builder builder)
+{
+  AC_ASSERT(builder->info.cb_build);
+
+  ac_result res;
+
+  // keep previously compiled graph aside and record new one into the
+  // cleaned scratch arrays
+  ac_rg_builder_swap_state(builder, &builder->scratch);
+  builder->result = ac_result_success;
+
+  builder->is_recording = true;
+  res = builder->info.cb_build(builder, builder->info.user_data);
+  builder->is_recording = false;
+
+  if (res == ac_result_success)
+  {
+    res = builder->result;
+  }
+
+  size_t recorded_stage_count = array_size(builder->stages);
+  size_t recorded_resource_count = array_size(builder->resources);
+
+  uint64_t hash = 0;
+  bool     cache_hit = false;
+
+  if (res == ac_result_success)
+  {
+    ac_rg_builder_fill_key(builder, &builder->key);
+    hash = ac_rg_key_hash(builder->key);
+    cache_hit = builder->cache.is_valid && builder->cache.hash == hash &&
+                ac_rg_key_equal(builder->cache.key, builder->key);
+  }
+
+  if (cache_hit)
+  {
+    ac_rg_builder_apply_cache(builder, &builder->scratch);
+    ac_rg_builder_swap_state(builder, &builder->scratch);
+  }
+  else
+  {
+    builder->cache.is_valid = false;
+  }
+
+  ac_rg_builder_clean_state(builder, &builder->scratch);
+
   if (res != ac_result_success)
   {
     return res;
   }
 
+  if (!cache_hit)
+  {
+    res = ac_rg_builder_compile(builder);
+    if (res != ac_result_success)
+    {
+      return res;
+    }
+
+    ac_rg_builder_fill_cache(
+      builder,
+      hash,
+      recorded_stage_count,
+      recorded_resource_count);
+  }
+
   res = ac_rg_cmd_acquire_frame(builder->rg, &builder->cmd);
   if (res != ac_result_success)
   {
@@ -3949,12 +5318,33 @@ ac_rg_prepare_graph(ac_rg_builder builder)
     {
       ac_rg_graph_stage* stage = (*stages)[si];
 
+      stage->skipped = true;
+
       for (size_t spi = 0; spi < array_size(stage->subpasses); ++spi)
       {
         ac_rg_graph_stage_subpass* pass = &stage->subpasses[spi];
 
         ac_rg_builder_stage_info* pass_info = &pass->stage_info;
 
+        pass->skipped = false;
+
+        if (pass_info->cb_condition)
+        {
+          cb.stage = stage;
+          cb.info.metadata = pass_info->metadata;
+          cb.pass = pass;
+
+          pass->skipped =
+            !pass_info->cb_condition(&cb.info, pass_info->user_data);
+        }
+
+        if (pass->skipped)
+        {
+          continue;
+        }
+
+        stage->skipped = false;
+
         if (pass_info->group)
         {
           ac_rg_builder_group group =
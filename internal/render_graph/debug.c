@@ -330,6 +330,10 @@ ac_rg_message(
     type = ac_rg_validation_message_general_bit;
     severity = ac_rg_validation_severity_info_bit;
     break;
+  case ac_rg_message_id_info_conditional_stage_first_write:
+    type = ac_rg_validation_message_validation_bit;
+    severity = ac_rg_validation_severity_info_bit;
+    break;
   case ac_rg_message_id_error_null_argument:
   case ac_rg_message_id_error_image_create_info_zero:
   case ac_rg_message_id_error_attachment_does_not_match:
@@ -500,6 +504,13 @@ ac_rg_message(
     description = description_buffer;
     break;
   }
+  case ac_rg_message_id_info_conditional_stage_first_write:
+  {
+    description =
+      "stage with cb_condition writes transient resource first, its readers "
+      "see undefined contents when stage is skipped";
+    break;
+  }
   default:
   {
     break;
@@ -682,6 +693,11 @@ ac_rg_print_stage_barriers(ac_rg_graph_stage* stage)
       i == array_size(stage->subpasses) - 1 ? "\n" : "");
   }
 
+  for (size_t i = 0; i < array_size(stage->splits_wait); ++i)
+  {
+    ac_print(NULL, "\tsplit-barrier %u:\n", stage->splits_wait[i].event);
+    ac_rg_print_barrier(NULL, &stage->splits_wait[i].barrier);
+  }
   ac_print(NULL, "\tpre-barrier:\n");
   ac_rg_print_barrier(NULL, &stage->barrier_beg);
   ac_print(NULL, "\tposs-barrier:\n");
@@ -16,17 +16,25 @@ typedef struct ac_rg_execute_context {
 static uint64_t
 ac_rg_pipeline_hash(const void* item, uint64_t seed0, uint64_t seed1)
 {
+  AC_UNUSED(seed0);
+  AC_UNUSED(seed1);
   const ac_rg_pipeline* pipeline = item;
-  return hashmap_murmur(&pipeline->info, sizeof(pipeline->info), seed0, seed1);
+  return pipeline->key.hash;
 }
 
 static int32_t
 ac_rg_pipeline_compare(const void* a, const void* b, void* udata)
 {
   AC_UNUSED(udata);
-  const ac_rg_pipeline* pa = a;
-  const ac_rg_pipeline* pb = b;
-  return memcmp(&pa->info, &pb->info, sizeof(pa->info));
+  const ac_rg_pipeline_key* ka = &((const ac_rg_pipeline*)a)->key;
+  const ac_rg_pipeline_key* kb = &((const ac_rg_pipeline*)b)->key;
+
+  if (ka->size != kb->size)
+  {
+    return (int32_t)ka->size - (int32_t)kb->size;
+  }
+
+  return memcmp(ka->data, kb->data, ka->size);
 }
 
 static void
@@ -50,6 +58,92 @@ ac_rg_destroy_pipelines(ac_rg_pipelines* pipelines)
   pipelines->hashmap = NULL;
 }
 
+static void
+ac_rg_pipeline_job_function(void* data)
+{
+  ac_rg_pipeline_job* job = data;
+  ac_rg               rg = job->rg;
+  ac_rg_pipelines*    pipelines = &rg->pipelines;
+
+  ac_pipeline_info info = job->info;
+  info.name = job->name[0] ? job->name : NULL;
+
+  ac_pipeline pipeline = NULL;
+  ac_result   res = ac_create_pipeline(rg->device, &info, &pipeline);
+
+  ac_mutex_lock(pipelines->mutex);
+
+  ac_rg_pipeline* entry =
+    hashmap_get(pipelines->hashmap, &(ac_rg_pipeline) {.key = job->key});
+  AC_ASSERT(entry);
+  if (entry)
+  {
+    entry->pipeline = pipeline;
+    entry->result = res;
+  }
+
+  ac_mutex_unlock(pipelines->mutex);
+
+  if (job->cb_ready)
+  {
+    job->cb_ready(res, pipeline, job->user_data);
+  }
+
+  ac_free(job);
+}
+
+// called with pipelines mutex locked
+static ac_result
+ac_rg_queue_pipeline(
+  ac_rg                      rg,
+  ac_rg_pipeline*            pipeline,
+  const ac_pipeline_info*    pipeline_info,
+  const ac_rg_pipeline_info* info,
+  const char*                name)
+{
+  ac_rg_pipelines* pipelines = &rg->pipelines;
+
+  // owned by job, freed when compile is done
+  ac_rg_pipeline_job* job = ac_calloc(sizeof(ac_rg_pipeline_job));
+  if (!job)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  pipeline->pipeline = NULL;
+  pipeline->result = ac_result_not_ready;
+
+  (void)hashmap_set(pipelines->hashmap, pipeline);
+  if (hashmap_oom(pipelines->hashmap))
+  {
+    ac_free(job);
+    return ac_result_out_of_host_memory;
+  }
+
+  *job = (ac_rg_pipeline_job) {
+    .rg = rg,
+    .key = pipeline->key,
+    .info = *pipeline_info,
+    .cb_ready = info->cb_ready,
+    .user_data = info->user_data,
+  };
+
+  if (name)
+  {
+    strncpy(job->name, name, sizeof(job->name) - 1);
+  }
+
+  ac_job_run(
+    &(ac_job) {
+      .function = ac_rg_pipeline_job_function,
+      .data = job,
+    },
+    1,
+    &pipelines->counter);
+
+  return ac_result_not_ready;
+}
+
 static void
 ac_rg_destroy_fences(ac_rg_timelines* fences)
 {
@@ -116,7 +210,13 @@ ac_rg_destroy_cmd(ac_rg rg, ac_rg_cmd* rg_cmd)
   for (size_t frame = 0; frame < AC_MAX_FRAME_IN_FLIGHT; ++frame)
   {
     (void)ac_rg_cmd_wait_timelines(rg, rg_cmd, frame);
-    for (size_t i = 0; i < AC_COUNTOF(rg_cmd->pools[frame]); ++i)
+
+    if (!rg_cmd->pools[frame])
+    {
+      continue;
+    }
+
+    for (size_t i = 0; i < rg_cmd->thread_count * ac_queue_type_count; ++i)
     {
       ac_rg_cmd_pool* pool = rg_cmd->pools[frame] + i;
 
@@ -135,28 +235,54 @@ ac_rg_destroy_cmd(ac_rg rg, ac_rg_cmd* rg_cmd)
       array_free(pool->cmds);
       pool->cmds = NULL;
     }
+
+    ac_free(rg_cmd->pools[frame]);
+    rg_cmd->pools[frame] = NULL;
+
+    for (size_t i = 0; i < array_size(rg_cmd->events[frame]); ++i)
+    {
+      ac_destroy_event(rg_cmd->events[frame][i]);
+    }
+    array_free(rg_cmd->events[frame]);
+    rg_cmd->events[frame] = NULL;
   }
 }
 
 static ac_result
-ac_rg_create_cmd(ac_rg rg, ac_rg_cmd* rg_cmd, ac_device device)
+ac_rg_create_cmd(
+  ac_rg      rg,
+  ac_rg_cmd* rg_cmd,
+  ac_device  device,
+  uint32_t   thread_count)
 {
   AC_ZEROP(rg_cmd);
 
+  rg_cmd->thread_count = thread_count;
+
   ac_result res = ac_result_success;
 
   for (size_t frame = 0;
        res == ac_result_success && frame < AC_MAX_FRAME_IN_FLIGHT;
        ++frame)
   {
-    for (size_t i = 0; i < AC_COUNTOF(rg_cmd->pools[frame]); ++i)
+    rg_cmd->pools[frame] =
+      ac_calloc(sizeof(ac_rg_cmd_pool) * thread_count * ac_queue_type_count);
+    if (!rg_cmd->pools[frame])
+    {
+      res = ac_result_out_of_host_memory;
+      break;
+    }
+
+    for (size_t i = 0; i < thread_count * ac_queue_type_count; ++i)
     {
       ac_rg_cmd_pool* pool = rg_cmd->pools[frame] + i;
 
       res = ac_create_cmd_pool(
         device,
         &(ac_cmd_pool_info) {
-          .queue = ac_device_get_queue(device, (ac_queue_type)i),
+          .queue = ac_device_get_queue(
+            device,
+            (ac_queue_type)(i % ac_queue_type_count)),
         },
         &pool->pool);
       if (res != ac_result_success)
@@ -180,9 +306,16 @@ ac_rg_create_cmd(ac_rg rg, ac_rg_cmd* rg_cmd, ac_device device)
 }
 
 static ac_result
-ac_rg_cmd_get_cmd(ac_rg_cmd* rg_cmd, ac_queue_type queue, ac_cmd* out)
+ac_rg_cmd_get_cmd(
+  ac_rg_cmd*    rg_cmd,
+  uint32_t      thread,
+  ac_queue_type queue,
+  ac_cmd*       out)
 {
-  ac_rg_cmd_pool* pool = &rg_cmd->pools[rg_cmd->frame_running][queue];
+  AC_ASSERT(thread < rg_cmd->thread_count);
+
+  ac_rg_cmd_pool* pool = &rg_cmd->pools[rg_cmd->frame_running]
+                                       [thread * ac_queue_type_count + queue];
 
   if (array_size(pool->cmds) == pool->acquired_count)
   {
@@ -215,8 +348,7 @@ ac_rg_cmd_run_frame(ac_rg_cmd* rg_cmd, ac_device device)
   AC_UNUSED(device);
 
   // TODO shrink pool->cmds
-  for (uint32_t i = 0; i < AC_COUNTOF(rg_cmd->pools[rg_cmd->frame_pending]);
-       ++i)
+  for (uint32_t i = 0; i < rg_cmd->thread_count * ac_queue_type_count; ++i)
   {
     ac_rg_cmd_pool* pool = rg_cmd->pools[rg_cmd->frame_pending] + i;
 
@@ -237,6 +369,26 @@ ac_rg_cmd_run_frame(ac_rg_cmd* rg_cmd, ac_device device)
   return ac_result_success;
 }
 
+static ac_result
+ac_rg_cmd_reserve_events(ac_rg_cmd* rg_cmd, ac_device device, uint32_t count)
+{
+  array_t(ac_event)* events = &rg_cmd->events[rg_cmd->frame_pending];
+
+  while (array_size(*events) < count)
+  {
+    ac_event  event;
+    ac_result res = ac_create_event(device, &event);
+    if (res != ac_result_success)
+    {
+      return res;
+    }
+
+    array_append(*events, event);
+  }
+
+  return ac_result_success;
+}
+
 ac_result
 ac_rg_cmd_acquire_frame(ac_rg rg, ac_rg_cmd* rg_cmd)
 {
@@ -272,6 +424,8 @@ ac_create_rg(ac_device device, ac_rg* out_graph)
 
   rg->device = device;
 
+  ac_create_mutex(&rg->pipelines.mutex);
+
   ac_result res = ac_result_success;
 
   if (res == ac_result_success)
@@ -307,7 +461,10 @@ ac_destroy_rg(ac_rg rg)
   ac_rg_destroy_storage(rg);
   ac_rg_destroy_common_passes(&rg->common_passes);
   ac_rg_destroy_fences(&rg->timelines);
+  // queued compiles write to hashmap and call cb_ready
+  ac_job_wait(&rg->pipelines.counter);
   ac_rg_destroy_pipelines(&rg->pipelines);
+  ac_destroy_mutex(rg->pipelines.mutex);
 
   ac_free(rg);
 }
@@ -335,9 +492,21 @@ ac_rg_create_graph(
   builder->rg = rg;
   builder->write_barrier_nodes = AC_RG_BARRIERS_PRINTF;
 
-  ac_result res = ac_rg_create_cmd(rg, &builder->cmd, builder->rg->device);
+  uint32_t thread_count = AC_MAX(info->record_thread_count, 1);
+
+  ac_result res =
+    ac_rg_create_cmd(rg, &builder->cmd, builder->rg->device, thread_count);
+  if (res != ac_result_success)
+  {
+    ac_free(builder);
+    return res;
+  }
+
+  res = ac_rg_create_workers(builder, thread_count);
   if (res != ac_result_success)
   {
+    ac_rg_destroy_workers(builder);
+    ac_rg_destroy_cmd(rg, &builder->cmd);
     ac_free(builder);
     return res;
   }
@@ -377,6 +546,7 @@ ac_rg_destroy_graph(ac_rg_graph graph)
 
   AC_ASSERT(builder->rg->graph_count);
 
+  ac_rg_destroy_workers(builder);
   ac_rg_destroy_cmd(builder->rg, &builder->cmd);
   --builder->rg->graph_count;
 
@@ -466,51 +636,175 @@ ac_rg_stage_get_buffer(ac_rg_stage* user_stage, uint64_t token)
     ->buffer;
 }
 
-AC_API ac_result
-ac_rg_stage_get_pipeline(
-  ac_rg_stage*               stage,
+static ac_result
+ac_rg_make_pipeline_key(
+  const ac_rg_graph_stage*   stage,
   const ac_rg_pipeline_info* info,
-  ac_pipeline*               p)
+  ac_rg_pipeline_key*        key)
 {
-  *p = NULL;
+  key->size = 0;
 
-  ac_rg_stage_internal*      stage_internal = (ac_rg_stage_internal*)stage;
-  ac_rg                      rg = stage_internal->rg;
-  ac_rg_graph_stage*         graph_stage = stage_internal->stage;
-  ac_rg_graph_stage_subpass* pass = stage_internal->pass;
+  ac_rg_pipeline_key_push_u8(key, info->type);
 
-  if (!pass)
+  switch (info->type)
   {
-    AC_ASSERT(0);
-    return ac_result_bad_usage;
+  case ac_pipeline_type_graphics:
+  {
+    const ac_rendering_info* rendering = &stage->rendering;
+
+    ac_rg_pipeline_key_push(
+      key,
+      stage->pipeline_key.data,
+      stage->pipeline_key.size);
+
+    ac_rg_pipeline_key_push(
+      key,
+      &info->vertex_shader,
+      sizeof(info->vertex_shader));
+    ac_rg_pipeline_key_push(
+      key,
+      &info->pixel_shader,
+      sizeof(info->pixel_shader));
+    ac_rg_pipeline_key_push(key, &info->dsl, sizeof(info->dsl));
+
+    const ac_rasterizer_state_info* rasterizer = &info->rasterizer_info;
+    ac_rg_pipeline_key_push_u8(key, rasterizer->cull_mode);
+    ac_rg_pipeline_key_push_u8(key, rasterizer->front_face);
+    ac_rg_pipeline_key_push_u8(key, rasterizer->polygon_mode);
+    ac_rg_pipeline_key_push_u8(key, rasterizer->depth_bias_enable);
+    if (rasterizer->depth_bias_enable)
+    {
+      ac_rg_pipeline_key_push(
+        key,
+        &rasterizer->depth_bias_constant_factor,
+        sizeof(rasterizer->depth_bias_constant_factor));
+      ac_rg_pipeline_key_push(
+        key,
+        &rasterizer->depth_bias_slope_factor,
+        sizeof(rasterizer->depth_bias_slope_factor));
+    }
+
+    ac_rg_pipeline_key_push_u8(key, info->topology);
+
+    if (rendering->depth_attachment.image)
+    {
+      const ac_depth_state_info* depth = &info->depth_state_info;
+      ac_rg_pipeline_key_push_u8(key, depth->depth_test);
+      ac_rg_pipeline_key_push_u8(key, depth->depth_write);
+      ac_rg_pipeline_key_push_u8(key, depth->compare_op);
+    }
+
+    for (uint32_t i = 0; i < rendering->color_attachment_count; ++i)
+    {
+      const ac_blend_attachment_state* blend =
+        &info->blend_state_info.attachment_states[i];
+
+      ac_rg_pipeline_key_push_u8(key, info->color_attachment_discard_bits[i]);
+      ac_rg_pipeline_key_push_u8(key, blend->src_factor);
+      ac_rg_pipeline_key_push_u8(key, blend->dst_factor);
+      ac_rg_pipeline_key_push_u8(key, blend->src_alpha_factor);
+      ac_rg_pipeline_key_push_u8(key, blend->dst_alpha_factor);
+      ac_rg_pipeline_key_push_u8(key, blend->op);
+      ac_rg_pipeline_key_push_u8(key, blend->alpha_op);
+    }
+
+    const ac_vertex_layout* layout = &info->vertex_layout;
+    if (!layout->binding_count || !layout->attribute_count)
+    {
+      ac_rg_pipeline_key_push_u8(key, 0);
+      break;
+    }
+
+    ac_rg_pipeline_key_push_u8(key, layout->binding_count);
+    for (uint32_t i = 0; i < layout->binding_count; ++i)
+    {
+      const ac_vertex_binding_info* binding = &layout->bindings[i];
+      ac_rg_pipeline_key_push_u8(key, binding->binding);
+      ac_rg_pipeline_key_push(key, &binding->stride, sizeof(binding->stride));
+      ac_rg_pipeline_key_push_u8(key, binding->input_rate);
+    }
+
+    ac_rg_pipeline_key_push_u8(key, layout->attribute_count);
+    for (uint32_t i = 0; i < layout->attribute_count; ++i)
+    {
+      const ac_vertex_attribute_info* attribute = &layout->attributes[i];
+      ac_rg_pipeline_key_push_u8(key, attribute->binding);
+      ac_rg_pipeline_key_push_u16(key, attribute->format);
+      ac_rg_pipeline_key_push(
+        key,
+        &attribute->offset,
+        sizeof(attribute->offset));
+      ac_rg_pipeline_key_push_u8(key, attribute->semantic);
+    }
+    break;
+  }
+  case ac_pipeline_type_compute:
+  {
+    ac_rg_pipeline_key_push(
+      key,
+      &info->compute_shader,
+      sizeof(info->compute_shader));
+    ac_rg_pipeline_key_push(key, &info->dsl, sizeof(info->dsl));
+    break;
+  }
+  default:
+  {
+    AC_DEBUG("rt pipelines unimplemented");
+    return ac_result_unknown_error;
+  }
   }
 
-  if (!rg->pipelines.hashmap)
+  key->hash = hashmap_murmur(key->data, key->size, 0, 0);
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_rg_check_pipeline_depth_state(
+  const ac_rg_graph_stage_subpass* pass,
+  const ac_rg_pipeline_info*       info)
+{
+  for (size_t i = 0; i < array_size(pass->attachments); ++i)
   {
-    rg->pipelines.hashmap = hashmap_new(
-      sizeof(ac_rg_pipeline),
-      20,
-      0,
-      0,
-      ac_rg_pipeline_hash,
-      ac_rg_pipeline_compare,
-      NULL,
-      NULL);
-    if (!rg->pipelines.hashmap)
+    ac_rg_graph_resource_reference* reference = &pass->attachments[i];
+
+    if (!ac_format_depth_or_stencil(reference->resource->image_info.format))
+    {
+      continue;
+    }
+
+    ac_rg_graph_resource_use* use =
+      ac_rg_graph_resource_dereference_use(*reference);
+    if (
+      info->depth_state_info.depth_write && !use->specifics.access_write.access)
+    {
+      AC_ASSERT(false);
+      return ac_result_bad_usage;
+    }
+
+    if (info->depth_state_info.depth_test && !use->specifics.access_read.access)
     {
-      return ac_result_out_of_host_memory;
+      AC_ASSERT(false);
+      return ac_result_bad_usage;
     }
+    break;
   }
 
-  ac_rg_pipeline pipeline;
-  AC_ZERO(pipeline);
+  return ac_result_success;
+}
 
-  ac_pipeline_info* dst = &pipeline.info;
+static void
+ac_rg_fill_pipeline_info(
+  const ac_rg_graph_stage*   graph_stage,
+  const ac_rg_pipeline_info* info,
+  ac_pipeline_info*          dst)
+{
+  AC_ZEROP(dst);
 
   if (info->type == ac_pipeline_type_graphics)
   {
     dst->type = ac_pipeline_type_graphics;
-    ac_graphics_pipeline_info* graphics = &pipeline.info.graphics;
+    ac_graphics_pipeline_info* graphics = &dst->graphics;
 
     graphics->vertex_shader = info->vertex_shader;
     graphics->pixel_shader = info->pixel_shader;
@@ -556,33 +850,6 @@ ac_rg_stage_get_pipeline(
         ac_image_get_format(graph_stage->rendering.depth_attachment.image);
 
       graphics->depth_state_info = info->depth_state_info;
-
-      for (size_t i = 0; i < array_size(pass->attachments); ++i)
-      {
-        ac_rg_graph_resource_reference* reference = &pass->attachments[i];
-
-        if (ac_format_depth_or_stencil(reference->resource->image_info.format))
-        {
-          ac_rg_graph_resource_use* use =
-            ac_rg_graph_resource_dereference_use(*reference);
-          if (
-            graphics->depth_state_info.depth_write &&
-            !use->specifics.access_write.access)
-          {
-            AC_ASSERT(false);
-            return ac_result_bad_usage;
-          }
-
-          if (
-            graphics->depth_state_info.depth_test &&
-            !use->specifics.access_read.access)
-          {
-            AC_ASSERT(false);
-            return ac_result_bad_usage;
-          }
-          break;
-        }
-      }
     }
 
     if (graphics->color_attachment_count)
@@ -607,10 +874,72 @@ ac_rg_stage_get_pipeline(
     dst->compute.dsl = info->dsl;
     dst->compute.shader = info->compute_shader;
   }
-  else
+}
+
+AC_API ac_result
+ac_rg_stage_get_pipeline(
+  ac_rg_stage*               stage,
+  const ac_rg_pipeline_info* info,
+  ac_pipeline*               p)
+{
+  *p = NULL;
+
+  ac_rg_stage_internal*      stage_internal = (ac_rg_stage_internal*)stage;
+  ac_rg                      rg = stage_internal->rg;
+  ac_rg_graph_stage*         graph_stage = stage_internal->stage;
+  ac_rg_graph_stage_subpass* pass = stage_internal->pass;
+
+  if (!pass)
   {
-    AC_DEBUG("rt pipelines unimplemented");
-    return ac_result_unknown_error;
+    AC_ASSERT(0);
+    return ac_result_bad_usage;
+  }
+
+  ac_result res;
+
+  if (
+    info->type == ac_pipeline_type_graphics &&
+    graph_stage->rendering.depth_attachment.image)
+  {
+    res = ac_rg_check_pipeline_depth_state(pass, info);
+    if (res != ac_result_success)
+    {
+      return res;
+    }
+  }
+
+  ac_rg_pipeline pipeline;
+  pipeline.pipeline = NULL;
+  pipeline.result = ac_result_success;
+
+  res = ac_rg_make_pipeline_key(graph_stage, info, &pipeline.key);
+  if (res != ac_result_success)
+  {
+    return res;
+  }
+
+  // stages can be recorded from several threads
+  ac_mutex_lock(rg->pipelines.mutex);
+
+  if (!rg->pipelines.hashmap)
+  {
+    rg->pipelines.hashmap = hashmap_new_with_allocator(
+      ac_hashmap_alloc,
+      ac_hashmap_realloc,
+      ac_free,
+      sizeof(ac_rg_pipeline),
+      20,
+      0,
+      0,
+      ac_rg_pipeline_hash,
+      ac_rg_pipeline_compare,
+      NULL,
+      NULL);
+    if (!rg->pipelines.hashmap)
+    {
+      res = ac_result_out_of_host_memory;
+      goto UNLOCK;
+    }
   }
 
   {
@@ -619,33 +948,69 @@ ac_rg_stage_get_pipeline(
     if (old_pipeline)
     {
       *p = old_pipeline->pipeline;
-      return ac_result_success;
+      res = old_pipeline->result;
+      goto UNLOCK;
     }
   }
 
-  dst->name = info->name;
-  if (!dst->name)
+  ac_pipeline_info pipeline_info;
+  ac_rg_fill_pipeline_info(graph_stage, info, &pipeline_info);
+
+  const char* name = info->name;
+  if (!name)
   {
-    dst->name = pass->stage_info.name;
+    name = pass->stage_info.name;
   }
 
-  ac_result res =
-    ac_create_pipeline(rg->device, &pipeline.info, &pipeline.pipeline);
+  // without job threads pipeline is compiled right away
+  if (info->async && ac_job_get_thread_count() > 1)
+  {
+    res = ac_rg_queue_pipeline(rg, &pipeline, &pipeline_info, info, name);
+    goto UNLOCK;
+  }
+
+  pipeline_info.name = name;
+
+  // compile can take milliseconds, other recording threads must not wait
+  // for it
+  ac_mutex_unlock(rg->pipelines.mutex);
+
+  res = ac_create_pipeline(rg->device, &pipeline_info, &pipeline.pipeline);
   if (res != ac_result_success)
   {
     return res;
   }
-  dst->name = NULL;
+
+  pipeline.result = ac_result_success;
+
+  ac_mutex_lock(rg->pipelines.mutex);
+
+  {
+    // other thread created same pipeline meanwhile, keep its one
+    ac_rg_pipeline* old_pipeline =
+      hashmap_get(rg->pipelines.hashmap, &pipeline);
+    if (old_pipeline)
+    {
+      ac_destroy_pipeline(pipeline.pipeline);
+      *p = old_pipeline->pipeline;
+      res = old_pipeline->result;
+      goto UNLOCK;
+    }
+  }
 
   (void)hashmap_set(rg->pipelines.hashmap, &pipeline);
   if (hashmap_oom(rg->pipelines.hashmap))
   {
     ac_destroy_pipeline(pipeline.pipeline);
-    return ac_result_out_of_host_memory;
+    res = ac_result_out_of_host_memory;
+    goto UNLOCK;
   }
 
   *p = pipeline.pipeline;
-  return ac_result_success;
+
+UNLOCK:
+  ac_mutex_unlock(rg->pipelines.mutex);
+  return res;
 }
 
 static void
@@ -674,6 +1039,11 @@ ac_rg_execute_stage(ac_rg_execute_context* ctx, uint32_t subpass)
 
   ac_rg_graph_stage_subpass* pass = &ctx->stage->subpasses[subpass];
 
+  if (pass->skipped)
+  {
+    return;
+  }
+
   ac_rg_builder_stage_info* cb = &pass->stage_info;
 
   if (cb->group != ctx->group_queue_labels[ctx->queue_index])
@@ -734,6 +1104,12 @@ ac_rg_execute_stage(ac_rg_execute_context* ctx, uint32_t subpass)
 static void
 ac_rg_stage_cmd(ac_rg_execute_context* ctx)
 {
+  // barriers and events around the stage are still recorded by caller
+  if (ctx->stage->skipped)
+  {
+    return;
+  }
+
   if (ctx->stage->is_render_pass)
   {
     ac_cmd_begin_rendering(ctx->info.cmd, &ctx->stage->rendering);
@@ -770,6 +1146,259 @@ ac_rg_cmd_barrier(ac_cmd cmd, ac_rg_graph_stage_barrier* barrier)
   ac_cmd_barrier(cmd, nb, barrier->buffers, ni, barrier->images);
 }
 
+static inline void
+ac_rg_set_stage_info(ac_rg_execute_context* ctx, ac_cmd cmd)
+{
+  ac_rg_cmd* rg_cmd = &ctx->builder->cmd;
+
+  ctx->info = (ac_rg_stage) {
+    .device = ctx->builder->rg->device,
+    .cmd = cmd,
+    .frame = rg_cmd->frame_running,
+  };
+
+  memcpy(
+    ctx->info.frame_states,
+    rg_cmd->frame_states,
+    sizeof ctx->info.frame_states);
+}
+
+// stage can join previous submit only if it waits on nothing
+static inline bool
+ac_rg_stage_has_waits(ac_rg_graph_stage* stage, uint32_t queue_index)
+{
+  if (array_size(stage->fences_wait))
+  {
+    return true;
+  }
+
+  for (uint32_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    if (qi != queue_index && stage->dependencies[qi].wait_stage_bits)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static ac_result
+ac_rg_record_stage(
+  ac_rg_execute_context* ctx,
+  uint32_t               thread,
+  bool                   close_labels,
+  ac_cmd*                out)
+{
+  ac_rg_builder builder = ctx->builder;
+  ac_rg_cmd*    rg_cmd = &builder->cmd;
+  uint32_t      qi = ctx->queue_index;
+
+  ac_cmd    cmd;
+  ac_result res =
+    ac_rg_cmd_get_cmd(rg_cmd, thread, ctx->stage->queue_type, &cmd);
+  if (res != ac_result_success)
+  {
+    return res;
+  }
+
+  res = ac_begin_cmd(cmd);
+  if (res != ac_result_success)
+  {
+    return res;
+  }
+
+  if (!ctx->global_queue_labeled[qi] && builder->info.name)
+  {
+    float color[4] = {0.2f, 0.5f, 0.7f, 1};
+    ac_cmd_begin_debug_label(cmd, builder->info.name, color);
+    ctx->global_queue_labeled[qi] = true;
+  }
+
+  ac_event* events = rg_cmd->events[rg_cmd->frame_running];
+
+  for (size_t i = 0; i < array_size(ctx->stage->splits_wait); ++i)
+  {
+    ac_rg_graph_stage_split* split = &ctx->stage->splits_wait[i];
+    ac_cmd_wait_event(
+      cmd,
+      events[split->event],
+      (uint32_t)array_size(split->barrier.buffers),
+      split->barrier.buffers,
+      (uint32_t)array_size(split->barrier.images),
+      split->barrier.images);
+  }
+
+  ac_rg_cmd_barrier(cmd, &ctx->stage->barrier_beg);
+
+  ac_rg_set_stage_info(ctx, cmd);
+
+  ac_rg_stage_cmd(ctx);
+
+  for (size_t i = 0; i < array_size(ctx->stage->splits_set); ++i)
+  {
+    ac_rg_graph_stage_split* split = ctx->stage->splits_set[i];
+    ac_cmd_set_event(
+      cmd,
+      events[split->event],
+      (uint32_t)array_size(split->barrier.buffers),
+      split->barrier.buffers,
+      (uint32_t)array_size(split->barrier.images),
+      split->barrier.images);
+  }
+
+  ac_rg_cmd_barrier(cmd, &ctx->stage->barrier_end);
+
+  if (close_labels)
+  {
+    if (ctx->group_queue_labels[qi])
+    {
+      ac_cmd_end_debug_label(cmd);
+      ctx->group_queue_labels[qi] = 0;
+    }
+
+    if (ctx->global_queue_labeled[qi])
+    {
+      ac_cmd_end_debug_label(cmd);
+      ctx->global_queue_labeled[qi] = false;
+    }
+  }
+
+  res = ac_end_cmd(cmd);
+  if (res != ac_result_success)
+  {
+    return res;
+  }
+
+  *out = cmd;
+  return ac_result_success;
+}
+
+static void
+ac_rg_worker_record(void* data)
+{
+  ac_rg_worker*  worker = data;
+  ac_rg_workers* workers = worker->workers;
+
+  for (;;)
+  {
+    int64_t index = ac_atomic_add_i64(&workers->next_job, 1) - 1;
+    if (index >= (int64_t)array_size(workers->jobs))
+    {
+      break;
+    }
+
+    ac_rg_record_job* job = &workers->jobs[index];
+
+    // every cmd opens and closes its own labels, so order of recording does
+    // not matter
+    ac_rg_execute_context ctx;
+    AC_ZERO(ctx);
+    ctx.builder = workers->builder;
+    ctx.stage = job->stage;
+    ctx.queue_index = job->queue_index;
+
+    job->result = ac_rg_record_stage(&ctx, worker->index, true, &job->cmd);
+  }
+}
+
+ac_result
+ac_rg_create_workers(ac_rg_builder builder, uint32_t thread_count)
+{
+  ac_rg_workers* workers = &builder->workers;
+
+  AC_ZEROP(workers);
+
+  workers->builder = builder;
+
+  if (thread_count < 2)
+  {
+    return ac_result_success;
+  }
+
+  workers->workers = ac_calloc(sizeof(ac_rg_worker) * thread_count);
+  if (!workers->workers)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  for (uint32_t i = 0; i < thread_count; ++i)
+  {
+    ac_rg_worker* worker = &workers->workers[i];
+    worker->workers = workers;
+    worker->index = i;
+  }
+
+  workers->thread_count = thread_count;
+
+  return ac_result_success;
+}
+
+void
+ac_rg_destroy_workers(ac_rg_builder builder)
+{
+  ac_rg_workers* workers = &builder->workers;
+
+  ac_free(workers->workers);
+  array_free(workers->jobs);
+
+  AC_ZEROP(workers);
+}
+
+static ac_result
+ac_rg_record_stages(ac_rg_builder builder, size_t offsets[ac_queue_type_count])
+{
+  ac_rg_workers* workers = &builder->workers;
+
+  array_clear(workers->jobs);
+
+  for (uint32_t qi = 0; qi < ac_queue_type_count; ++qi)
+  {
+    offsets[qi] = array_size(workers->jobs);
+
+    for (size_t i = 0; i < array_size(builder->stage_queues[qi]); ++i)
+    {
+      ac_rg_record_job job = {
+        .stage = builder->stage_queues[qi][i],
+        .queue_index = qi,
+        .result = ac_result_unknown_error,
+      };
+      array_append(workers->jobs, job);
+    }
+  }
+
+  workers->next_job = 0;
+
+  uint32_t job_count =
+    (uint32_t)AC_MIN(workers->thread_count, array_size(workers->jobs));
+
+  ac_job jobs[AC_MAX_JOB_THREADS];
+  job_count = AC_MIN(job_count, AC_MAX_JOB_THREADS);
+  for (uint32_t i = 0; i < job_count; ++i)
+  {
+    jobs[i] = (ac_job) {
+      .function = ac_rg_worker_record,
+      .data = &workers->workers[i],
+    };
+  }
+
+  // calling thread records too while waiting
+  ac_job_counter counter;
+  AC_ZERO(counter);
+  ac_job_run(jobs, job_count, &counter);
+  ac_job_wait(&counter);
+
+  for (size_t i = 0; i < array_size(workers->jobs); ++i)
+  {
+    if (workers->jobs[i].result != ac_result_success)
+    {
+      return workers->jobs[i].result;
+    }
+  }
+
+  return ac_result_success;
+}
+
 static inline void
 ac_rg_update_resource_specifics(
   const ac_rg_graph_resource_reference* use_ref,
@@ -818,7 +1447,7 @@ ac_rg_on_stage_submit_success(
 
     ac_rg_builder_stage_info* builder_stage_info = &subpass->stage_info;
 
-    if (builder_stage_info->cb_submit)
+    if (builder_stage_info->cb_submit && !subpass->skipped)
     {
       ctx->info.metadata = builder_stage_info->metadata;
 
@@ -841,7 +1470,14 @@ ac_rg_execute(ac_rg_builder builder)
 {
   ac_device device = builder->rg->device;
 
-  ac_result res = ac_rg_cmd_run_frame(&builder->cmd, device);
+  ac_result res =
+    ac_rg_cmd_reserve_events(&builder->cmd, device, builder->split_count);
+  if (res != ac_result_success)
+  {
+    return res;
+  }
+
+  res = ac_rg_cmd_run_frame(&builder->cmd, device);
   if (res != ac_result_success)
   {
     return res;
@@ -889,6 +1525,56 @@ ac_rg_execute(ac_rg_builder builder)
   AC_ZERO(ctx);
   ctx.builder = builder;
 
+  bool   parallel = builder->workers.thread_count > 0;
+  size_t offsets[ac_queue_type_count] = {0};
+
+  array_t(ac_cmd) cmds = NULL;
+  // stages other queues wait on, indexed same as jobs
+  array_t(bool) waited = NULL;
+
+  {
+    size_t stage_count = 0;
+    for (uint32_t qi = 0; qi < ac_queue_type_count; ++qi)
+    {
+      offsets[qi] = stage_count;
+      stage_count += array_size(builder->stage_queues[qi]);
+    }
+
+    array_resize(waited, stage_count);
+
+    for (uint32_t qi = 0; qi < ac_queue_type_count; ++qi)
+    {
+      for (size_t i = 0; i < array_size(builder->stage_queues[qi]); ++i)
+      {
+        ac_rg_graph_stage* stage = builder->stage_queues[qi][i];
+
+        for (uint32_t qi2 = 0; qi2 < ac_queue_type_count; ++qi2)
+        {
+          ac_rg_graph_stage_dependency* dependency = &stage->dependencies[qi2];
+          if (qi2 == qi || dependency->wait_stage_bits == 0)
+          {
+            continue;
+          }
+
+          uint64_t index = dependency->timeline - sem_value_offsets[qi2];
+          if (index < array_size(builder->stage_queues[qi2]))
+          {
+            waited[offsets[qi2] + index] = true;
+          }
+        }
+      }
+    }
+  }
+
+  if (parallel)
+  {
+    res = ac_rg_record_stages(builder, offsets);
+    if (res != ac_result_success)
+    {
+      goto CANCEL;
+    }
+  }
+
 WHILE_NOT_DONE:
 
   done = 1;
@@ -940,86 +1626,80 @@ WHILE_NOT_DONE:
       array_append(waits, fence_info);
     }
 
-    if (AC_RG_BARRIERS_PRINTF)
-    {
-      ac_rg_print_stage_barriers(ctx.stage);
-    }
-
-    ac_cmd cmd;
-    res = ac_rg_cmd_get_cmd(&builder->cmd, ctx.stage->queue_type, &cmd);
-    if (res != ac_result_success)
-    {
-      return res;
-    }
+    array_clear(cmds);
 
-    res = ac_begin_cmd(cmd);
-    if (res != ac_result_success)
-    {
-      goto CANCEL;
-    }
+    // consecutive stages without waits go to the same submit, the run is
+    // closed after a stage another queue waits on, so that queue is not
+    // delayed by the rest of the run
+    uint32_t last_index = stage_index;
 
-    if (!ctx.global_queue_labeled[qi] && builder->info.name)
+    for (;;)
     {
-      float color[4] = {0.2f, 0.5f, 0.7f, 1};
-      ac_cmd_begin_debug_label(cmd, builder->info.name, color);
-      ctx.global_queue_labeled[qi] = true;
-    }
+      ac_rg_graph_stage* stage = queue_stages[last_index];
 
-    ac_rg_cmd_barrier(cmd, &ctx.stage->barrier_beg);
+      if (AC_RG_BARRIERS_PRINTF)
+      {
+        ac_rg_print_stage_barriers(stage);
+      }
 
-    ctx.info = (ac_rg_stage) {
-      .device = device,
-      .cmd = cmd,
-      .frame = rg_cmd->frame_running,
-    };
+      ac_cmd cmd;
+      if (parallel)
+      {
+        ac_rg_record_job* job =
+          &builder->workers.jobs[offsets[qi] + last_index];
+        AC_ASSERT(job->stage == stage);
 
-    memcpy(
-      ctx.info.frame_states,
-      rg_cmd->frame_states,
-      sizeof ctx.info.frame_states);
+        cmd = job->cmd;
+      }
+      else
+      {
+        ctx.stage = stage;
+
+        res = ac_rg_record_stage(
+          &ctx,
+          0,
+          last_index + 1 == array_size(queue_stages),
+          &cmd);
+        if (res != ac_result_success)
+        {
+          goto CANCEL;
+        }
+      }
 
-    ac_rg_stage_cmd(&ctx);
+      array_append(cmds, cmd);
 
-    ac_rg_cmd_barrier(cmd, &ctx.stage->barrier_end);
+      for (size_t fi = 0; fi < array_size(stage->fences_signal); ++fi)
+      {
+        array_append(signals, stage->fences_signal[fi]);
+      }
 
-    if (stage_index + 1 == array_size(queue_stages))
-    {
-      if (ctx.group_queue_labels[qi])
+      for (size_t fi = 0; fi < array_size(stage->fences_wait); ++fi)
       {
-        ac_cmd_end_debug_label(cmd);
+        array_append(waits, stage->fences_wait[fi]);
       }
 
-      if (ctx.global_queue_labeled[qi])
+      if (
+        last_index + 1 == array_size(queue_stages) ||
+        waited[offsets[qi] + last_index] ||
+        ac_rg_stage_has_waits(queue_stages[last_index + 1], qi))
       {
-        ac_cmd_end_debug_label(cmd);
+        break;
       }
-    }
 
-    res = ac_end_cmd(cmd);
-    if (res != ac_result_success)
-    {
-      goto CANCEL;
+      ++last_index;
     }
 
+    uint32_t stage_count = last_index - stage_index + 1;
+
     {
       ac_fence_submit_info fence_info = {
         .fence = timelines->fences[qi],
         // TODO			  .stages = 0,
-        .value = timelines->signaling_values.queue_times[qi] + 1,
+        .value = timelines->signaling_values.queue_times[qi] + stage_count,
       };
       array_append(signals, fence_info);
     }
 
-    for (size_t fi = 0; fi < array_size(ctx.stage->fences_signal); ++fi)
-    {
-      array_append(signals, ctx.stage->fences_signal[fi]);
-    }
-
-    for (size_t fi = 0; fi < array_size(ctx.stage->fences_wait); ++fi)
-    {
-      array_append(waits, ctx.stage->fences_wait[fi]);
-    }
-
     // TODO this wait seems useless
     if (wait_prev_frame[qi])
     {
@@ -1032,8 +1712,8 @@ WHILE_NOT_DONE:
     }
 
     ac_queue_submit_info submit_info = {
-      .cmd_count = 1,
-      .cmds = &cmd,
+      .cmd_count = stage_count,
+      .cmds = cmds,
       .wait_fence_count = (uint32_t)array_size(waits),
       .wait_fences = waits,
       .signal_fence_count = (uint32_t)array_size(signals),
@@ -1042,7 +1722,10 @@ WHILE_NOT_DONE:
 
     if (AC_RG_BARRIERS_PRINTF)
     {
-      ac_rg_print_stage_fences(ctx.stage, timelines, &submit_info);
+      ac_rg_print_stage_fences(
+        queue_stages[stage_index],
+        timelines,
+        &submit_info);
     }
 
     res = ac_queue_submit(device->queues[qi], &submit_info);
@@ -1053,10 +1736,18 @@ WHILE_NOT_DONE:
 
     wait_prev_frame[qi] = 0;
 
-    ++executed_inds[qi];
-    timelines->signaling_values.queue_times[qi] += 1;
+    for (uint32_t i = 0; i < stage_count; ++i)
+    {
+      // stage timelines are still counted one per stage, waiters are
+      // satisfied by bigger value signaled at the end of the submit
+      ++executed_inds[qi];
+      timelines->signaling_values.queue_times[qi] += 1;
+
+      ctx.stage = queue_stages[stage_index + i];
+      ac_rg_set_stage_info(&ctx, cmds[i]);
 
-    ac_rg_on_stage_submit_success(builder, &ctx, sem_value_offsets);
+      ac_rg_on_stage_submit_success(builder, &ctx, sem_value_offsets);
+    }
 
   CONTINUE:;
   }
@@ -1071,6 +1762,8 @@ WHILE_NOT_DONE:
 CANCEL:
   array_free(signals);
   array_free(waits);
+  array_free(cmds);
+  array_free(waited);
 
   *curr_timeline = timelines->signaling_values;
 
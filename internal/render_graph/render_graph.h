@@ -64,6 +64,7 @@ typedef enum ac_rg_message_id {
   ac_rg_message_id_error_bad_access_for_given_usage = 12,
   ac_rg_message_id_error_duplicated_token = 13,
   ac_rg_message_id_error_exported_multiple_times = 14,
+  ac_rg_message_id_info_conditional_stage_first_write = 15,
 } ac_rg_message_id;
 
 typedef enum ac_rg_common_pipeline_type {
@@ -138,11 +139,61 @@ typedef struct ac_rg_storage_common_pass_instance {
   ac_rg_common_pass_instance* instance;
 } ac_rg_storage_common_pass_instance;
 
+typedef struct ac_rg_storage_bucket {
+  // normalized info, fields that are not compared are zero
+  ac_rg_resource_type type;
+  union {
+    ac_buffer_info buffer_info;
+    ac_image_info  image_info;
+  };
+  // least recently acquired first
+  array_t(ac_rg_resource) resources;
+} ac_rg_storage_bucket;
+
 typedef struct ac_rg_storage {
   array_t(ac_rg_resource) resources;
+  struct hashmap* buckets;
   array_t(ac_rg_storage_common_pass_instance) common_pass_instances;
 } ac_rg_storage;
 
+// transient placed in shared memory, resources of the same queue whose
+// stage lifetimes don't overlap share bytes of the same heap
+typedef struct ac_rg_alias_resource {
+  struct ac_rg_graph_resource* resource;
+  uint32_t                     queue_index;
+  uint32_t                     first_stage;
+  uint32_t                     last_stage;
+  uint32_t                     heap;
+  uint64_t                     offset;
+  ac_memory_requirements       requirements;
+  // last uses of resources which used same memory before this one
+  ac_rg_resource_access        previous;
+} ac_rg_alias_resource;
+
+typedef struct ac_rg_alias_heap {
+  ac_rg_resource_type type;
+  uint32_t            queue_index;
+  uint32_t            type_bits;
+  uint64_t            size;
+  uint64_t            alignment;
+} ac_rg_alias_heap;
+
+typedef struct ac_rg_alias_frame {
+  uint64_t generation;
+  array_t(ac_memory) memory;
+  // indexed like resources of the generation frame was created with
+  array_t(ac_rg_resource_type) types;
+  array_t(void*) resources;
+} ac_rg_alias_frame;
+
+typedef struct ac_rg_aliasing {
+  // bumped on every compile, frames with other generation are recreated
+  uint64_t generation;
+  array_t(ac_rg_alias_resource) resources;
+  array_t(ac_rg_alias_heap) heaps;
+  ac_rg_alias_frame frames[AC_MAX_FRAME_IN_FLIGHT];
+} ac_rg_aliasing;
+
 typedef struct ac_rg_builder_timeline_state {
   uint32_t state;
   uint32_t use_count;
@@ -171,6 +222,10 @@ typedef struct ac_rg_graph_resource {
     ac_buffer_info buffer_info;
   };
   bool                            used_twice_in_stage;
+  bool                            is_transient;
+  bool                            is_aliased;
+  uint32_t                        alias_index;
+  uint32_t                        record_index;
   ac_rg_resource                  rg_resource;
   ac_rg_graph_resource_connection import;
   ac_rg_graph_resource_connection export;
@@ -188,6 +243,8 @@ typedef struct ac_rg_builder_resource_internal {
   bool                   is_exported;
   bool                   is_imported;
   bool                   is_read_only;
+  // position in resource states, kept up to date on insert and remove
+  uint32_t               index;
   ac_rg_graph_resource*  resource;
   ac_rg_builder_resource image_resolve_dst;
   array_t(ac_rg_graph_resource_use) uses;
@@ -212,6 +269,14 @@ typedef struct ac_rg_graph_stage_barrier {
   array_t(ac_rg_graph_resource*) image_nodes;
 } ac_rg_graph_stage_barrier;
 
+// barrier split between stages of one queue with work between them, set
+// after src stage and waited before the stage owning it
+typedef struct ac_rg_graph_stage_split {
+  struct ac_rg_graph_stage* src;
+  uint32_t                  event;
+  ac_rg_graph_stage_barrier barrier;
+} ac_rg_graph_stage_split;
+
 typedef struct ac_rg_graph_resource_reference {
   ac_rg_graph_resource* resource;
   int32_t               state;
@@ -219,22 +284,40 @@ typedef struct ac_rg_graph_resource_reference {
 } ac_rg_graph_resource_reference;
 
 typedef struct ac_rg_graph_stage_subpass {
+  ac_rg_builder_stage      builder_stage;
   ac_rg_builder_stage_info stage_info;
   uint32_t                 index;
+  // cb_condition result of current frame
+  bool                     skipped;
   array_t(ac_rg_graph_resource_reference) attachments;
   array_t(ac_rg_graph_resource_reference) images;
   array_t(ac_rg_graph_resource_reference) buffers;
 } ac_rg_graph_stage_subpass;
 
+#define AC_RG_PIPELINE_KEY_SIZE 384
+
+// pipeline state packed field by field, unused fields are not written
+typedef struct ac_rg_pipeline_key {
+  uint64_t hash;
+  uint32_t size;
+  uint8_t  data[AC_RG_PIPELINE_KEY_SIZE];
+} ac_rg_pipeline_key;
+
 typedef struct ac_rg_graph_stage {
   ac_queue_type                queue_type;
   uint32_t                     queue_index;
   uint32_t                     stage_index;
   ac_rg_graph_stage_dependency dependencies[ac_queue_type_count];
   bool                         is_render_pass;
+  // every subpass is skipped this frame
+  bool                         skipped;
   ac_rendering_info            rendering;
+  // attachment part of pipeline keys, filled with rendering info
+  ac_rg_pipeline_key           pipeline_key;
   ac_rg_graph_stage_barrier    barrier_beg;
   ac_rg_graph_stage_barrier    barrier_end;
+  array_t(ac_rg_graph_stage_split) splits_wait;
+  array_t(ac_rg_graph_stage_split*) splits_set;
   array_t(ac_rg_graph_stage_subpass) subpasses;
   array_t(ac_fence_submit_info) fences_signal;
   array_t(ac_fence_submit_info) fences_wait;
@@ -244,6 +327,7 @@ typedef struct ac_rg_builder_deferred_resource_export {
   ac_rg_builder_resource    state;
   ac_rg_resource_connection connection;
   ac_rg_resource            rg_resource;
+  ac_rg_graph_resource*     target;
   union {
     ac_image_info  image_info;
     ac_buffer_info buffer_info;
@@ -257,6 +341,12 @@ typedef struct ac_rg_builder_group_internal {
 
 typedef struct ac_rg_builder_stage_internal {
   ac_rg_builder_stage_info info;
+  uint32_t                 record_index;
+  uint64_t                 signature;
+  uint64_t                 sort_key;
+  uint32_t                 timeline_index;
+  bool                     sort_queued;
+  bool                     sort_placed;
   uint32_t                 attachment_count;
   array_t(ac_rg_builder_resource) resource_states; // attachments first
   array_t(ac_rg_builder_resource) resolve_dst;
@@ -269,24 +359,84 @@ typedef struct ac_rg_cmd_pool {
 } ac_rg_cmd_pool;
 
 typedef struct ac_rg_cmd {
-  ac_rg_cmd_pool pools[AC_MAX_FRAME_IN_FLIGHT][ac_queue_type_count];
-  ac_rg_timeline signaling_values[AC_MAX_FRAME_IN_FLIGHT];
+  // thread_count * ac_queue_type_count pools per frame
+  ac_rg_cmd_pool* pools[AC_MAX_FRAME_IN_FLIGHT];
+  uint32_t        thread_count;
+  ac_rg_timeline  signaling_values[AC_MAX_FRAME_IN_FLIGHT];
+  // split barrier events, reused once frame finished
+  array_t(ac_event) events[AC_MAX_FRAME_IN_FLIGHT];
   ac_frame_state frame_states[AC_MAX_FRAME_IN_FLIGHT];
   uint8_t        frame_pending;
   uint8_t        frame_running;
 } ac_rg_cmd;
 
+typedef struct ac_rg_record_job {
+  ac_rg_graph_stage* stage;
+  uint32_t           queue_index;
+  ac_cmd             cmd;
+  ac_result          result;
+} ac_rg_record_job;
+
+struct ac_rg_workers;
+
+// one core job per cmd pool slot, each pulls stages until none are left
+typedef struct ac_rg_worker {
+  struct ac_rg_workers* workers;
+  uint32_t              index;
+} ac_rg_worker;
+
+typedef struct ac_rg_workers {
+  uint32_t      thread_count;
+  ac_rg_worker* workers;
+  ac_rg_builder builder;
+  array_t(ac_rg_record_job) jobs;
+  volatile int64_t next_job;
+} ac_rg_workers;
+
 typedef struct ac_rg_builder_resource_mapping {
   ac_rg_resource        resource;
   ac_rg_graph_resource* history;
 } ac_rg_builder_resource_mapping;
 
+// everything produced by cb_build and the compile passes, kept separately
+// so a new recording can be compared against the compiled one
+typedef struct ac_rg_builder_state {
+  array_t(ac_rg_builder_resource_mapping) resource_mappings;
+  array_t(ac_rg_graph_resource*) resources;
+  array_t(ac_rg_builder_stage) stages;
+  array_t(ac_rg_builder_deferred_resource_export) deferred_exports;
+  array_t(ac_rg_builder_stage) timeline;
+  array_t(ac_rg_graph_stage*) stage_queues[ac_queue_type_count];
+  array_t(ac_rg_builder_group_internal) groups;
+} ac_rg_builder_state;
+
+typedef struct ac_rg_builder_cache {
+  bool     is_valid;
+  uint64_t hash;
+  // values hash was computed from, compared on hash match
+  array_t(uint64_t) key;
+  // compiled objects indexed by record index, null if culled
+  array_t(ac_rg_builder_stage) stages;
+  array_t(ac_rg_graph_resource*) resources;
+  // stage signatures of last sorted timeline, break ties of sort keys when
+  // graph has to be recompiled
+  array_t(uint64_t) timeline;
+} ac_rg_builder_cache;
+
 typedef struct ac_rg_builder_internal {
-  ac_rg_graph_info info;
-  ac_result        result;
-  ac_rg            rg;
-  bool             write_barrier_nodes;
-  ac_rg_cmd        cmd;
+  ac_rg_graph_info    info;
+  ac_result           result;
+  ac_rg               rg;
+  bool                write_barrier_nodes;
+  bool                is_recording;
+  uint32_t            split_count;
+  ac_rg_cmd           cmd;
+  ac_rg_workers       workers;
+  ac_rg_builder_cache cache;
+  // key of current recording, swapped into cache once compiled
+  array_t(uint64_t) key;
+  ac_rg_builder_state scratch;
+  ac_rg_aliasing      aliasing;
   array_t(ac_rg_builder_resource_mapping) resource_mappings;
   array_t(ac_rg_graph_resource*) resources;
   array_t(ac_rg_builder_stage) stages;
@@ -321,12 +471,26 @@ typedef struct ac_rg_timelines {
 } ac_rg_timelines;
 
 typedef struct ac_rg_pipeline {
-  ac_pipeline_info info;
-  ac_pipeline      pipeline;
+  ac_rg_pipeline_key key;
+  ac_pipeline        pipeline;
+  // ac_result_not_ready while compile is queued
+  ac_result result;
 } ac_rg_pipeline;
 
+typedef struct ac_rg_pipeline_job {
+  ac_rg                   rg;
+  ac_rg_pipeline_key      key;
+  ac_pipeline_info        info;
+  char                    name[64];
+  ac_rg_cb_pipeline_ready cb_ready;
+  void*                   user_data;
+} ac_rg_pipeline_job;
+
 typedef struct ac_rg_pipelines {
+  ac_mutex        mutex;
   struct hashmap* hashmap;
+  // async compiles run as jobs
+  ac_job_counter  counter;
 } ac_rg_pipelines;
 
 typedef struct ac_rg_internal {
@@ -342,17 +506,18 @@ typedef struct ac_rg_internal {
 static inline uint32_t
 ac_rg_state_index(const ac_rg_builder_resource state)
 {
-  ac_rg_graph_resource* resource = state->resource;
+  AC_ASSERT(state->resource->states[state->index] == state);
+  return state->index;
+}
 
-  for (uint32_t i = 0; i < array_size(resource->states); ++i)
+// every insert and remove of resource states reindexes states after it
+static inline void
+ac_rg_resource_index_states(ac_rg_graph_resource* resource, uint32_t first)
+{
+  for (uint32_t i = first; i < array_size(resource->states); ++i)
   {
-    if (resource->states[i] == state)
-    {
-      return i;
-    }
+    resource->states[i]->index = i;
   }
-  AC_ASSERT(0);
-  return ~0u;
 }
 
 ac_rg_graph_resource_reference
@@ -382,6 +547,30 @@ ac_rg_graph_resource_dereference_use(ac_rg_graph_resource_reference use)
   return &use.resource->states[use.state]->uses[use.use];
 }
 
+static inline void
+ac_rg_pipeline_key_push(ac_rg_pipeline_key* key, const void* data, size_t size)
+{
+  AC_ASSERT(key->size + size <= sizeof(key->data));
+  memcpy(key->data + key->size, data, size);
+  key->size += (uint32_t)size;
+}
+
+static inline void
+ac_rg_pipeline_key_push_u8(ac_rg_pipeline_key* key, uint32_t value)
+{
+  AC_ASSERT(value <= UINT8_MAX);
+  uint8_t v = (uint8_t)value;
+  ac_rg_pipeline_key_push(key, &v, sizeof(v));
+}
+
+static inline void
+ac_rg_pipeline_key_push_u16(ac_rg_pipeline_key* key, uint32_t value)
+{
+  AC_ASSERT(value <= UINT16_MAX);
+  uint16_t v = (uint16_t)value;
+  ac_rg_pipeline_key_push(key, &v, sizeof(v));
+}
+
 static inline ac_image_subresource_range
 ac_rg_graph_calculate_range(
   ac_image_subresource_range const* in,
@@ -444,9 +633,24 @@ ac_rg_storage_cleanup(
 void
 ac_rg_storage_on_rebuild(ac_rg_storage* storage);
 
+ac_result
+ac_rg_aliasing_plan(ac_rg_builder builder);
+
+ac_result
+ac_rg_aliasing_acquire_frame(ac_rg_builder builder);
+
+void
+ac_rg_destroy_aliasing(ac_rg_builder builder);
+
 ac_result
 ac_rg_cmd_acquire_frame(ac_rg rg, ac_rg_cmd* rg_cmd);
 
+ac_result
+ac_rg_create_workers(ac_rg_builder builder, uint32_t thread_count);
+
+void
+ac_rg_destroy_workers(ac_rg_builder builder);
+
 void
 ac_rg_message(
   ac_rg_validation_callback*               callback,
@@ -22,6 +22,19 @@ ac_rg_destroy_storage(ac_rg rg)
 
   array_free(rg->storage.resources);
 
+  if (rg->storage.buckets)
+  {
+    size_t i = 0;
+    void*  ptr;
+    while (hashmap_iter(rg->storage.buckets, &i, &ptr))
+    {
+      ac_rg_storage_bucket* bucket = ptr;
+      array_free(bucket->resources);
+    }
+
+    hashmap_free(rg->storage.buckets);
+  }
+
   for (size_t i = 0; i < array_size(rg->storage.common_pass_instances); ++i)
   {
     ac_rg_destroy_common_pass_instance(
@@ -32,6 +45,204 @@ ac_rg_destroy_storage(ac_rg rg)
   AC_ZERO(rg->storage);
 }
 
+#define dcmp(x, y)                                                             \
+  cmp = (int32_t)(x##1->y) - (int32_t)(x##2->y);                               \
+  if (cmp != 0)                                                                \
+    return cmp;                                                                \
+  (void)1
+
+static inline int32_t
+ac_rg_storage_compare_buffer_info(
+  const ac_buffer_info* p1,
+  const ac_buffer_info* p2)
+{
+  int32_t cmp;
+  dcmp(p, size);
+  dcmp(p, usage);
+  dcmp(p, memory_usage);
+  return cmp;
+}
+
+static inline int32_t
+ac_rg_storage_compare_image_info(
+  const ac_image_info* p1,
+  const ac_image_info* p2)
+{
+  int32_t cmp;
+  dcmp(p, width);
+  dcmp(p, height);
+  dcmp(p, format);
+  dcmp(p, samples);
+  dcmp(p, layers);
+  dcmp(p, levels);
+  dcmp(p, usage);
+  dcmp(p, type);
+  return cmp;
+}
+
+static int
+ac_rg_storage_compare_instance_info(
+  const ac_rg_common_pass_instance_info* p1,
+  const ac_rg_common_pass_instance_info* p2)
+{
+  int cmp;
+  dcmp(p, pipeline);
+  dcmp(p, commands_type);
+  return cmp;
+}
+
+#undef dcmp
+
+static void
+ac_rg_storage_make_key(
+  ac_rg_resource_type   type,
+  const void*           info,
+  ac_rg_storage_bucket* key)
+{
+  AC_ZEROP(key);
+
+  key->type = type;
+
+  switch (type)
+  {
+  case ac_rg_resource_type_buffer:
+  {
+    const ac_buffer_info* buffer_info = info;
+    key->buffer_info.size = buffer_info->size;
+    key->buffer_info.usage = buffer_info->usage;
+    key->buffer_info.memory_usage = buffer_info->memory_usage;
+    break;
+  }
+  case ac_rg_resource_type_image:
+  {
+    const ac_image_info* image_info = info;
+    key->image_info.width = image_info->width;
+    key->image_info.height = image_info->height;
+    key->image_info.format = image_info->format;
+    key->image_info.samples = image_info->samples;
+    key->image_info.layers = image_info->layers;
+    key->image_info.levels = image_info->levels;
+    key->image_info.usage = image_info->usage;
+    key->image_info.type = image_info->type;
+    break;
+  }
+  default:
+  {
+    AC_ASSERT(false);
+    break;
+  }
+  }
+}
+
+static uint64_t
+ac_rg_storage_bucket_hash(const void* item, uint64_t seed0, uint64_t seed1)
+{
+  // key is zeroed before filling, so padding is stable
+  return hashmap_murmur(
+    item,
+    offsetof(ac_rg_storage_bucket, resources),
+    seed0,
+    seed1);
+}
+
+static int32_t
+ac_rg_storage_bucket_compare(const void* a, const void* b, void* udata)
+{
+  AC_UNUSED(udata);
+  const ac_rg_storage_bucket* ba = a;
+  const ac_rg_storage_bucket* bb = b;
+
+  if (ba->type != bb->type)
+  {
+    return (int32_t)ba->type - (int32_t)bb->type;
+  }
+
+  if (ba->type == ac_rg_resource_type_buffer)
+  {
+    return ac_rg_storage_compare_buffer_info(
+      &ba->buffer_info,
+      &bb->buffer_info);
+  }
+
+  return ac_rg_storage_compare_image_info(&ba->image_info, &bb->image_info);
+}
+
+static ac_rg_storage_bucket*
+ac_rg_storage_get_bucket(ac_rg_resource resource, ac_rg_storage* storage)
+{
+  if (!storage->buckets)
+  {
+    return NULL;
+  }
+
+  ac_rg_storage_bucket key;
+  ac_rg_storage_make_key(resource->type, &resource->image_info, &key);
+
+  return hashmap_get(storage->buckets, &key);
+}
+
+static ac_result
+ac_rg_storage_add_resource(ac_rg_storage* storage, ac_rg_resource resource)
+{
+  if (!storage->buckets)
+  {
+    storage->buckets = hashmap_new_with_allocator(
+      ac_hashmap_alloc,
+      ac_hashmap_realloc,
+      ac_free,
+      sizeof(ac_rg_storage_bucket),
+      20,
+      0,
+      0,
+      ac_rg_storage_bucket_hash,
+      ac_rg_storage_bucket_compare,
+      NULL,
+      NULL);
+    if (!storage->buckets)
+    {
+      return ac_result_out_of_host_memory;
+    }
+  }
+
+  ac_rg_storage_bucket key;
+  ac_rg_storage_make_key(resource->type, &resource->image_info, &key);
+
+  ac_rg_storage_bucket* bucket = hashmap_get(storage->buckets, &key);
+  if (!bucket)
+  {
+    (void)hashmap_set(storage->buckets, &key);
+    if (hashmap_oom(storage->buckets))
+    {
+      return ac_result_out_of_host_memory;
+    }
+
+    bucket = hashmap_get(storage->buckets, &key);
+  }
+
+  array_append(bucket->resources, resource);
+
+  return ac_result_success;
+}
+
+static void
+ac_rg_storage_remove_resource(ac_rg_storage* storage, ac_rg_resource resource)
+{
+  ac_rg_storage_bucket* bucket = ac_rg_storage_get_bucket(resource, storage);
+  if (!bucket)
+  {
+    return;
+  }
+
+  for (size_t i = 0; i < array_size(bucket->resources); ++i)
+  {
+    if (bucket->resources[i] == resource)
+    {
+      array_remove(bucket->resources, i);
+      return;
+    }
+  }
+}
+
 void
 ac_rg_storage_cleanup(
   ac_rg                 rg,
@@ -56,6 +267,7 @@ ac_rg_storage_cleanup(
       resource->release_time.timeline <=
         signaled_timeline->queue_times[resource->release_time.queue_index])
     {
+      ac_rg_storage_remove_resource(&rg->storage, resource);
       ac_rg_destroy_resource(rg, resource);
       continue;
     }
@@ -104,54 +316,6 @@ ac_rg_storage_on_rebuild(ac_rg_storage* storage)
   }
 }
 
-#define dcmp(x, y)                                                             \
-  cmp = (int32_t)(x##1->y) - (int32_t)(x##2->y);                               \
-  if (cmp != 0)                                                                \
-    return cmp;                                                                \
-  (void)1
-
-static inline int32_t
-ac_rg_storage_compare_buffer_info(
-  const ac_buffer_info* p1,
-  const ac_buffer_info* p2)
-{
-  int32_t cmp;
-  dcmp(p, size);
-  dcmp(p, usage);
-  dcmp(p, memory_usage);
-  return cmp;
-}
-
-static inline int32_t
-ac_rg_storage_compare_image_info(
-  const ac_image_info* p1,
-  const ac_image_info* p2)
-{
-  int32_t cmp;
-  dcmp(p, width);
-  dcmp(p, height);
-  dcmp(p, format);
-  dcmp(p, samples);
-  dcmp(p, layers);
-  dcmp(p, levels);
-  dcmp(p, usage);
-  dcmp(p, type);
-  return cmp;
-}
-
-static int
-ac_rg_storage_compare_instance_info(
-  const ac_rg_common_pass_instance_info* p1,
-  const ac_rg_common_pass_instance_info* p2)
-{
-  int cmp;
-  dcmp(p, pipeline);
-  dcmp(p, commands_type);
-  return cmp;
-}
-
-#undef dcmp
-
 ac_result
 ac_rg_storage_get_resource(
   ac_rg                 rg,
@@ -177,15 +341,19 @@ ac_rg_storage_get_resource(
     image_info = resource_info;
   }
 
-  uint64_t count = array_size(rg->storage.resources);
-  for (uint64_t i = 0; i < count; ++i)
+  ac_rg_storage_bucket* bucket = NULL;
+  if (rg->storage.buckets)
   {
-    ac_rg_resource resource = rg->storage.resources[i];
+    ac_rg_storage_bucket key;
+    ac_rg_storage_make_key(resource_type, resource_info, &key);
 
-    if (resource->type != resource_type)
-    {
-      continue;
-    }
+    bucket = hashmap_get(rg->storage.buckets, &key);
+  }
+
+  uint64_t count = bucket ? array_size(bucket->resources) : 0;
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    ac_rg_resource resource = bucket->resources[i];
 
     uint64_t time =
       acquire_time->queue_times[resource->release_time.queue_index];
@@ -195,54 +363,486 @@ ac_rg_storage_get_resource(
       continue;
     }
 
-    switch (resource_type)
+    // keep bucket ordered by acquire, so free resources are found first
+    if (i + 1 != count)
+    {
+      array_remove(bucket->resources, i);
+      array_append(bucket->resources, resource);
+    }
+
+    *out_resource = resource;
+    resource->release_time = release_time;
+    return ac_result_success;
+  }
+
+  ac_rg_resource resource = NULL;
+  ac_result res = ac_rg_create_resource(rg, image_info, buffer_info, &resource);
+  if (res != ac_result_success)
+  {
+    return res;
+  }
+
+  --resource->reference_count;
+
+  resource->release_time = release_time;
+  *out_resource = resource;
+  return ac_result_success;
+}
+
+static bool
+ac_rg_alias_candidate(
+  ac_rg_graph_resource* resource,
+  ac_rg_alias_resource* out)
+{
+  if (
+    resource->buffer_or_image || resource->rg_resource ||
+    resource->import.is_active || resource->export.is_active)
+  {
+    return false;
+  }
+
+  if (
+    resource->type == ac_rg_resource_type_buffer &&
+    resource->buffer_info.memory_usage != ac_memory_usage_gpu_only)
+  {
+    return false;
+  }
+
+  AC_ZEROP(out);
+  out->resource = resource;
+  out->first_stage = UINT32_MAX;
+
+  for (size_t si = 0; si < array_size(resource->states); ++si)
+  {
+    ac_rg_builder_resource state = resource->states[si];
+
+    for (size_t ui = 0; ui < array_size(state->uses); ++ui)
     {
-    case ac_rg_resource_type_buffer:
+      ac_rg_graph_stage* stage = state->uses[ui].graph_stage;
+      if (!stage)
+      {
+        continue;
+      }
+
+      // resources shared by queues would need cross queue ordering between
+      // aliases, keep them in the pool
+      if (out->first_stage == UINT32_MAX)
+      {
+        out->queue_index = stage->queue_index;
+      }
+      else if (out->queue_index != stage->queue_index)
+      {
+        return false;
+      }
+
+      out->first_stage = AC_MIN(out->first_stage, stage->stage_index);
+      out->last_stage = AC_MAX(out->last_stage, stage->stage_index);
+    }
+  }
+
+  return out->first_stage != UINT32_MAX;
+}
+
+static ac_rg_resource_access
+ac_rg_alias_last_access(const ac_rg_alias_resource* alias)
+{
+  ac_rg_resource_access access = {0};
+
+  ac_rg_graph_resource* resource = alias->resource;
+
+  for (size_t si = 0; si < array_size(resource->states); ++si)
+  {
+    ac_rg_builder_resource state = resource->states[si];
+
+    for (size_t ui = 0; ui < array_size(state->uses); ++ui)
     {
-      if (ac_rg_storage_compare_buffer_info(
-            &resource->buffer_info,
-            buffer_info))
+      ac_rg_graph_resource_use* use = &state->uses[ui];
+      if (
+        !use->graph_stage ||
+        use->graph_stage->stage_index != alias->last_stage)
       {
         continue;
       }
 
+      access.stages |= use->specifics.access_read.stages;
+      access.stages |= use->specifics.access_write.stages;
+      access.access |= use->specifics.access_read.access;
+      access.access |= use->specifics.access_write.access;
+    }
+  }
+
+  return access;
+}
+
+static inline bool
+ac_rg_alias_lifetimes_overlap(
+  const ac_rg_alias_resource* a,
+  const ac_rg_alias_resource* b)
+{
+  return a->first_stage <= b->last_stage && b->first_stage <= a->last_stage;
+}
+
+static inline bool
+ac_rg_alias_memory_overlap(
+  const ac_rg_alias_resource* a,
+  const ac_rg_alias_resource* b)
+{
+  return a->heap == b->heap &&
+         a->offset < b->offset + b->requirements.size &&
+         b->offset < a->offset + a->requirements.size;
+}
+
+static int
+ac_rg_alias_compare_size(const void* a, const void* b)
+{
+  const ac_rg_alias_resource* ra = a;
+  const ac_rg_alias_resource* rb = b;
+
+  if (ra->requirements.size != rb->requirements.size)
+  {
+    return ra->requirements.size > rb->requirements.size ? -1 : 1;
+  }
+
+  return (int)ra->resource->record_index - (int)rb->resource->record_index;
+}
+
+static int
+ac_rg_alias_compare_range(const void* a, const void* b)
+{
+  const uint64_t* ra = a;
+  const uint64_t* rb = b;
+
+  if (ra[0] != rb[0])
+  {
+    return ra[0] < rb[0] ? -1 : 1;
+  }
+
+  return 0;
+}
+
+// first fit offset in heap which doesn't overlap resources placed before
+// with intersecting lifetimes
+static uint64_t
+ac_rg_alias_find_offset(
+  ac_rg_aliasing*             aliasing,
+  size_t                      count,
+  const ac_rg_alias_resource* alias,
+  uint32_t                    heap,
+  uint64_t*                   ranges)
+{
+  size_t range_count = 0;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const ac_rg_alias_resource* other = &aliasing->resources[i];
+
+    if (other->heap != heap || !ac_rg_alias_lifetimes_overlap(alias, other))
+    {
+      continue;
+    }
+
+    ranges[range_count * 2 + 0] = other->offset;
+    ranges[range_count * 2 + 1] = other->offset + other->requirements.size;
+    ++range_count;
+  }
+
+  qsort(ranges, range_count, sizeof(uint64_t) * 2, ac_rg_alias_compare_range);
+
+  uint64_t alignment = AC_MAX(alias->requirements.alignment, 1);
+  uint64_t offset = 0;
+
+  for (size_t i = 0; i < range_count; ++i)
+  {
+    uint64_t aligned = AC_ALIGN_UP(offset, alignment);
+    if (aligned + alias->requirements.size <= ranges[i * 2])
+    {
       break;
     }
-    case ac_rg_resource_type_image:
+
+    offset = AC_MAX(offset, ranges[i * 2 + 1]);
+  }
+
+  return AC_ALIGN_UP(offset, alignment);
+}
+
+static void
+ac_rg_destroy_alias_frame(ac_rg_alias_frame* frame)
+{
+  for (size_t i = 0; i < array_size(frame->resources); ++i)
+  {
+    if (!frame->resources[i])
+    {
+      continue;
+    }
+
+    if (frame->types[i] == ac_rg_resource_type_buffer)
     {
-      if (ac_rg_storage_compare_image_info(&resource->image_info, image_info))
+      ac_destroy_buffer(frame->resources[i]);
+    }
+    else
+    {
+      ac_destroy_image(frame->resources[i]);
+    }
+  }
+  array_clear(frame->resources);
+  array_clear(frame->types);
+
+  for (size_t i = 0; i < array_size(frame->memory); ++i)
+  {
+    ac_destroy_memory(frame->memory[i]);
+  }
+  array_clear(frame->memory);
+
+  frame->generation = 0;
+}
+
+ac_result
+ac_rg_aliasing_plan(ac_rg_builder builder)
+{
+  ac_rg_aliasing* aliasing = &builder->aliasing;
+  ac_device       device = builder->rg->device;
+
+  // frames are recreated lazily when they are acquired again
+  ++aliasing->generation;
+  array_clear(aliasing->resources);
+  array_clear(aliasing->heaps);
+
+  if (!ac_device_support_placed_resources(device))
+  {
+    return ac_result_success;
+  }
+
+  for (size_t ri = 0; ri < array_size(builder->resources); ++ri)
+  {
+    ac_rg_graph_resource* resource = builder->resources[ri];
+
+    ac_rg_alias_resource alias;
+    if (!ac_rg_alias_candidate(resource, &alias))
+    {
+      continue;
+    }
+
+    ac_result res;
+    if (resource->type == ac_rg_resource_type_buffer)
+    {
+      res = ac_get_buffer_memory_requirements(
+        device,
+        &resource->buffer_info,
+        &alias.requirements);
+    }
+    else
+    {
+      res = ac_get_image_memory_requirements(
+        device,
+        &resource->image_info,
+        &alias.requirements);
+    }
+
+    if (res != ac_result_success)
+    {
+      return res;
+    }
+
+    array_append(aliasing->resources, alias);
+  }
+
+  size_t count = array_size(aliasing->resources);
+  if (!count)
+  {
+    return ac_result_success;
+  }
+
+  // biggest first, small resources fill gaps left between them
+  qsort(
+    aliasing->resources,
+    count,
+    sizeof(*aliasing->resources),
+    ac_rg_alias_compare_size);
+
+  uint64_t* ranges = ac_alloc(count * 2 * sizeof(uint64_t));
+  if (!ranges)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    ac_rg_alias_resource* alias = &aliasing->resources[i];
+
+    uint32_t heap_index = UINT32_MAX;
+    uint64_t offset = 0;
+    bool     fits = false;
+
+    for (uint32_t h = 0; h < array_size(aliasing->heaps); ++h)
+    {
+      ac_rg_alias_heap* heap = &aliasing->heaps[h];
+
+      if (
+        heap->type != alias->resource->type ||
+        heap->queue_index != alias->queue_index ||
+        !(heap->type_bits & alias->requirements.type_bits))
       {
         continue;
       }
 
-      break;
+      uint64_t heap_offset =
+        ac_rg_alias_find_offset(aliasing, i, alias, h, ranges);
+      bool heap_fits = heap_offset + alias->requirements.size <= heap->size;
+
+      // prefer heap which doesn't have to grow
+      if (heap_index == UINT32_MAX || (heap_fits && !fits))
+      {
+        heap_index = h;
+        offset = heap_offset;
+        fits = heap_fits;
+      }
     }
-    default:
+
+    if (heap_index == UINT32_MAX)
     {
-      AC_ASSERT(false);
-      break;
+      ac_rg_alias_heap heap = {
+        .type = alias->resource->type,
+        .queue_index = alias->queue_index,
+        .type_bits = alias->requirements.type_bits,
+      };
+      array_append(aliasing->heaps, heap);
+
+      heap_index = (uint32_t)array_size(aliasing->heaps) - 1;
+      offset = 0;
     }
+
+    ac_rg_alias_heap* heap = &aliasing->heaps[heap_index];
+    heap->type_bits &= alias->requirements.type_bits;
+    heap->size = AC_MAX(heap->size, offset + alias->requirements.size);
+    heap->alignment = AC_MAX(heap->alignment, alias->requirements.alignment);
+
+    alias->heap = heap_index;
+    alias->offset = offset;
+    alias->resource->is_aliased = true;
+    alias->resource->alias_index = (uint32_t)i;
+  }
+
+  ac_free(ranges);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    ac_rg_alias_resource* alias = &aliasing->resources[i];
+
+    for (size_t j = 0; j < count; ++j)
+    {
+      ac_rg_alias_resource* other = &aliasing->resources[j];
+
+      if (
+        other->last_stage >= alias->first_stage ||
+        !ac_rg_alias_memory_overlap(alias, other))
+      {
+        continue;
+      }
+
+      ac_rg_resource_access access = ac_rg_alias_last_access(other);
+      alias->previous.stages |= access.stages;
+      alias->previous.access |= access.access;
     }
+  }
 
-    *out_resource = resource;
-    resource->release_time = release_time;
+  return ac_result_success;
+}
+
+ac_result
+ac_rg_aliasing_acquire_frame(ac_rg_builder builder)
+{
+  ac_rg_aliasing*    aliasing = &builder->aliasing;
+  ac_rg_alias_frame* frame = &aliasing->frames[builder->cmd.frame_pending];
+
+  if (frame->generation == aliasing->generation)
+  {
     return ac_result_success;
   }
 
-  ac_rg_resource resource = NULL;
-  ac_result res = ac_rg_create_resource(rg, image_info, buffer_info, &resource);
-  if (res != ac_result_success)
+  // frame is acquired, so its previous resources are not in use anymore
+  ac_rg_destroy_alias_frame(frame);
+
+  ac_device device = builder->rg->device;
+
+  for (size_t i = 0; i < array_size(aliasing->heaps); ++i)
   {
-    return res;
+    ac_rg_alias_heap* heap = &aliasing->heaps[i];
+
+    ac_memory_info info = {
+      .size = heap->size,
+      .alignment = heap->alignment,
+      .type_bits = heap->type_bits,
+      .memory_usage = ac_memory_usage_gpu_only,
+      .name = "rg aliasing heap",
+    };
+
+    ac_memory memory = NULL;
+    AC_RIF(ac_create_memory(device, &info, &memory));
+    array_append(frame->memory, memory);
   }
 
-  --resource->reference_count;
+  for (size_t i = 0; i < array_size(aliasing->resources); ++i)
+  {
+    ac_rg_alias_resource* alias = &aliasing->resources[i];
+    ac_rg_graph_resource* resource = alias->resource;
+
+    ac_result res;
+    void*     buffer_or_image = NULL;
+
+    if (resource->type == ac_rg_resource_type_buffer)
+    {
+      ac_buffer_info info = resource->buffer_info;
+      info.memory = frame->memory[alias->heap];
+      info.memory_offset = alias->offset;
+
+      ac_buffer buffer = NULL;
+      res = ac_create_buffer(device, &info, &buffer);
+      buffer_or_image = buffer;
+    }
+    else
+    {
+      ac_image_info info = resource->image_info;
+      info.memory = frame->memory[alias->heap];
+      info.memory_offset = alias->offset;
+
+      ac_image image = NULL;
+      res = ac_create_image(device, &info, &image);
+      buffer_or_image = image;
+    }
+
+    if (res != ac_result_success)
+    {
+      return res;
+    }
+
+    array_append(frame->types, resource->type);
+    array_append(frame->resources, buffer_or_image);
+  }
+
+  frame->generation = aliasing->generation;
 
-  resource->release_time = release_time;
-  *out_resource = resource;
   return ac_result_success;
 }
 
+void
+ac_rg_destroy_aliasing(ac_rg_builder builder)
+{
+  ac_rg_aliasing* aliasing = &builder->aliasing;
+
+  for (uint32_t i = 0; i < AC_MAX_FRAME_IN_FLIGHT; ++i)
+  {
+    ac_rg_alias_frame* frame = &aliasing->frames[i];
+    ac_rg_destroy_alias_frame(frame);
+    array_free(frame->memory);
+    array_free(frame->types);
+    array_free(frame->resources);
+  }
+
+  array_free(aliasing->resources);
+  array_free(aliasing->heaps);
+  AC_ZEROP(aliasing);
+}
+
 ac_result
 ac_rg_storage_get_instance(
   ac_rg_storage*                         storage,
@@ -360,6 +960,13 @@ ac_rg_create_resource(
     return res;
   }
 
+  res = ac_rg_storage_add_resource(&rg->storage, resource);
+  if (res != ac_result_success)
+  {
+    ac_rg_destroy_resource(rg, resource);
+    return res;
+  }
+
   array_append(rg->storage.resources, resource);
   *out_resource = resource;
   return ac_result_success;
@@ -4,6 +4,210 @@
 
 #include "renderer.h"
 
+static ac_result
+ac_create_bindless_table(ac_device device, const ac_bindless_info* info)
+{
+  ac_bindless_table* table = &device->bindless;
+
+  table->space = info->space;
+
+  table->slots[ac_descriptor_type_sampler].count = info->sampler_count;
+  table->slots[ac_descriptor_type_srv_image].count = info->srv_image_count;
+  table->slots[ac_descriptor_type_srv_buffer].count = info->srv_buffer_count;
+  table->slots[ac_descriptor_type_srv_buffer].reg = info->srv_image_count;
+  table->slots[ac_descriptor_type_uav_image].count = info->uav_image_count;
+  table->slots[ac_descriptor_type_uav_buffer].count = info->uav_buffer_count;
+  table->slots[ac_descriptor_type_uav_buffer].reg = info->uav_image_count;
+
+  ac_dsl_info_internal dsl_info = {
+    .info =
+      {
+        .name = "ac bindless",
+      },
+    .bindless = true,
+  };
+
+  dsl_info.bindings =
+    ac_calloc(AC_DESCRIPTOR_TYPE_COUNT * sizeof(ac_shader_binding));
+  if (!dsl_info.bindings)
+  {
+    return ac_result_out_of_host_memory;
+  }
+
+  for (uint32_t type = 0; type < AC_DESCRIPTOR_TYPE_COUNT; ++type)
+  {
+    ac_bindless_slots* slots = &table->slots[type];
+
+    if (!slots->count)
+    {
+      continue;
+    }
+
+    dsl_info.bindings[dsl_info.binding_count++] = (ac_shader_binding) {
+      .space = (ac_shader_space)info->space,
+      .reg = slots->reg,
+      .type = (ac_shader_descriptor_type)type,
+      .descriptor_count = slots->count,
+    };
+  }
+
+  ac_result res = device->create_dsl(device, &dsl_info, &table->dsl);
+  if (res != ac_result_success)
+  {
+    device->destroy_dsl(device, table->dsl);
+    ac_free(table->dsl);
+    ac_free(dsl_info.bindings);
+    table->dsl = NULL;
+    return res;
+  }
+
+  table->dsl->device = device;
+  table->dsl->binding_count = dsl_info.binding_count;
+  table->dsl->bindings = dsl_info.bindings;
+
+  ac_descriptor_buffer_info db_info = {
+    .dsl = table->dsl,
+    .name = "ac bindless",
+  };
+  db_info.max_sets[info->space] = 1;
+
+  AC_RIF(ac_create_descriptor_buffer(device, &db_info, &table->db));
+
+  ac_create_mutex(&table->mtx);
+
+  return ac_result_success;
+}
+
+static void
+ac_destroy_bindless_table(ac_device device)
+{
+  ac_bindless_table* table = &device->bindless;
+
+  ac_destroy_descriptor_buffer(table->db);
+  ac_destroy_dsl(table->dsl);
+  ac_destroy_mutex(table->mtx);
+
+  for (uint32_t type = 0; type < AC_DESCRIPTOR_TYPE_COUNT; ++type)
+  {
+    array_free(table->slots[type].free);
+  }
+}
+
+static uint32_t
+ac_bindless_write(
+  ac_device          device,
+  ac_descriptor_type type,
+  ac_descriptor      descriptor)
+{
+  ac_bindless_table* table = &device->bindless;
+  ac_bindless_slots* slots = &table->slots[type];
+
+  if (!table->db || !slots->count)
+  {
+    return AC_INVALID_BINDLESS_INDEX;
+  }
+
+  ac_mutex_lock(table->mtx);
+
+  uint32_t index = AC_INVALID_BINDLESS_INDEX;
+
+  if (array_size(slots->free))
+  {
+    index = array_back(slots->free);
+    array_remove(slots->free, array_size(slots->free) - 1);
+  }
+  else if (slots->next < slots->count)
+  {
+    index = slots->next++;
+  }
+
+  // table is a single set, so its updates are serialized as well
+  if (index != AC_INVALID_BINDLESS_INDEX)
+  {
+    ac_descriptor_write write = {
+      .count = 1,
+      .reg = slots->reg,
+      .type = type,
+      .descriptors = &descriptor,
+      .index = index,
+    };
+
+    ac_update_set(table->db, table->space, 0, 1, &write);
+  }
+  else
+  {
+    AC_DEBUG("bindless table is full");
+  }
+
+  ac_mutex_unlock(table->mtx);
+
+  return index;
+}
+
+static void
+ac_bindless_release(ac_device device, ac_descriptor_type type, uint32_t index)
+{
+  if (index == AC_INVALID_BINDLESS_INDEX)
+  {
+    return;
+  }
+
+  ac_bindless_table* table = &device->bindless;
+
+  ac_mutex_lock(table->mtx);
+  array_append(table->slots[type].free, index);
+  ac_mutex_unlock(table->mtx);
+}
+
+static ac_result
+ac_create_upload_ring(ac_device device, uint64_t size)
+{
+  ac_upload_ring* ring = &device->upload_ring;
+
+  ring->size = AC_ALIGN_UP(size, 4);
+
+  ac_buffer_info buffer_info = {
+    .size = ring->size,
+    .usage = ac_buffer_usage_cbv_bit | ac_buffer_usage_srv_bit |
+             ac_buffer_usage_vertex_bit | ac_buffer_usage_index_bit |
+             ac_buffer_usage_transfer_src_bit,
+    .memory_usage = ac_memory_usage_cpu_to_gpu,
+    .name = "ac upload ring",
+  };
+
+  for (uint32_t i = 0; i < AC_MAX_FRAME_IN_FLIGHT; ++i)
+  {
+    ac_upload_frame* frame = &ring->frames[i];
+
+    AC_RIF(ac_create_buffer(device, &buffer_info, &frame->buffer));
+    AC_RIF(ac_buffer_map_memory(frame->buffer));
+  }
+
+  ac_create_mutex(&ring->mtx);
+
+  return ac_result_success;
+}
+
+static void
+ac_destroy_upload_ring(ac_device device)
+{
+  ac_upload_ring* ring = &device->upload_ring;
+
+  for (uint32_t i = 0; i < AC_MAX_FRAME_IN_FLIGHT; ++i)
+  {
+    ac_buffer buffer = ring->frames[i].buffer;
+
+    if (buffer && buffer->mapped_memory)
+    {
+      ac_buffer_unmap_memory(buffer);
+    }
+
+    ac_destroy_buffer(buffer);
+  }
+
+  ac_destroy_mutex(ring->mtx);
+}
+
 AC_API ac_result
 ac_create_device(const ac_device_info* info, ac_device* p)
 {
@@ -36,60 +240,585 @@ ac_create_device(const ac_device_info* info, ac_device* p)
   }
 #endif
 
-  if (!create)
-  {
-    AC_DEBUGBREAK();
-    return ac_result_unknown_error;
-  }
+  if (!create)
+  {
+    AC_DEBUGBREAK();
+    return ac_result_unknown_error;
+  }
+
+  ac_result res = create(info, p);
+
+  ac_device device = *p;
+
+  if (res != ac_result_success)
+  {
+    AC_DEBUGBREAK();
+    device->destroy_device(device);
+    ac_free(device);
+    *p = NULL;
+    return ac_result_unknown_error;
+  }
+
+  if (AC_INCLUDE_DEBUG)
+  {
+    device->debug_bits = info->debug_bits;
+  }
+
+  AC_ASSERT(device->props.api);
+  AC_ASSERT(device->props.cbv_buffer_alignment);
+  AC_ASSERT(device->props.image_row_alignment);
+  AC_ASSERT(device->props.image_alignment);
+  AC_ASSERT(device->props.max_sample_count);
+
+  for (uint32_t q = 0; q < device->queue_count; ++q)
+  {
+    ac_queue queue = device->queues[q];
+    queue->device = device;
+    ac_create_mutex(&queue->mtx);
+  }
+
+  const ac_bindless_info* bindless = &info->bindless;
+  if (
+    device->support_bindless &&
+    (bindless->sampler_count || bindless->srv_image_count ||
+     bindless->srv_buffer_count || bindless->uav_image_count ||
+     bindless->uav_buffer_count))
+  {
+    res = ac_create_bindless_table(device, bindless);
+    if (res != ac_result_success)
+    {
+      AC_DEBUGBREAK();
+      ac_destroy_device(device);
+      *p = NULL;
+      return res;
+    }
+  }
+
+  if (info->upload_ring_size)
+  {
+    res = ac_create_upload_ring(device, info->upload_ring_size);
+    if (res != ac_result_success)
+    {
+      AC_DEBUGBREAK();
+      ac_destroy_device(device);
+      *p = NULL;
+      return res;
+    }
+  }
+
+  return res;
+}
+
+AC_API void
+ac_destroy_device(ac_device device)
+{
+  if (!device)
+  {
+    return;
+  }
+
+  ac_destroy_upload_ring(device);
+  ac_destroy_bindless_table(device);
+
+  for (uint32_t i = 0; i < device->queue_count; ++i)
+  {
+    ac_destroy_mutex(device->queues[i]->mtx);
+  }
+  device->destroy_device(device);
+  ac_free(device);
+}
+
+AC_API ac_result
+ac_device_begin_upload_frame(ac_device device)
+{
+  AC_ASSERT(device);
+
+  ac_upload_ring* ring = &device->upload_ring;
+  AC_ASSERT(ring->mtx);
+
+  ac_mutex_lock(ring->mtx);
+
+  ring->frame = (ring->frame + 1) % AC_MAX_FRAME_IN_FLIGHT;
+
+  ac_upload_frame* frame = &ring->frames[ring->frame];
+
+  ac_result res = ac_result_success;
+
+  // usually already passed, frames in flight are throttled by the caller
+  if (frame->fence)
+  {
+    res = ac_wait_fence(frame->fence, frame->value);
+    frame->fence = NULL;
+  }
+
+  frame->offset = 0;
+
+  ac_mutex_unlock(ring->mtx);
+
+  return res;
+}
+
+AC_API ac_result
+ac_device_upload(
+  ac_device             device,
+  uint64_t              size,
+  uint64_t              alignment,
+  ac_upload_allocation* allocation)
+{
+  AC_ASSERT(device);
+  AC_ASSERT(size);
+  AC_ASSERT(allocation);
+
+  ac_upload_ring* ring = &device->upload_ring;
+  AC_ASSERT(ring->mtx);
+
+  if (!alignment)
+  {
+    alignment = device->props.cbv_buffer_alignment;
+  }
+
+  ac_mutex_lock(ring->mtx);
+
+  ac_upload_frame* frame = &ring->frames[ring->frame];
+
+  uint64_t offset = AC_ALIGN_UP(frame->offset, alignment);
+
+  if (offset + size > ring->size)
+  {
+    ac_mutex_unlock(ring->mtx);
+    AC_DEBUG("upload ring is out of space");
+    return ac_result_out_of_device_memory;
+  }
+
+  frame->offset = offset + size;
+
+  ac_mutex_unlock(ring->mtx);
+
+  allocation->buffer = frame->buffer;
+  allocation->offset = offset;
+  allocation->ptr = (uint8_t*)frame->buffer->mapped_memory + offset;
+
+  return ac_result_success;
+}
+
+AC_API void
+ac_device_end_upload_frame(ac_device device, ac_fence fence, uint64_t value)
+{
+  AC_ASSERT(device);
+  AC_ASSERT(fence);
+
+  ac_upload_ring* ring = &device->upload_ring;
+  AC_ASSERT(ring->mtx);
+
+  ac_mutex_lock(ring->mtx);
+  ring->frames[ring->frame].fence = fence;
+  ring->frames[ring->frame].value = value;
+  ac_mutex_unlock(ring->mtx);
+}
+
+static ac_result
+ac_stream_retire(ac_stream stream)
+{
+  for (uint32_t i = 0; i < AC_STREAM_BATCH_COUNT; ++i)
+  {
+    ac_stream_batch* batch =
+      &stream->batches[(stream->batch + i) % AC_STREAM_BATCH_COUNT];
+
+    if (!batch->value)
+    {
+      continue;
+    }
+
+    AC_RIF(ac_wait_fence(stream->fence, batch->value));
+
+    batch->value = 0;
+    stream->tail = AC_MAX(stream->tail, batch->end);
+
+    return ac_result_success;
+  }
+
+  if (!stream->recording)
+  {
+    stream->tail = stream->head;
+  }
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_stream_submit(ac_stream stream)
+{
+  if (!stream->recording)
+  {
+    return ac_result_success;
+  }
+
+  ac_stream_batch* batch = &stream->batches[stream->batch];
+
+  // ownership of everything uploaded in this batch is released at once
+  if (array_size(stream->buffer_barriers) || array_size(stream->image_barriers))
+  {
+    ac_cmd_barrier(
+      batch->cmd,
+      (uint32_t)array_size(stream->buffer_barriers),
+      stream->buffer_barriers,
+      (uint32_t)array_size(stream->image_barriers),
+      stream->image_barriers);
+  }
+
+  array_resize(stream->buffer_barriers, 0);
+  array_resize(stream->image_barriers, 0);
+
+  AC_RIF(ac_end_cmd(batch->cmd));
+
+  ac_fence_submit_info signal = {
+    .fence = stream->fence,
+    .stages = ac_pipeline_stage_transfer_bit,
+    .value = stream->value + 1,
+  };
+
+  ac_queue_submit_info submit_info = {
+    .cmd_count = 1,
+    .cmds = &batch->cmd,
+    .signal_fence_count = 1,
+    .signal_fences = &signal,
+  };
+
+  AC_RIF(ac_queue_submit(stream->queue, &submit_info));
+
+  batch->value = ++stream->value;
+  batch->end = stream->head;
+
+  stream->batch = (stream->batch + 1) % AC_STREAM_BATCH_COUNT;
+  stream->recording = false;
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_stream_begin(ac_stream stream, ac_cmd* cmd)
+{
+  ac_stream_batch* batch = &stream->batches[stream->batch];
+
+  if (!stream->recording)
+  {
+    if (batch->value)
+    {
+      AC_RIF(ac_wait_fence(stream->fence, batch->value));
+      batch->value = 0;
+      stream->tail = AC_MAX(stream->tail, batch->end);
+    }
+
+    AC_RIF(ac_reset_cmd_pool(batch->pool));
+    AC_RIF(ac_begin_cmd(batch->cmd));
+
+    stream->recording = true;
+  }
+
+  *cmd = batch->cmd;
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_stream_alloc(
+  ac_stream   stream,
+  uint64_t    size,
+  const void* data,
+  uint64_t*   offset)
+{
+  if (size > stream->size)
+  {
+    AC_DEBUG("upload does not fit into stream staging memory");
+    return ac_result_invalid_argument;
+  }
+
+  for (;;)
+  {
+    uint64_t head = AC_ALIGN_UP(stream->head, stream->alignment);
+
+    // allocations never wrap around the end of staging buffer
+    uint64_t wrapped = head % stream->size;
+    if (wrapped + size > stream->size)
+    {
+      head += stream->size - wrapped;
+    }
+
+    if (head + size - stream->tail <= stream->size)
+    {
+      stream->head = head + size;
+      *offset = head % stream->size;
+      break;
+    }
+
+    // staging is full, push recorded copies and wait for the oldest batch
+    AC_RIF(ac_stream_submit(stream));
+    AC_RIF(ac_stream_retire(stream));
+  }
+
+  memcpy((uint8_t*)stream->staging->mapped_memory + *offset, data, size);
+
+  return ac_result_success;
+}
+
+AC_API ac_result
+ac_create_stream(ac_device device, const ac_stream_info* info, ac_stream* p)
+{
+  AC_ASSERT(device);
+  AC_ASSERT(info);
+  AC_ASSERT(info->staging_size);
+  AC_ASSERT(p);
+
+  ac_stream stream = ac_calloc(sizeof *stream);
+  *p = stream;
+
+  stream->device = device;
+  stream->queue = ac_device_get_queue(device, ac_queue_type_transfer);
+  stream->dst_queue = info->dst_queue;
+
+  if (!stream->dst_queue)
+  {
+    stream->dst_queue = ac_device_get_queue(device, ac_queue_type_graphics);
+  }
+
+  stream->alignment = AC_MAX(device->props.image_alignment, 16);
+  stream->size = AC_ALIGN_UP(info->staging_size, stream->alignment);
+
+  ac_create_mutex(&stream->mtx);
+
+  ac_buffer_info buffer_info = {
+    .size = stream->size,
+    .usage = ac_buffer_usage_transfer_src_bit,
+    .memory_usage = ac_memory_usage_cpu_to_gpu,
+    .name = info->name,
+  };
+
+  ac_result res = ac_create_buffer(device, &buffer_info, &stream->staging);
+
+  if (res == ac_result_success)
+  {
+    res = ac_buffer_map_memory(stream->staging);
+  }
+
+  if (res == ac_result_success)
+  {
+    ac_fence_info fence_info = {0};
+    res = ac_create_fence(device, &fence_info, &stream->fence);
+  }
+
+  ac_cmd_pool_info pool_info = {
+    .queue = stream->queue,
+  };
+
+  for (uint32_t i = 0; i < AC_STREAM_BATCH_COUNT; ++i)
+  {
+    ac_stream_batch* batch = &stream->batches[i];
+
+    if (res == ac_result_success)
+    {
+      res = ac_create_cmd_pool(device, &pool_info, &batch->pool);
+    }
+
+    if (res == ac_result_success)
+    {
+      res = ac_create_cmd(batch->pool, &batch->cmd);
+    }
+  }
+
+  if (res != ac_result_success)
+  {
+    AC_DEBUGBREAK();
+    ac_destroy_stream(stream);
+    *p = NULL;
+    return res;
+  }
+
+  return ac_result_success;
+}
+
+AC_API void
+ac_destroy_stream(ac_stream stream)
+{
+  if (!stream)
+  {
+    return;
+  }
+
+  if (stream->fence)
+  {
+    ac_stream_submit(stream);
+    ac_wait_fence(stream->fence, stream->value);
+  }
+
+  for (uint32_t i = 0; i < AC_STREAM_BATCH_COUNT; ++i)
+  {
+    ac_destroy_cmd(stream->batches[i].cmd);
+    ac_destroy_cmd_pool(stream->batches[i].pool);
+  }
+
+  if (stream->staging && stream->staging->mapped_memory)
+  {
+    ac_buffer_unmap_memory(stream->staging);
+  }
+
+  ac_destroy_buffer(stream->staging);
+  ac_destroy_fence(stream->fence);
+  ac_destroy_mutex(stream->mtx);
+
+  array_free(stream->buffer_barriers);
+  array_free(stream->image_barriers);
+
+  ac_free(stream);
+}
+
+AC_API ac_result
+ac_stream_buffer(
+  ac_stream   stream,
+  ac_buffer   dst,
+  uint64_t    offset,
+  const void* data,
+  uint64_t    size)
+{
+  AC_ASSERT(stream);
+  AC_ASSERT(dst);
+  AC_ASSERT(data);
+  AC_ASSERT(offset + size <= dst->size);
+
+  ac_mutex_lock(stream->mtx);
+
+  ac_result res = ac_result_success;
+
+  // large buffers are split so they can stream through smaller staging
+  for (uint64_t done = 0; done < size && res == ac_result_success;)
+  {
+    uint64_t chunk = AC_MIN(size - done, stream->size);
+    uint64_t staging_offset;
+    ac_cmd   cmd;
+
+    res = ac_stream_alloc(
+      stream,
+      chunk,
+      (const uint8_t*)data + done,
+      &staging_offset);
+
+    if (res == ac_result_success)
+    {
+      res = ac_stream_begin(stream, &cmd);
+    }
+
+    if (res == ac_result_success)
+    {
+      ac_cmd_copy_buffer(
+        cmd,
+        stream->staging,
+        staging_offset,
+        dst,
+        offset + done,
+        chunk);
+
+      done += chunk;
+    }
+  }
+
+  if (res == ac_result_success)
+  {
+    ac_buffer_barrier barrier = {
+      .buffer = dst,
+      .src_stage = ac_pipeline_stage_transfer_bit,
+      .src_access = ac_access_transfer_write_bit,
+      .src_queue = stream->queue,
+      .dst_queue = stream->dst_queue,
+      .offset = offset,
+      .size = size,
+    };
+    array_append(stream->buffer_barriers, barrier);
+  }
+
+  ac_mutex_unlock(stream->mtx);
+
+  return res;
+}
+
+AC_API ac_result
+ac_stream_image(
+  ac_stream                   stream,
+  ac_image                    dst,
+  const ac_buffer_image_copy* copy,
+  ac_image_layout             layout,
+  const void*                 data,
+  uint64_t                    size)
+{
+  AC_ASSERT(stream);
+  AC_ASSERT(dst);
+  AC_ASSERT(copy);
+  AC_ASSERT(data);
+
+  ac_mutex_lock(stream->mtx);
 
-  ac_result res = create(info, p);
+  ac_buffer_image_copy region = *copy;
+  ac_cmd               cmd;
 
-  ac_device device = *p;
+  ac_result res = ac_stream_alloc(stream, size, data, &region.buffer_offset);
 
-  if (res != ac_result_success)
+  if (res == ac_result_success)
   {
-    AC_DEBUGBREAK();
-    device->destroy_device(device);
-    ac_free(device);
-    *p = NULL;
-    return ac_result_unknown_error;
+    res = ac_stream_begin(stream, &cmd);
   }
 
-  if (AC_INCLUDE_DEBUG)
+  if (res == ac_result_success)
   {
-    device->debug_bits = info->debug_bits;
-  }
+    ac_image_barrier barrier = {
+      .image = dst,
+      .dst_stage = ac_pipeline_stage_transfer_bit,
+      .dst_access = ac_access_transfer_write_bit,
+      .old_layout = ac_image_layout_undefined,
+      .new_layout = ac_image_layout_transfer_dst,
+      .range =
+        {
+          .base_level = (uint16_t)copy->level,
+          .levels = 1,
+          .base_layer = (uint16_t)copy->layer,
+          .layers = 1,
+        },
+    };
 
-  AC_ASSERT(device->props.api);
-  AC_ASSERT(device->props.cbv_buffer_alignment);
-  AC_ASSERT(device->props.image_row_alignment);
-  AC_ASSERT(device->props.image_alignment);
-  AC_ASSERT(device->props.max_sample_count);
+    ac_cmd_barrier(cmd, 0, NULL, 1, &barrier);
+    ac_cmd_copy_buffer_to_image(cmd, stream->staging, dst, &region);
 
-  for (uint32_t q = 0; q < device->queue_count; ++q)
-  {
-    ac_queue queue = device->queues[q];
-    queue->device = device;
-    ac_create_mutex(&queue->mtx);
+    barrier.src_stage = ac_pipeline_stage_transfer_bit;
+    barrier.src_access = ac_access_transfer_write_bit;
+    barrier.dst_stage = ac_pipeline_stage_none;
+    barrier.dst_access = ac_access_none;
+    barrier.old_layout = ac_image_layout_transfer_dst;
+    barrier.new_layout = layout;
+    barrier.src_queue = stream->queue;
+    barrier.dst_queue = stream->dst_queue;
+    array_append(stream->image_barriers, barrier);
   }
 
+  ac_mutex_unlock(stream->mtx);
+
   return res;
 }
 
-AC_API void
-ac_destroy_device(ac_device device)
+AC_API ac_result
+ac_stream_flush(ac_stream stream, ac_stream_ticket* ticket)
 {
-  if (!device)
-  {
-    return;
-  }
+  AC_ASSERT(stream);
 
-  for (uint32_t i = 0; i < device->queue_count; ++i)
+  ac_mutex_lock(stream->mtx);
+
+  ac_result res = ac_stream_submit(stream);
+
+  if (ticket)
   {
-    ac_destroy_mutex(device->queues[i]->mtx);
+    ticket->fence = stream->fence;
+    ticket->value = stream->value;
   }
-  device->destroy_device(device);
-  ac_free(device);
+
+  ac_mutex_unlock(stream->mtx);
+
+  return res;
 }
 
 AC_API ac_result
@@ -228,6 +957,55 @@ ac_wait_fence(ac_fence fence, uint64_t value)
   return device->wait_fence(device, fence, value);
 }
 
+AC_API ac_result
+ac_create_event(ac_device device, ac_event* p)
+{
+  AC_ASSERT(device);
+  AC_ASSERT(p);
+
+  if (!device->create_event)
+  {
+    *p = ac_calloc(sizeof **p);
+    if (!*p)
+    {
+      return ac_result_out_of_host_memory;
+    }
+    (*p)->device = device;
+    return ac_result_success;
+  }
+
+  ac_result res = device->create_event(device, p);
+
+  if (res != ac_result_success)
+  {
+    AC_DEBUGBREAK();
+    device->destroy_event(device, *p);
+    ac_free(*p);
+    *p = NULL;
+    return res;
+  }
+
+  (*p)->device = device;
+
+  return res;
+}
+
+AC_API void
+ac_destroy_event(ac_event event)
+{
+  if (!event)
+  {
+    return;
+  }
+
+  ac_device device = event->device;
+  if (device->destroy_event)
+  {
+    device->destroy_event(device, event);
+  }
+  ac_free(event);
+}
+
 AC_API ac_result
 ac_create_swapchain(
   ac_device                device,
@@ -698,6 +1476,69 @@ ac_cmd_barrier(
     image_barriers);
 }
 
+AC_API void
+ac_cmd_set_event(
+  ac_cmd                   cmd,
+  ac_event                 event,
+  uint32_t                 buffer_barrier_count,
+  const ac_buffer_barrier* buffer_barriers,
+  uint32_t                 image_barrier_count,
+  const ac_image_barrier*  image_barriers)
+{
+  AC_ASSERT(cmd);
+  AC_ASSERT(event);
+  AC_ASSERT(buffer_barrier_count || image_barrier_count);
+
+  ac_device device = cmd->device;
+
+  if (!device->cmd_set_event)
+  {
+    return;
+  }
+
+  device->cmd_set_event(
+    cmd,
+    event,
+    buffer_barrier_count,
+    buffer_barriers,
+    image_barrier_count,
+    image_barriers);
+}
+
+AC_API void
+ac_cmd_wait_event(
+  ac_cmd                   cmd,
+  ac_event                 event,
+  uint32_t                 buffer_barrier_count,
+  const ac_buffer_barrier* buffer_barriers,
+  uint32_t                 image_barrier_count,
+  const ac_image_barrier*  image_barriers)
+{
+  AC_ASSERT(cmd);
+  AC_ASSERT(event);
+
+  ac_device device = cmd->device;
+
+  if (!device->cmd_wait_event)
+  {
+    ac_cmd_barrier(
+      cmd,
+      buffer_barrier_count,
+      buffer_barriers,
+      image_barrier_count,
+      image_barriers);
+    return;
+  }
+
+  device->cmd_wait_event(
+    cmd,
+    event,
+    buffer_barrier_count,
+    buffer_barriers,
+    image_barrier_count,
+    image_barriers);
+}
+
 AC_API void
 ac_cmd_set_scissor(
   ac_cmd   cmd,
@@ -969,6 +1810,17 @@ ac_cmd_bind_set(
   cmd->sets[space] = set;
 }
 
+AC_API void
+ac_cmd_bind_bindless(ac_cmd cmd)
+{
+  AC_ASSERT(cmd);
+
+  ac_bindless_table* table = &cmd->device->bindless;
+  AC_ASSERT(table->db);
+
+  ac_cmd_bind_set(cmd, table->db, table->space, 0);
+}
+
 AC_API void
 ac_cmd_dispatch(
   ac_cmd   cmd,
@@ -1048,6 +1900,13 @@ ac_create_buffer(ac_device device, const ac_buffer_info* info, ac_buffer* p)
     {
       AC_ASSERT((info->size % 4) == 0);
     }
+
+    if (info->memory)
+    {
+      AC_ASSERT(info->memory->device == device);
+      AC_ASSERT(info->memory->memory_usage == info->memory_usage);
+      AC_ASSERT(info->memory_offset + info->size <= info->memory->size);
+    }
   }
 
   ac_result res = device->create_buffer(device, info, p);
@@ -1065,6 +1924,25 @@ ac_create_buffer(ac_device device, const ac_buffer_info* info, ac_buffer* p)
   (*p)->size = info->size;
   (*p)->usage = info->usage;
   (*p)->memory_usage = info->memory_usage;
+  (*p)->bindless_srv = AC_INVALID_BINDLESS_INDEX;
+  (*p)->bindless_uav = AC_INVALID_BINDLESS_INDEX;
+
+  ac_descriptor descriptor = {
+    .buffer = *p,
+    .range = AC_WHOLE_SIZE,
+  };
+
+  if (info->usage & ac_buffer_usage_srv_bit)
+  {
+    (*p)->bindless_srv =
+      ac_bindless_write(device, ac_descriptor_type_srv_buffer, descriptor);
+  }
+
+  if (info->usage & ac_buffer_usage_uav_bit)
+  {
+    (*p)->bindless_uav =
+      ac_bindless_write(device, ac_descriptor_type_uav_buffer, descriptor);
+  }
 
   return res;
 }
@@ -1078,6 +1956,14 @@ ac_destroy_buffer(ac_buffer buffer)
   }
 
   ac_device device = buffer->device;
+  ac_bindless_release(
+    device,
+    ac_descriptor_type_srv_buffer,
+    buffer->bindless_srv);
+  ac_bindless_release(
+    device,
+    ac_descriptor_type_uav_buffer,
+    buffer->bindless_uav);
   device->destroy_buffer(device, buffer);
   ac_free(buffer);
 }
@@ -1211,9 +2097,14 @@ ac_create_sampler(ac_device device, const ac_sampler_info* info, ac_sampler* p)
     device->destroy_sampler(device, *p);
     ac_free(*p);
     *p = NULL;
+    return res;
   }
 
   (*p)->device = device;
+  (*p)->bindless_index = ac_bindless_write(
+    device,
+    ac_descriptor_type_sampler,
+    (ac_descriptor) {.sampler = *p});
 
   return res;
 }
@@ -1227,6 +2118,10 @@ ac_destroy_sampler(ac_sampler sampler)
   }
 
   ac_device device = sampler->device;
+  ac_bindless_release(
+    device,
+    ac_descriptor_type_sampler,
+    sampler->bindless_index);
   device->destroy_sampler(device, sampler);
   ac_free(sampler);
 }
@@ -1245,6 +2140,7 @@ ac_create_image(ac_device device, const ac_image_info* info, ac_image* p)
   AC_ASSERT(
     ((info->usage & ac_image_usage_attachment_bit) == 0) ||
     (info->levels == 1));
+  AC_ASSERT(!info->memory || info->memory->device == device);
 
   ac_result res = device->create_image(device, info, p);
 
@@ -1266,6 +2162,24 @@ ac_create_image(ac_device device, const ac_image_info* info, ac_image* p)
   (*p)->layers = info->layers;
   (*p)->usage = info->usage;
   (*p)->type = info->type;
+  (*p)->bindless_srv = AC_INVALID_BINDLESS_INDEX;
+  (*p)->bindless_uav = AC_INVALID_BINDLESS_INDEX;
+
+  ac_descriptor descriptor = {
+    .image = *p,
+  };
+
+  if (info->usage & ac_image_usage_srv_bit)
+  {
+    (*p)->bindless_srv =
+      ac_bindless_write(device, ac_descriptor_type_srv_image, descriptor);
+  }
+
+  if (info->usage & ac_image_usage_uav_bit)
+  {
+    (*p)->bindless_uav =
+      ac_bindless_write(device, ac_descriptor_type_uav_image, descriptor);
+  }
 
   return res;
 }
@@ -1279,10 +2193,109 @@ ac_destroy_image(ac_image image)
   }
 
   ac_device device = image->device;
+  ac_bindless_release(
+    device,
+    ac_descriptor_type_srv_image,
+    image->bindless_srv);
+  ac_bindless_release(
+    device,
+    ac_descriptor_type_uav_image,
+    image->bindless_uav);
   device->destroy_image(device, image);
   ac_free(image);
 }
 
+AC_API ac_result
+ac_create_memory(ac_device device, const ac_memory_info* info, ac_memory* p)
+{
+  AC_ASSERT(device);
+  AC_ASSERT(info);
+  AC_ASSERT(info->size);
+  AC_ASSERT(info->type_bits);
+  AC_ASSERT(p);
+
+  *p = NULL;
+
+  if (!device->support_placed_resources)
+  {
+    AC_ASSERT(false);
+    return ac_result_bad_usage;
+  }
+
+  ac_result res = device->create_memory(device, info, p);
+
+  if (res != ac_result_success)
+  {
+    AC_DEBUGBREAK();
+    device->destroy_memory(device, *p);
+    ac_free(*p);
+    *p = NULL;
+    return res;
+  }
+
+  (*p)->device = device;
+  (*p)->size = info->size;
+  (*p)->type_bits = info->type_bits;
+  (*p)->memory_usage = info->memory_usage;
+
+  return res;
+}
+
+AC_API void
+ac_destroy_memory(ac_memory memory)
+{
+  if (!memory)
+  {
+    return;
+  }
+
+  ac_device device = memory->device;
+  device->destroy_memory(device, memory);
+  ac_free(memory);
+}
+
+AC_API ac_result
+ac_get_image_memory_requirements(
+  ac_device               device,
+  const ac_image_info*    info,
+  ac_memory_requirements* requirements)
+{
+  AC_ASSERT(device);
+  AC_ASSERT(info);
+  AC_ASSERT(requirements);
+
+  AC_ZEROP(requirements);
+
+  if (!device->support_placed_resources)
+  {
+    AC_ASSERT(false);
+    return ac_result_bad_usage;
+  }
+
+  return device->get_image_memory_requirements(device, info, requirements);
+}
+
+AC_API ac_result
+ac_get_buffer_memory_requirements(
+  ac_device               device,
+  const ac_buffer_info*   info,
+  ac_memory_requirements* requirements)
+{
+  AC_ASSERT(device);
+  AC_ASSERT(info);
+  AC_ASSERT(requirements);
+
+  AC_ZEROP(requirements);
+
+  if (!device->support_placed_resources)
+  {
+    AC_ASSERT(false);
+    return ac_result_bad_usage;
+  }
+
+  return device->get_buffer_memory_requirements(device, info, requirements);
+}
+
 AC_API void
 ac_update_set(
   ac_descriptor_buffer       db,
@@ -1373,9 +2386,9 @@ ac_update_set(
         }
       }
     }
-
-    device->update_descriptor(device, db, space, set, w);
   }
+
+  device->update_set(device, db, space, set, count, writes);
 }
 
 AC_API ac_result
@@ -1550,6 +2563,20 @@ ac_device_support_mesh_shaders(ac_device device)
   return device->support_mesh_shaders;
 }
 
+AC_API bool
+ac_device_support_placed_resources(ac_device device)
+{
+  AC_ASSERT(device);
+  return device->support_placed_resources;
+}
+
+AC_API bool
+ac_device_support_bindless(ac_device device)
+{
+  AC_ASSERT(device);
+  return device->support_bindless;
+}
+
 AC_API ac_device_properties
 ac_device_get_properties(ac_device device)
 {
@@ -1614,6 +2641,20 @@ ac_image_get_usage(ac_image image)
   return image->usage;
 }
 
+AC_API uint32_t
+ac_image_get_srv_index(ac_image image)
+{
+  AC_ASSERT(image);
+  return image->bindless_srv;
+}
+
+AC_API uint32_t
+ac_image_get_uav_index(ac_image image)
+{
+  AC_ASSERT(image);
+  return image->bindless_uav;
+}
+
 AC_API ac_image_type
 ac_image_get_type(ac_image image)
 {
@@ -1677,6 +2718,27 @@ ac_buffer_get_info(ac_buffer buffer)
   };
 }
 
+AC_API uint32_t
+ac_buffer_get_srv_index(ac_buffer buffer)
+{
+  AC_ASSERT(buffer);
+  return buffer->bindless_srv;
+}
+
+AC_API uint32_t
+ac_buffer_get_uav_index(ac_buffer buffer)
+{
+  AC_ASSERT(buffer);
+  return buffer->bindless_uav;
+}
+
+AC_API uint32_t
+ac_sampler_get_index(ac_sampler sampler)
+{
+  AC_ASSERT(sampler);
+  return sampler->bindless_index;
+}
+
 AC_API ac_result
 ac_shader_get_workgroup(ac_shader shader, uint8_t _wg[3])
 {
@@ -11,6 +11,8 @@ extern "C"
 {
 #endif
 
+#define AC_DESCRIPTOR_TYPE_COUNT (ac_descriptor_type_as + 1)
+
 typedef struct ac_queue_internal {
   ac_device     device;
   ac_queue_type type;
@@ -34,8 +36,13 @@ typedef struct ac_fence_internal {
   ac_fence_bits bits;
 } ac_fence_internal;
 
+typedef struct ac_event_internal {
+  ac_device device;
+} ac_event_internal;
+
 typedef struct ac_sampler_internal {
   ac_device device;
+  uint32_t  bindless_index;
 } ac_sampler_internal;
 
 typedef struct ac_image_internal {
@@ -48,6 +55,8 @@ typedef struct ac_image_internal {
   uint16_t            layers;
   ac_image_usage_bits usage;
   ac_image_type       type;
+  uint32_t            bindless_srv;
+  uint32_t            bindless_uav;
 } ac_image_internal;
 
 typedef struct ac_buffer_internal {
@@ -56,8 +65,17 @@ typedef struct ac_buffer_internal {
   ac_buffer_usage_bits usage;
   ac_memory_usage      memory_usage;
   void*                mapped_memory;
+  uint32_t             bindless_srv;
+  uint32_t             bindless_uav;
 } ac_buffer_internal;
 
+typedef struct ac_memory_internal {
+  ac_device       device;
+  uint64_t        size;
+  uint32_t        type_bits;
+  ac_memory_usage memory_usage;
+} ac_memory_internal;
+
 typedef struct ac_swapchain_internal {
   ac_device      device;
   uint32_t       image_count;
@@ -103,16 +121,83 @@ typedef struct ac_dsl_info_internal {
   ac_dsl_info        info;
   uint32_t           binding_count;
   ac_shader_binding* bindings;
+  // layout of bindless table, arrays may be partially written
+  bool               bindless;
 } ac_dsl_info_internal;
 
+typedef struct ac_bindless_slots {
+  uint32_t reg;
+  uint32_t count;
+  // indices below next were handed out at least once
+  uint32_t next;
+  array_t(uint32_t) free;
+} ac_bindless_slots;
+
+typedef struct ac_bindless_table {
+  ac_mutex             mtx;
+  ac_space             space;
+  ac_dsl               dsl;
+  ac_descriptor_buffer db;
+  ac_bindless_slots    slots[AC_DESCRIPTOR_TYPE_COUNT];
+} ac_bindless_table;
+
+typedef struct ac_upload_frame {
+  ac_buffer buffer;
+  uint64_t  offset;
+  // region is reused once fence reaches value
+  ac_fence  fence;
+  uint64_t  value;
+} ac_upload_frame;
+
+typedef struct ac_upload_ring {
+  ac_mutex        mtx;
+  uint64_t        size;
+  uint32_t        frame;
+  ac_upload_frame frames[AC_MAX_FRAME_IN_FLIGHT];
+} ac_upload_ring;
+
+#define AC_STREAM_BATCH_COUNT 4
+
+typedef struct ac_stream_batch {
+  ac_cmd_pool pool;
+  ac_cmd      cmd;
+  // staging memory before end is owned until fence reaches value
+  uint64_t    end;
+  uint64_t    value;
+} ac_stream_batch;
+
+typedef struct ac_stream_internal {
+  ac_device       device;
+  ac_queue        queue;
+  ac_queue        dst_queue;
+  ac_mutex        mtx;
+  ac_buffer       staging;
+  uint64_t        size;
+  uint64_t        alignment;
+  // monotonic staging offsets, wrapped modulo size
+  uint64_t        head;
+  uint64_t        tail;
+  ac_fence        fence;
+  uint64_t        value;
+  uint32_t        batch;
+  bool            recording;
+  ac_stream_batch batches[AC_STREAM_BATCH_COUNT];
+  array_t(ac_buffer_barrier) buffer_barriers;
+  array_t(ac_image_barrier) image_barriers;
+} ac_stream_internal;
+
 typedef struct ac_device_internal {
   ac_device_debug_bits debug_bits;
   ac_device_properties props;
   bool                 support_raytracing;
   bool                 support_mesh_shaders;
+  bool                 support_placed_resources;
+  bool                 support_bindless;
   uint32_t             queue_map[ac_queue_type_count];
   uint32_t             queue_count;
   ac_queue             queues[ac_queue_type_count];
+  ac_bindless_table    bindless;
+  ac_upload_ring       upload_ring;
 
   void (*destroy_device)(ac_device);
 
@@ -132,6 +217,11 @@ typedef struct ac_device_internal {
 
   ac_result (*wait_fence)(ac_device, ac_fence, uint64_t);
 
+  // events are optional, split barriers fall back to cmd_barrier on wait
+  ac_result (*create_event)(ac_device, ac_event*);
+
+  void (*destroy_event)(ac_device, ac_event);
+
   ac_result (
     *create_swapchain)(ac_device, const ac_swapchain_info*, ac_swapchain*);
 
@@ -203,11 +293,26 @@ typedef struct ac_device_internal {
 
   void (*destroy_image)(ac_device, ac_image);
 
-  void (*update_descriptor)(
+  ac_result (*create_memory)(ac_device, const ac_memory_info*, ac_memory*);
+
+  void (*destroy_memory)(ac_device, ac_memory);
+
+  ac_result (*get_image_memory_requirements)(
+    ac_device,
+    const ac_image_info*,
+    ac_memory_requirements*);
+
+  ac_result (*get_buffer_memory_requirements)(
+    ac_device,
+    const ac_buffer_info*,
+    ac_memory_requirements*);
+
+  void (*update_set)(
     ac_device,
     ac_descriptor_buffer,
     ac_space,
     uint32_t,
+    uint32_t,
     const ac_descriptor_write*);
 
   ac_result (*create_sbt)(ac_device, const ac_sbt_info*, ac_sbt*);
@@ -232,6 +337,22 @@ typedef struct ac_device_internal {
     uint32_t,
     const ac_image_barrier*);
 
+  void (*cmd_set_event)(
+    ac_cmd,
+    ac_event,
+    uint32_t,
+    const ac_buffer_barrier*,
+    uint32_t,
+    const ac_image_barrier*);
+
+  void (*cmd_wait_event)(
+    ac_cmd,
+    ac_event,
+    uint32_t,
+    const ac_buffer_barrier*,
+    uint32_t,
+    const ac_image_barrier*);
+
   void (*cmd_set_scissor)(ac_cmd, uint32_t, uint32_t, uint32_t, uint32_t);
 
   void (*cmd_set_viewport)(ac_cmd, float, float, float, float, float, float);
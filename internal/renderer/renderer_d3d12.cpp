@@ -63,13 +63,8 @@ ac_d3d12_get_binding_handle(
   return out->handle;
 }
 
-static inline ac_result
-ac_d3d12_create_buffer2(
-  ac_d3d12_device*      device,
-  const ac_buffer_info* info,
-  D3D12_RESOURCE_STATES state,
-  ID3D12Resource**      buffer,
-  D3D12MA::Allocation** allocation)
+static inline D3D12_RESOURCE_DESC1
+ac_d3d12_buffer_desc(ac_d3d12_device* device, const ac_buffer_info* info)
 {
   D3D12_RESOURCE_DESC1 resource_desc = {};
   resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
@@ -84,9 +79,6 @@ ac_d3d12_create_buffer2(
   resource_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
   resource_desc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-  D3D12MA::ALLOCATION_DESC alloc_desc = {};
-  alloc_desc.HeapType = ac_memory_usage_to_d3d12(info->memory_usage);
-
   if (info->usage & ac_buffer_usage_cbv_bit)
   {
     resource_desc.Width = AC_ALIGN_UP(
@@ -94,45 +86,135 @@ ac_d3d12_create_buffer2(
       device->common.props.cbv_buffer_alignment);
   }
 
+  return resource_desc;
+}
+
+static inline D3D12_RESOURCE_DESC
+ac_d3d12_resource_desc_from_desc1(const D3D12_RESOURCE_DESC1* resource_desc)
+{
+  D3D12_RESOURCE_DESC resource_desc2 = {};
+  resource_desc2.Dimension = resource_desc->Dimension;
+  resource_desc2.Alignment = resource_desc->Alignment;
+  resource_desc2.Width = resource_desc->Width;
+  resource_desc2.Height = resource_desc->Height;
+  resource_desc2.DepthOrArraySize = resource_desc->DepthOrArraySize;
+  resource_desc2.MipLevels = resource_desc->MipLevels;
+  resource_desc2.Format = resource_desc->Format;
+  resource_desc2.SampleDesc = resource_desc->SampleDesc;
+  resource_desc2.Layout = resource_desc->Layout;
+  resource_desc2.Flags = resource_desc->Flags;
+  return resource_desc2;
+}
+
+// on heap tier 1 buffers, render targets and other textures can't share heap
+static inline uint32_t
+ac_d3d12_memory_type_bits(
+  ac_d3d12_device*            device,
+  const D3D12_RESOURCE_DESC1* resource_desc)
+{
+  static const uint32_t all = AC_BIT(0) | AC_BIT(1) | AC_BIT(2);
+
+  if (device->heap_tier_2)
+  {
+    return all;
+  }
+
+  if (resource_desc->Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+  {
+    return AC_BIT(0);
+  }
+
+  if (
+    resource_desc->Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET |
+                            D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+  {
+    return AC_BIT(1);
+  }
+
+  return AC_BIT(2);
+}
+
+static inline ac_result
+ac_d3d12_create_buffer2(
+  ac_d3d12_device*      device,
+  const ac_buffer_info* info,
+  D3D12_RESOURCE_STATES state,
+  ID3D12Resource**      buffer,
+  D3D12MA::Allocation** allocation)
+{
+  D3D12_RESOURCE_DESC1 resource_desc = ac_d3d12_buffer_desc(device, info);
+
+  D3D12MA::ALLOCATION_DESC alloc_desc = {};
+  alloc_desc.HeapType = ac_memory_usage_to_d3d12(info->memory_usage);
+
+  D3D12MA::Allocation* memory_allocation = NULL;
+  if (info->memory)
+  {
+    AC_FROM_HANDLE2(memory, info->memory, ac_d3d12_memory);
+    memory_allocation = memory->allocation;
+  }
+
 #if (AC_D3D12_USE_ENHANCED_BARRIERS)
   if (device->enhanced_barriers)
   {
-    AC_D3D12_RIF(device->allocator->CreateResource3(
-      &alloc_desc,
-      &resource_desc,
-      D3D12_BARRIER_LAYOUT_UNDEFINED,
-      NULL,
-      0,
-      NULL,
-      allocation,
-      AC_IID_PPV_ARGS(buffer)));
+    if (memory_allocation)
+    {
+      AC_D3D12_RIF(device->allocator->CreateAliasingResource2(
+        memory_allocation,
+        info->memory_offset,
+        &resource_desc,
+        D3D12_BARRIER_LAYOUT_UNDEFINED,
+        NULL,
+        0,
+        NULL,
+        AC_IID_PPV_ARGS(buffer)));
+    }
+    else
+    {
+      AC_D3D12_RIF(device->allocator->CreateResource3(
+        &alloc_desc,
+        &resource_desc,
+        D3D12_BARRIER_LAYOUT_UNDEFINED,
+        NULL,
+        0,
+        NULL,
+        allocation,
+        AC_IID_PPV_ARGS(buffer)));
+    }
   }
   else
 #endif
   {
-    D3D12_RESOURCE_DESC resource_desc2 = {};
-    resource_desc2.Dimension = resource_desc.Dimension;
-    resource_desc2.Alignment = resource_desc.Alignment;
-    resource_desc2.Width = resource_desc.Width;
-    resource_desc2.Height = resource_desc.Height;
-    resource_desc2.DepthOrArraySize = resource_desc.DepthOrArraySize;
-    resource_desc2.MipLevels = resource_desc.MipLevels;
-    resource_desc2.Format = resource_desc.Format;
-    resource_desc2.SampleDesc = resource_desc.SampleDesc;
-    resource_desc2.Layout = resource_desc.Layout;
-    resource_desc2.Flags = resource_desc.Flags;
-
-    AC_D3D12_RIF(device->allocator->CreateResource(
-      &alloc_desc,
-      &resource_desc2,
-      state,
-      NULL,
-      allocation,
-      AC_IID_PPV_ARGS(buffer)));
+    D3D12_RESOURCE_DESC resource_desc2 =
+      ac_d3d12_resource_desc_from_desc1(&resource_desc);
+
+    if (memory_allocation)
+    {
+      AC_D3D12_RIF(device->allocator->CreateAliasingResource(
+        memory_allocation,
+        info->memory_offset,
+        &resource_desc2,
+        state,
+        NULL,
+        AC_IID_PPV_ARGS(buffer)));
+    }
+    else
+    {
+      AC_D3D12_RIF(device->allocator->CreateResource(
+        &alloc_desc,
+        &resource_desc2,
+        state,
+        NULL,
+        allocation,
+        AC_IID_PPV_ARGS(buffer)));
+    }
   }
 
   AC_D3D12_SET_OBJECT_NAME((*buffer), info->name);
-  AC_D3D12_SET_OBJECT_NAME((*allocation), info->name);
+  if (*allocation)
+  {
+    AC_D3D12_SET_OBJECT_NAME((*allocation), info->name);
+  }
 
   return ac_result_success;
 }
@@ -433,7 +515,10 @@ ac_d3d12_create_dsl(
   bool sampler_ranges[ac_space_count] = {};
   bool resource_ranges[ac_space_count] = {};
 
-  dsl->handles = hashmap_new(
+  dsl->handles = hashmap_new_with_allocator(
+    ac_hashmap_alloc,
+    ac_hashmap_realloc,
+    ac_free,
     sizeof(ac_d3d12_binding_handle),
     0,
     0,
@@ -575,7 +660,10 @@ ac_d3d12_create_descriptor_buffer(
     AC_D3D12_SET_OBJECT_NAME(db->resource_heap, info->name);
   }
 
-  db->handles = hashmap_new(
+  db->handles = hashmap_new_with_allocator(
+    ac_hashmap_alloc,
+    ac_hashmap_realloc,
+    ac_free,
     sizeof(ac_d3d12_binding_handle),
     0,
     0,
@@ -1013,15 +1101,9 @@ ac_d3d12_destroy_pipeline(ac_device device_handle, ac_pipeline pipeline_handle)
   AC_D3D12_SAFE_RELEASE(pipeline->pipeline);
 }
 
-static ac_result
-ac_d3d12_create_image(
-  ac_device            device_handle,
-  const ac_image_info* info,
-  ac_image*            image_handle)
+static inline D3D12_RESOURCE_DESC1
+ac_d3d12_image_desc(const ac_image_info* info)
 {
-  AC_INIT_INTERNAL(image, ac_d3d12_image);
-  AC_FROM_HANDLE(device, ac_d3d12_device);
-
   D3D12_RESOURCE_DESC1 resource_desc = {};
   resource_desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
   resource_desc.Alignment =
@@ -1035,6 +1117,37 @@ ac_d3d12_create_image(
   resource_desc.SampleDesc.Quality = 0;
   resource_desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 
+  if (info->usage & ac_image_usage_attachment_bit)
+  {
+    if (ac_format_depth_or_stencil(info->format))
+    {
+      resource_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+    }
+    else
+    {
+      resource_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    }
+  }
+
+  if (info->usage & ac_image_usage_uav_bit)
+  {
+    resource_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+  }
+
+  return resource_desc;
+}
+
+static ac_result
+ac_d3d12_create_image(
+  ac_device            device_handle,
+  const ac_image_info* info,
+  ac_image*            image_handle)
+{
+  AC_INIT_INTERNAL(image, ac_d3d12_image);
+  AC_FROM_HANDLE(device, ac_d3d12_device);
+
+  D3D12_RESOURCE_DESC1 resource_desc = ac_d3d12_image_desc(info);
+
   D3D12MA::ALLOCATION_DESC alloc_desc = {};
   alloc_desc.HeapType = D3D12_HEAP_TYPE_DEFAULT;
 
@@ -1051,62 +1164,78 @@ ac_d3d12_create_image(
     clear_value.DepthStencil.Depth = info->clear_value.depth;
     clear_value.DepthStencil.Stencil = info->clear_value.stencil;
     p_clear_value = &clear_value;
-
-    if (ac_format_depth_or_stencil(info->format))
-    {
-      resource_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
-    }
-    else
-    {
-      resource_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
-    }
   }
 
-  if (info->usage & ac_image_usage_uav_bit)
+  D3D12MA::Allocation* memory_allocation = NULL;
+  if (info->memory)
   {
-    resource_desc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+    AC_FROM_HANDLE2(memory, info->memory, ac_d3d12_memory);
+    memory_allocation = memory->allocation;
+    image->placed = true;
   }
 
 #if (AC_D3D12_USE_ENHANCED_BARRIERS)
 
   if (device->enhanced_barriers)
   {
-    AC_D3D12_RIF(device->allocator->CreateResource3(
-      &alloc_desc,
-      &resource_desc,
-      D3D12_BARRIER_LAYOUT_UNDEFINED,
-      p_clear_value,
-      0,
-      NULL,
-      &image->allocation,
-      AC_IID_PPV_ARGS(&image->resource)));
+    if (memory_allocation)
+    {
+      AC_D3D12_RIF(device->allocator->CreateAliasingResource2(
+        memory_allocation,
+        info->memory_offset,
+        &resource_desc,
+        D3D12_BARRIER_LAYOUT_UNDEFINED,
+        p_clear_value,
+        0,
+        NULL,
+        AC_IID_PPV_ARGS(&image->resource)));
+    }
+    else
+    {
+      AC_D3D12_RIF(device->allocator->CreateResource3(
+        &alloc_desc,
+        &resource_desc,
+        D3D12_BARRIER_LAYOUT_UNDEFINED,
+        p_clear_value,
+        0,
+        NULL,
+        &image->allocation,
+        AC_IID_PPV_ARGS(&image->resource)));
+    }
   }
   else
 #endif
   {
-    D3D12_RESOURCE_DESC resource_desc2 = {};
-    resource_desc2.Dimension = resource_desc.Dimension;
-    resource_desc2.Alignment = resource_desc.Alignment;
-    resource_desc2.Width = resource_desc.Width;
-    resource_desc2.Height = resource_desc.Height;
-    resource_desc2.DepthOrArraySize = resource_desc.DepthOrArraySize;
-    resource_desc2.MipLevels = resource_desc.MipLevels;
-    resource_desc2.Format = resource_desc.Format;
-    resource_desc2.SampleDesc = resource_desc.SampleDesc;
-    resource_desc2.Layout = resource_desc.Layout;
-    resource_desc2.Flags = resource_desc.Flags;
-
-    AC_D3D12_RIF(device->allocator->CreateResource(
-      &alloc_desc,
-      &resource_desc2,
-      D3D12_RESOURCE_STATE_COMMON,
-      p_clear_value,
-      &image->allocation,
-      AC_IID_PPV_ARGS(&image->resource)));
+    D3D12_RESOURCE_DESC resource_desc2 =
+      ac_d3d12_resource_desc_from_desc1(&resource_desc);
+
+    if (memory_allocation)
+    {
+      AC_D3D12_RIF(device->allocator->CreateAliasingResource(
+        memory_allocation,
+        info->memory_offset,
+        &resource_desc2,
+        D3D12_RESOURCE_STATE_COMMON,
+        p_clear_value,
+        AC_IID_PPV_ARGS(&image->resource)));
+    }
+    else
+    {
+      AC_D3D12_RIF(device->allocator->CreateResource(
+        &alloc_desc,
+        &resource_desc2,
+        D3D12_RESOURCE_STATE_COMMON,
+        p_clear_value,
+        &image->allocation,
+        AC_IID_PPV_ARGS(&image->resource)));
+    }
   }
 
   AC_D3D12_SET_OBJECT_NAME(image->resource, info->name);
-  AC_D3D12_SET_OBJECT_NAME(image->allocation, info->name);
+  if (image->allocation)
+  {
+    AC_D3D12_SET_OBJECT_NAME(image->allocation, info->name);
+  }
 
   image->handle = AC_D3D12_INVALID_HANDLE;
 
@@ -1213,6 +1342,8 @@ ac_d3d12_create_buffer(
     state |= D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
   }
 
+  buffer->placed = info->memory != NULL;
+
   return ac_d3d12_create_buffer2(
     device,
     info,
@@ -1236,6 +1367,115 @@ ac_d3d12_destroy_buffer(ac_device device_handle, ac_buffer buffer_handle)
   AC_D3D12_SAFE_RELEASE(buffer->allocation);
 }
 
+static ac_result
+ac_d3d12_create_memory(
+  ac_device             device_handle,
+  const ac_memory_info* info,
+  ac_memory*            memory_handle)
+{
+  AC_FROM_HANDLE(device, ac_d3d12_device);
+
+  AC_INIT_INTERNAL(memory, ac_d3d12_memory);
+
+  D3D12MA::ALLOCATION_DESC alloc_desc = {};
+  alloc_desc.HeapType = ac_memory_usage_to_d3d12(info->memory_usage);
+
+  if (!device->heap_tier_2)
+  {
+    switch (info->type_bits)
+    {
+    case AC_BIT(0):
+      alloc_desc.ExtraHeapFlags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+      break;
+    case AC_BIT(1):
+      alloc_desc.ExtraHeapFlags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+      break;
+    case AC_BIT(2):
+      alloc_desc.ExtraHeapFlags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+      break;
+    default:
+      return ac_result_invalid_argument;
+    }
+  }
+
+  D3D12_RESOURCE_ALLOCATION_INFO allocation_info = {};
+  allocation_info.SizeInBytes = info->size;
+  allocation_info.Alignment = info->alignment;
+
+  AC_D3D12_RIF(device->allocator->AllocateMemory(
+    &alloc_desc,
+    &allocation_info,
+    &memory->allocation));
+
+  AC_D3D12_SET_OBJECT_NAME(memory->allocation, info->name);
+
+  return ac_result_success;
+}
+
+static void
+ac_d3d12_destroy_memory(ac_device device_handle, ac_memory memory_handle)
+{
+  AC_UNUSED(device_handle);
+  AC_FROM_HANDLE(memory, ac_d3d12_memory);
+
+  AC_D3D12_SAFE_RELEASE(memory->allocation);
+}
+
+static inline void
+ac_d3d12_get_memory_requirements(
+  ac_d3d12_device*            device,
+  const D3D12_RESOURCE_DESC1* resource_desc,
+  ac_memory_requirements*     requirements)
+{
+  D3D12_RESOURCE_DESC resource_desc2 =
+    ac_d3d12_resource_desc_from_desc1(resource_desc);
+
+  D3D12_RESOURCE_ALLOCATION_INFO allocation_info =
+    device->device->GetResourceAllocationInfo(0, 1, &resource_desc2);
+
+  requirements->size = allocation_info.SizeInBytes;
+  requirements->alignment = allocation_info.Alignment;
+  requirements->type_bits = ac_d3d12_memory_type_bits(device, resource_desc);
+}
+
+static ac_result
+ac_d3d12_get_image_memory_requirements(
+  ac_device               device_handle,
+  const ac_image_info*    info,
+  ac_memory_requirements* requirements)
+{
+  AC_FROM_HANDLE(device, ac_d3d12_device);
+
+  D3D12_RESOURCE_DESC1 resource_desc = ac_d3d12_image_desc(info);
+  ac_d3d12_get_memory_requirements(device, &resource_desc, requirements);
+
+  if (requirements->size == UINT64_MAX)
+  {
+    return ac_result_invalid_argument;
+  }
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_d3d12_get_buffer_memory_requirements(
+  ac_device               device_handle,
+  const ac_buffer_info*   info,
+  ac_memory_requirements* requirements)
+{
+  AC_FROM_HANDLE(device, ac_d3d12_device);
+
+  D3D12_RESOURCE_DESC1 resource_desc = ac_d3d12_buffer_desc(device, info);
+  ac_d3d12_get_memory_requirements(device, &resource_desc, requirements);
+
+  if (requirements->size == UINT64_MAX)
+  {
+    return ac_result_invalid_argument;
+  }
+
+  return ac_result_success;
+}
+
 static ac_result
 ac_d3d12_map_memory(ac_device device_handle, ac_buffer buffer_handle)
 {
@@ -1326,6 +1566,7 @@ ac_d3d12_update_descriptor(
 
   handle +=
     ac_d3d12_get_binding_handle(db, space_index, write->reg, write->type);
+  handle += write->index;
 
   for (uint32_t j = 0; j < write->count; ++j)
   {
@@ -1560,6 +1801,26 @@ ac_d3d12_update_descriptor(
   }
 }
 
+static void
+ac_d3d12_update_set(
+  ac_device                  device_handle,
+  ac_descriptor_buffer       db_handle,
+  ac_space                   space_index,
+  uint32_t                   set,
+  uint32_t                   count,
+  const ac_descriptor_write* writes)
+{
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ac_d3d12_update_descriptor(
+      device_handle,
+      db_handle,
+      space_index,
+      set,
+      &writes[i]);
+  }
+}
+
 static ac_result
 ac_d3d12_create_sbt(
   ac_device          device_handle,
@@ -1925,6 +2186,14 @@ ac_d3d12_cmd_barrier(
         out->AccessBefore &= ~D3D12_BARRIER_ACCESS_DEPTH_STENCIL_READ;
         out->AccessBefore |= D3D12_BARRIER_ACCESS_DEPTH_STENCIL_WRITE;
       }
+
+      // placed attachment that takes over aliased memory must be discarded
+      if (
+        image->placed && in->old_layout == ac_image_layout_undefined &&
+        (image->common.usage & ac_image_usage_attachment_bit))
+      {
+        out->Flags |= D3D12_TEXTURE_BARRIER_FLAG_DISCARD;
+      }
     }
 
     if (image_barrier_count)
@@ -1945,7 +2214,7 @@ ac_d3d12_cmd_barrier(
   {
     D3D12_RESOURCE_BARRIER* barriers =
       static_cast<D3D12_RESOURCE_BARRIER*>(ac_alloc(
-        (buffer_barrier_count + image_barrier_count) *
+        (buffer_barrier_count + image_barrier_count) * 2 *
         sizeof(D3D12_RESOURCE_BARRIER)));
 
     uint32_t barrier_count = 0;
@@ -1954,6 +2223,19 @@ ac_d3d12_cmd_barrier(
     {
       const ac_buffer_barrier* src = &buffer_barriers[i];
       AC_FROM_HANDLE2(buffer, src->buffer, ac_d3d12_buffer);
+
+      // legacy barriers can't tell first use of placed buffer, so activate
+      // it on every barrier
+      if (buffer->placed)
+      {
+        D3D12_RESOURCE_BARRIER* alias = &barriers[barrier_count];
+        alias->Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+        alias->Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        alias->Aliasing.pResourceBefore = NULL;
+        alias->Aliasing.pResourceAfter = buffer->resource;
+        barrier_count++;
+      }
+
       D3D12_RESOURCE_BARRIER* dst = &barriers[barrier_count];
 
       dst->Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
@@ -1967,6 +2249,17 @@ ac_d3d12_cmd_barrier(
     {
       const ac_image_barrier* src = &image_barriers[i];
       AC_FROM_HANDLE2(image, src->image, ac_d3d12_image);
+
+      if (image->placed && src->old_layout == ac_image_layout_undefined)
+      {
+        D3D12_RESOURCE_BARRIER* alias = &barriers[barrier_count];
+        alias->Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+        alias->Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        alias->Aliasing.pResourceBefore = NULL;
+        alias->Aliasing.pResourceAfter = image->resource;
+        barrier_count++;
+      }
+
       D3D12_RESOURCE_BARRIER* dst = &barriers[barrier_count];
 
       dst->Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
@@ -2745,9 +3038,15 @@ ac_d3d12_get_device_common_functions(ac_d3d12_device* device)
   device->common.destroy_buffer = ac_d3d12_destroy_buffer;
   device->common.map_memory = ac_d3d12_map_memory;
   device->common.unmap_memory = ac_d3d12_unmap_memory;
+  device->common.create_memory = ac_d3d12_create_memory;
+  device->common.destroy_memory = ac_d3d12_destroy_memory;
+  device->common.get_image_memory_requirements =
+    ac_d3d12_get_image_memory_requirements;
+  device->common.get_buffer_memory_requirements =
+    ac_d3d12_get_buffer_memory_requirements;
   device->common.create_sampler = ac_d3d12_create_sampler;
   device->common.destroy_sampler = ac_d3d12_destroy_sampler;
-  device->common.update_descriptor = ac_d3d12_update_descriptor;
+  device->common.update_set = ac_d3d12_update_set;
   device->common.cmd_barrier = ac_d3d12_cmd_barrier;
   device->common.create_sbt = ac_d3d12_create_sbt;
   device->common.destroy_sbt = ac_d3d12_destroy_sbt;
@@ -67,6 +67,7 @@ typedef struct ac_d3d12_device {
   uint32_t             resource_descriptor_size;
   uint32_t             sampler_descriptor_size;
   bool                 enhanced_barriers;
+  bool                 heap_tier_2;
   RENDERDOC_API_1_6_0* rdoc;
 } ac_d3d12_device;
 
@@ -110,14 +111,21 @@ typedef struct ac_d3d12_image {
   ID3D12Resource*      resource;
   D3D12MA::Allocation* allocation;
   uint64_t             handle;
+  bool                 placed;
 } ac_d3d12_image;
 
 typedef struct ac_d3d12_buffer {
   ac_buffer_internal   common;
   ID3D12Resource*      resource;
   D3D12MA::Allocation* allocation;
+  bool                 placed;
 } ac_d3d12_buffer;
 
+typedef struct ac_d3d12_memory {
+  ac_memory_internal   common;
+  D3D12MA::Allocation* allocation;
+} ac_d3d12_memory;
+
 typedef struct ac_d3d12_swapchain {
   ac_swapchain_internal common;
   union {
@@ -816,6 +816,10 @@ ac_d3d12_create_device(const ac_device_info* info, ac_device* device_handle)
     return ac_result_unknown_error;
   }
 
+  device->common.support_placed_resources = true;
+  device->heap_tier_2 = device->allocator->GetD3D12Options().ResourceHeapTier >=
+                        D3D12_RESOURCE_HEAP_TIER_2;
+
   AC_D3D12_SAFE_RELEASE(adapter);
 
   AC_D3D12_RIF(ac_d3d12_create_cpu_heap(
@@ -256,7 +256,7 @@ ac_mtl_update_resources(
       return NULL;
     }
 
-    resource_index = p_resource->index;
+    resource_index = p_resource->index + write->index;
     rw = p_resource->rw;
   }
 
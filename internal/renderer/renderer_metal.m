@@ -919,7 +919,10 @@ ac_mtl_create_dsl(
   {
     ac_mtl_dsl_space* space = &dsl->spaces[i];
 
-    space->resource_map = hashmap_new(
+    space->resource_map = hashmap_new_with_allocator(
+      ac_hashmap_alloc,
+      ac_hashmap_realloc,
+      ac_free,
       sizeof(ac_mtl_resource),
       0,
       0,
@@ -1078,7 +1081,10 @@ ac_mtl_create_descriptor_buffer(
 
     out->set_count = info->max_sets[s];
 
-    out->resources.resource_map = hashmap_new(
+    out->resources.resource_map = hashmap_new_with_allocator(
+      ac_hashmap_alloc,
+      ac_hashmap_realloc,
+      ac_free,
       sizeof(ac_mtl_resource),
       0,
       0,
@@ -1690,7 +1696,7 @@ ac_mtl_update_descriptor(
     uint32_t index = ac_shader_compiler_get_shader_binding_index(
                        (ac_shader_descriptor_type)write->type,
                        write->reg) +
-                     j;
+                     write->index + j;
 
     switch (write->type)
     {
@@ -1739,6 +1745,26 @@ ac_mtl_update_descriptor(
   AC_OBJC_END_ARP();
 }
 
+static void
+ac_mtl_update_set(
+  ac_device                  device_handle,
+  ac_descriptor_buffer       db_handle,
+  ac_space                   space_index,
+  uint32_t                   set,
+  uint32_t                   count,
+  const ac_descriptor_write* writes)
+{
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ac_mtl_update_descriptor(
+      device_handle,
+      db_handle,
+      space_index,
+      set,
+      &writes[i]);
+  }
+}
+
 static ac_result
 ac_mtl_create_blas(
   ac_device         device_handle,
@@ -2827,7 +2853,7 @@ ac_mtl_create_device(const ac_device_info* info, ac_device* device_handle)
   device->common.destroy_sampler = ac_mtl_destroy_sampler;
   device->common.create_image = ac_mtl_create_image;
   device->common.destroy_image = ac_mtl_destroy_image;
-  device->common.update_descriptor = ac_mtl_update_descriptor;
+  device->common.update_set = ac_mtl_update_set;
   device->common.create_blas = ac_mtl_create_blas;
   device->common.create_tlas = ac_mtl_create_tlas;
   device->common.destroy_as = ac_mtl_destroy_as;
@@ -209,8 +209,12 @@ ac_vk_load_device_functions(ac_vk_device* device)
   LOAD(vkCreateImage);
   LOAD(vkCreateImageView);
   LOAD(vkCreatePipelineLayout);
+  LOAD(vkCreatePipelineCache);
+  LOAD(vkDestroyPipelineCache);
+  LOAD(vkGetPipelineCacheData);
   LOAD(vkCreateSampler);
   LOAD(vkCreateSemaphore);
+  LOAD(vkCreateEvent);
   LOAD(vkCreateShaderModule);
   LOAD(vkDestroyBuffer);
   LOAD(vkDestroyCommandPool);
@@ -223,6 +227,7 @@ ac_vk_load_device_functions(ac_vk_device* device)
   LOAD(vkDestroyPipelineLayout);
   LOAD(vkDestroySampler);
   LOAD(vkDestroySemaphore);
+  LOAD(vkDestroyEvent);
   LOAD(vkDestroyShaderModule);
   LOAD(vkDeviceWaitIdle);
   LOAD(vkEndCommandBuffer);
@@ -248,6 +253,9 @@ ac_vk_load_device_functions(ac_vk_device* device)
   LOAD(vkCmdBeginRendering);
   LOAD(vkCmdEndRendering);
   LOAD(vkCmdPipelineBarrier2);
+  LOAD(vkCmdSetEvent2);
+  LOAD(vkCmdWaitEvents2);
+  LOAD(vkCmdResetEvent2);
   LOAD(vkGetDeviceBufferMemoryRequirements);
   LOAD(vkGetDeviceImageMemoryRequirements);
   LOAD(vkQueueSubmit2);
@@ -265,6 +273,11 @@ ac_vk_load_device_functions(ac_vk_device* device)
   LOAD(vkDestroySwapchainKHR);
   LOAD(vkGetSwapchainImagesKHR);
   LOAD(vkQueuePresentKHR);
+  LOAD(vkGetDescriptorSetLayoutSizeEXT);
+  LOAD(vkGetDescriptorSetLayoutBindingOffsetEXT);
+  LOAD(vkGetDescriptorEXT);
+  LOAD(vkCmdBindDescriptorBuffersEXT);
+  LOAD(vkCmdSetDescriptorBufferOffsetsEXT);
 
 #undef LOAD
 }
@@ -311,6 +324,51 @@ ac_vk_get_as_address(ac_vk_device* device, VkAccelerationStructureKHR as)
     &info);
 }
 
+// descriptor buffers reference buffers by address instead of handle
+static inline VkBufferUsageFlags
+ac_vk_buffer_descriptor_usage(
+  const ac_vk_device*   device,
+  const ac_buffer_info* info)
+{
+  ac_buffer_usage_bits descriptor_bits =
+    ac_buffer_usage_cbv_bit | ac_buffer_usage_srv_bit | ac_buffer_usage_uav_bit;
+
+  if (device->descriptor_buffer && (info->usage & descriptor_bits))
+  {
+    return VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+  }
+
+  return 0;
+}
+
+static inline VkPipelineCreateFlags
+ac_vk_pipeline_create_flags(const ac_vk_device* device)
+{
+  if (device->descriptor_buffer)
+  {
+    return VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+  }
+
+  return 0;
+}
+
+static inline VkDeviceSize
+ac_vk_find_binding_offset(
+  const ac_vk_binding_offset* offsets,
+  uint32_t                    binding)
+{
+  for (size_t i = 0; i < array_size(offsets); ++i)
+  {
+    if (offsets[i].binding == binding)
+    {
+      return offsets[i].offset;
+    }
+  }
+
+  AC_ASSERT(false);
+  return 0;
+}
+
 #if (AC_INCLUDE_DEBUG)
 static inline void
 ac_vk_set_object_name(
@@ -361,13 +419,24 @@ ac_vk_create_pipeline_layout(
     .size = AC_MAX_PUSH_CONSTANT_RANGE,
   };
 
+  const ac_bindless_table* bindless = &device->common.bindless;
+
   uint32_t              set_layout_count = 0;
   VkDescriptorSetLayout set_layouts[ac_space_count];
   for (uint32_t i = 0; i < ac_space_count; ++i)
   {
-    if (dsl->dsls[i] != VK_NULL_HANDLE)
+    VkDescriptorSetLayout set_layout = dsl->dsls[i];
+
+    // layout has to match the table exactly to bind it
+    if (bindless->dsl && i == bindless->space)
+    {
+      AC_FROM_HANDLE2(bindless_dsl, bindless->dsl, ac_vk_dsl);
+      set_layout = bindless_dsl->dsls[i];
+    }
+
+    if (set_layout != VK_NULL_HANDLE)
     {
-      set_layouts[set_layout_count++] = dsl->dsls[i];
+      set_layouts[set_layout_count++] = set_layout;
     }
   }
 
@@ -617,6 +686,21 @@ ac_vk_recreate_binary_fence(ac_device device_handle, ac_vk_fence* fence)
   return ac_result_success;
 }
 
+static inline VkBufferCreateInfo
+ac_vk_buffer_create_info(const ac_buffer_info* info, VkBufferUsageFlags usage)
+{
+  return (VkBufferCreateInfo) {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .pNext = NULL,
+    .flags = 0,
+    .size = info->size,
+    .usage = ac_buffer_usage_bits_to_vk(info->usage) | usage,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    .queueFamilyIndexCount = 0,
+    .pQueueFamilyIndices = NULL,
+  };
+}
+
 static inline ac_result
 ac_vk_create_buffer2(
   ac_vk_device*         device,
@@ -632,18 +716,23 @@ ac_vk_create_buffer2(
              VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT,
   };
 
-  VkBufferCreateInfo buffer_create_info = {
-    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-    .pNext = NULL,
-    .flags = 0,
-    .size = info->size,
-    .usage = ac_buffer_usage_bits_to_vk(info->usage) | usage,
-    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-    .queueFamilyIndexCount = 0,
-    .pQueueFamilyIndices = NULL,
-  };
+  VkBufferCreateInfo buffer_create_info =
+    ac_vk_buffer_create_info(info, usage);
 
-  if (info->usage & ac_buffer_usage_raytracing_bit)
+  if (info->memory)
+  {
+    AC_FROM_HANDLE2(memory, info->memory, ac_vk_memory);
+
+    *allocation = NULL;
+
+    AC_VK_RIF(vmaCreateAliasingBuffer2(
+      device->gpu_allocator,
+      memory->allocation,
+      info->memory_offset,
+      &buffer_create_info,
+      buffer));
+  }
+  else if (info->usage & ac_buffer_usage_raytracing_bit)
   {
     // TODO: get alignment from props
     uint64_t alignment = 256;
@@ -677,6 +766,166 @@ ac_vk_create_buffer2(
   return ac_result_success;
 }
 
+#define AC_VK_PIPELINE_CACHE_MAGIC 0x63707661
+#define AC_VK_PIPELINE_CACHE_PATH "ac-vk-pipeline-cache.bin"
+
+static void*
+ac_vk_read_pipeline_cache(ac_vk_device* device, size_t* size)
+{
+  *size = 0;
+
+  if (!ac_path_exists(AC_SYSTEM_FS, ac_mount_save, AC_VK_PIPELINE_CACHE_PATH))
+  {
+    return NULL;
+  }
+
+  ac_file file = NULL;
+  if (
+    ac_create_file(
+      AC_SYSTEM_FS,
+      ac_mount_save,
+      AC_VK_PIPELINE_CACHE_PATH,
+      ac_file_mode_read_bit,
+      &file) != ac_result_success)
+  {
+    return NULL;
+  }
+
+  ac_vk_pipeline_cache_header header;
+  void*                       data = NULL;
+  size_t                      file_size = ac_file_get_size(file);
+
+  if (
+    file_size <= sizeof(header) ||
+    ac_file_read(file, sizeof(header), &header) != ac_result_success)
+  {
+    ac_destroy_file(file);
+    return NULL;
+  }
+
+  const ac_vk_pipeline_cache_header* expected =
+    &device->pipeline_cache_header;
+
+  // everything before size must match
+  if (
+    header.data_size != file_size - sizeof(header) ||
+    memcmp(&header, expected, offsetof(ac_vk_pipeline_cache_header, data_size)))
+  {
+    AC_DEBUG("[ vulkan ] : pipeline cache is out of date");
+    ac_destroy_file(file);
+    return NULL;
+  }
+
+  data = ac_alloc(header.data_size);
+  if (
+    data &&
+    ac_file_read(file, header.data_size, data) == ac_result_success &&
+    hashmap_murmur(data, header.data_size, 0, 0) == header.data_hash)
+  {
+    *size = header.data_size;
+  }
+  else
+  {
+    ac_free(data);
+    data = NULL;
+  }
+
+  ac_destroy_file(file);
+  return data;
+}
+
+static void
+ac_vk_create_pipeline_cache(ac_vk_device* device)
+{
+  size_t size = 0;
+  void*  data = ac_vk_read_pipeline_cache(device, &size);
+
+  VkPipelineCacheCreateInfo info = {
+    .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+    .initialDataSize = size,
+    .pInitialData = data,
+  };
+
+  VkResult res = device->vkCreatePipelineCache(
+    device->device,
+    &info,
+    &device->cpu_allocator,
+    &device->pipeline_cache);
+
+  if (res != VK_SUCCESS && data)
+  {
+    info.initialDataSize = 0;
+    info.pInitialData = NULL;
+
+    res = device->vkCreatePipelineCache(
+      device->device,
+      &info,
+      &device->cpu_allocator,
+      &device->pipeline_cache);
+  }
+
+  // pipelines are still created without cache
+  if (res != VK_SUCCESS)
+  {
+    device->pipeline_cache = VK_NULL_HANDLE;
+  }
+
+  ac_free(data);
+}
+
+static void
+ac_vk_save_pipeline_cache(ac_vk_device* device)
+{
+  size_t size = 0;
+  if (
+    device->vkGetPipelineCacheData(
+      device->device,
+      device->pipeline_cache,
+      &size,
+      NULL) != VK_SUCCESS ||
+    !size)
+  {
+    return;
+  }
+
+  void* data = ac_alloc(size);
+  if (!data)
+  {
+    return;
+  }
+
+  ac_file file = NULL;
+
+  if (
+    device->vkGetPipelineCacheData(
+      device->device,
+      device->pipeline_cache,
+      &size,
+      data) == VK_SUCCESS &&
+    ac_create_file(
+      AC_SYSTEM_FS,
+      ac_mount_save,
+      AC_VK_PIPELINE_CACHE_PATH,
+      ac_file_mode_write_bit,
+      &file) == ac_result_success)
+  {
+    ac_vk_pipeline_cache_header header = device->pipeline_cache_header;
+    header.data_size = size;
+    header.data_hash = hashmap_murmur(data, size, 0, 0);
+
+    if (
+      ac_file_write(file, sizeof(header), &header) != ac_result_success ||
+      ac_file_write(file, size, data) != ac_result_success)
+    {
+      AC_DEBUG("[ vulkan ] : failed to save pipeline cache");
+    }
+
+    ac_destroy_file(file);
+  }
+
+  ac_free(data);
+}
+
 static void
 ac_vk_destroy_device(ac_device device_handle)
 {
@@ -691,6 +940,10 @@ ac_vk_destroy_device(ac_device device_handle)
 
     ac_queue queue_handle = device->common.queues[i];
     AC_FROM_HANDLE(queue, ac_vk_queue);
+    array_free(queue->wait_semaphores);
+    array_free(queue->signal_semaphores);
+    array_free(queue->cmds);
+    array_free(queue->present_semaphores);
     ac_free(queue);
   }
 
@@ -699,6 +952,15 @@ ac_vk_destroy_device(ac_device device_handle)
     vmaDestroyAllocator(device->gpu_allocator);
   }
 
+  if (device->pipeline_cache)
+  {
+    ac_vk_save_pipeline_cache(device);
+    device->vkDestroyPipelineCache(
+      device->device,
+      device->pipeline_cache,
+      &device->cpu_allocator);
+  }
+
   if (device->device)
   {
     device->vkDestroyDevice(device->device, &device->cpu_allocator);
@@ -726,6 +988,12 @@ ac_vk_map_memory(ac_device device_handle, ac_buffer buffer_handle)
   AC_FROM_HANDLE(device, ac_vk_device);
   AC_FROM_HANDLE(buffer, ac_vk_buffer);
 
+  // placed buffers are not mappable
+  if (!buffer->allocation)
+  {
+    return ac_result_bad_usage;
+  }
+
   AC_VK_RIF(vmaMapMemory(
     device->gpu_allocator,
     buffer->allocation,
@@ -757,24 +1025,14 @@ ac_vk_queue_submit(ac_queue queue_handle, const ac_queue_submit_info* info)
   AC_FROM_HANDLE2(device, queue_handle->device, ac_vk_device);
   AC_FROM_HANDLE(queue, ac_vk_queue);
 
-  VkSemaphoreSubmitInfo*     wait_semaphores = NULL;
-  VkSemaphoreSubmitInfo*     signal_semaphores = NULL;
-  VkCommandBufferSubmitInfo* cmds = NULL;
-
-  if (info->wait_fence_count)
-  {
-    wait_semaphores =
-      ac_alloc(info->wait_fence_count * sizeof(VkSemaphoreSubmitInfo));
-  }
-
-  if (info->signal_fence_count)
-  {
-    signal_semaphores =
-      ac_alloc(info->signal_fence_count * sizeof(VkSemaphoreSubmitInfo));
-  }
-
-  cmds = ac_alloc(info->cmd_count * sizeof(VkCommandBufferSubmitInfo));
+  // storage only grows, so steady state submits do not allocate
+  array_resize(queue->wait_semaphores, info->wait_fence_count);
+  array_resize(queue->signal_semaphores, info->signal_fence_count);
+  array_resize(queue->cmds, info->cmd_count);
 
+  VkSemaphoreSubmitInfo*     wait_semaphores = queue->wait_semaphores;
+  VkSemaphoreSubmitInfo*     signal_semaphores = queue->signal_semaphores;
+  VkCommandBufferSubmitInfo* cmds = queue->cmds;
 
   uint32_t wait_count = 0;
   for (uint32_t i = 0; i < info->wait_fence_count; ++i)
@@ -879,10 +1137,6 @@ ac_vk_queue_submit(ac_queue queue_handle, const ac_queue_submit_info* info)
     break;
   }
 
-  ac_free(wait_semaphores);
-  ac_free(signal_semaphores);
-  ac_free(cmds);
-
   return res;
 }
 
@@ -893,12 +1147,9 @@ ac_vk_queue_present(ac_queue queue_handle, const ac_queue_present_info* info)
   AC_FROM_HANDLE2(swapchain, info->swapchain, ac_vk_swapchain);
   AC_FROM_HANDLE(queue, ac_vk_queue);
 
-  VkSemaphore* wait_semaphores = NULL;
+  array_resize(queue->present_semaphores, info->wait_fence_count);
 
-  if (info->wait_fence_count)
-  {
-    wait_semaphores = ac_alloc(info->wait_fence_count * sizeof(VkSemaphore));
-  }
+  VkSemaphore* wait_semaphores = queue->present_semaphores;
 
   for (uint32_t i = 0; i < info->wait_fence_count; ++i)
   {
@@ -957,8 +1208,6 @@ ac_vk_queue_present(ac_queue queue_handle, const ac_queue_present_info* info)
   }
   }
 
-  ac_free(wait_semaphores);
-
   return res;
 }
 
@@ -1010,6 +1259,36 @@ ac_vk_destroy_fence(ac_device device_handle, ac_fence fence_handle)
     &device->cpu_allocator);
 }
 
+static ac_result
+ac_vk_create_event(ac_device device_handle, ac_event* event_handle)
+{
+  AC_FROM_HANDLE(device, ac_vk_device);
+
+  AC_INIT_INTERNAL(event, ac_vk_event);
+
+  VkEventCreateInfo event_create_info = {
+    .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
+    .flags = VK_EVENT_CREATE_DEVICE_ONLY_BIT,
+  };
+
+  AC_VK_RIF(device->vkCreateEvent(
+    device->device,
+    &event_create_info,
+    &device->cpu_allocator,
+    &event->event));
+
+  return ac_result_success;
+}
+
+static void
+ac_vk_destroy_event(ac_device device_handle, ac_event event_handle)
+{
+  AC_FROM_HANDLE(device, ac_vk_device);
+  AC_FROM_HANDLE(event, ac_vk_event);
+
+  device->vkDestroyEvent(device->device, event->event, &device->cpu_allocator);
+}
+
 static ac_result
 ac_vk_get_fence_value(
   ac_device device_handle,
@@ -1508,7 +1787,10 @@ ac_vk_destroy_cmd(
 {
   AC_UNUSED(device_handle);
   AC_UNUSED(_cmd_pool);
-  AC_UNUSED(cmd_handle);
+  AC_FROM_HANDLE(cmd, ac_vk_cmd);
+
+  array_free(cmd->buffer_barriers);
+  array_free(cmd->image_barriers);
 }
 
 static ac_result
@@ -1524,6 +1806,9 @@ ac_vk_begin_cmd(ac_cmd cmd_handle)
   };
 
   AC_VK_RIF(device->vkBeginCommandBuffer(cmd->cmd, &cmd_buffer_begin_info));
+
+  cmd->descriptor_buffer_count = 0;
+
   return ac_result_success;
 }
 
@@ -1642,9 +1927,21 @@ ac_vk_create_dsl(
   AC_FROM_HANDLE(device, ac_vk_device);
 
   array_t(VkDescriptorSetLayoutBinding) bindings[ac_space_count];
-  // array_t(VkDescriptorBindingFlags) binding_flags[ac_space_count];
+  array_t(VkDescriptorBindingFlags) binding_flags[ac_space_count];
   AC_ZERO(bindings);
-  // AC_ZERO(binding_flags);
+  AC_ZERO(binding_flags);
+
+  // bindless arrays are filled sparsely and updated while in use
+  VkDescriptorBindingFlags bindless_flags = 0;
+  if (info->bindless)
+  {
+    bindless_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+    if (!device->descriptor_buffer)
+    {
+      bindless_flags |= VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                        VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    }
+  }
 
   for (uint32_t b = 0; b < info->binding_count; ++b)
   {
@@ -1658,27 +1955,40 @@ ac_vk_create_dsl(
     };
 
     array_append(bindings[in->space], out);
-    // array_append(
-    //   binding_flags[in->space],
-    //   VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
+    array_append(binding_flags[in->space], bindless_flags);
   }
 
   for (uint32_t space = 0; space < ac_space_count; ++space)
   {
-    // VkDescriptorSetLayoutBindingFlagsCreateInfo flags_create_info = {
-    //   .sType =
-    //     VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
-    //   .bindingCount = (uint32_t)(array_size(binding_flags[space])),
-    //   .pBindingFlags = binding_flags[space],
-    // };
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flags_create_info = {
+      .sType =
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+      .bindingCount = (uint32_t)(array_size(binding_flags[space])),
+      .pBindingFlags = binding_flags[space],
+    };
 
     VkDescriptorSetLayoutCreateInfo dsl_create_info = {
       .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
       .bindingCount = (uint32_t)(array_size(bindings[space])),
       .pBindings = bindings[space],
-      // .pNext = &flags_create_info,
     };
 
+    if (bindless_flags)
+    {
+      dsl_create_info.pNext = &flags_create_info;
+    }
+
+    if (device->descriptor_buffer)
+    {
+      dsl_create_info.flags =
+        VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+    }
+    else if (bindless_flags)
+    {
+      dsl_create_info.flags =
+        VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    }
+
     AC_VK_RIF(device->vkCreateDescriptorSetLayout(
       device->device,
       &dsl_create_info,
@@ -1690,11 +2000,37 @@ ac_vk_create_dsl(
       info->info.name,
       VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT,
       (uint64_t)(dsl->dsls[space]));
+
+    if (!device->descriptor_buffer)
+    {
+      continue;
+    }
+
+    device->vkGetDescriptorSetLayoutSizeEXT(
+      device->device,
+      dsl->dsls[space],
+      &dsl->sizes[space]);
+
+    for (size_t i = 0; i < array_size(bindings[space]); ++i)
+    {
+      ac_vk_binding_offset offset = {
+        .binding = bindings[space][i].binding,
+      };
+
+      device->vkGetDescriptorSetLayoutBindingOffsetEXT(
+        device->device,
+        dsl->dsls[space],
+        offset.binding,
+        &offset.offset);
+
+      array_append(dsl->offsets[space], offset);
+    }
   }
 
   for (size_t i = 0; i < AC_COUNTOF(bindings); ++i)
   {
     array_free(bindings[i]);
+    array_free(binding_flags[i]);
   }
 
   return ac_result_success;
@@ -1715,7 +2051,85 @@ ac_vk_destroy_dsl(ac_device device_handle, ac_dsl dsl_handle)
         dsl->dsls[i],
         &device->cpu_allocator);
     }
+
+    array_free(dsl->offsets[i]);
+  }
+}
+
+static ac_result
+ac_vk_create_descriptor_buffer_memory(
+  ac_vk_device*                    device,
+  const ac_descriptor_buffer_info* info,
+  const ac_vk_dsl*                 dsl,
+  ac_vk_descriptor_buffer*         db)
+{
+  VkDeviceSize size = 0;
+
+  for (uint32_t s = 0; s < ac_space_count; ++s)
+  {
+    uint32_t set_count = info->max_sets[s];
+
+    if (!set_count)
+    {
+      continue;
+    }
+
+    if (dsl->dsls[s] == VK_NULL_HANDLE)
+    {
+      return ac_result_unknown_error;
+    }
+
+    db->space_offsets[s] = size;
+    db->set_strides[s] =
+      AC_ALIGN_UP(dsl->sizes[s], device->descriptor_buffer_alignment);
+
+    for (size_t i = 0; i < array_size(dsl->offsets[s]); ++i)
+    {
+      array_append(db->binding_offsets[s], dsl->offsets[s][i]);
+    }
+
+    size += db->set_strides[s] * set_count;
   }
+
+  if (!size)
+  {
+    return ac_result_success;
+  }
+
+  VkBufferCreateInfo buffer_create_info = {
+    .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+    .size = size,
+    .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+             VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT |
+             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+  };
+
+  VmaAllocationCreateInfo allocation_create_info = {
+    .usage = VMA_MEMORY_USAGE_CPU_TO_GPU,
+    .pUserData = ac_const_cast(info->name),
+    .flags = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT |
+             VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT |
+             VMA_ALLOCATION_CREATE_MAPPED_BIT,
+  };
+
+  VmaAllocationInfo allocation_info;
+
+  AC_VK_RIF(vmaCreateBufferWithAlignment(
+    device->gpu_allocator,
+    &buffer_create_info,
+    &allocation_create_info,
+    device->descriptor_buffer_alignment,
+    &db->buffer,
+    &db->allocation,
+    &allocation_info));
+
+  AC_VK_SET_OBJECT_NAME(device, info->name, VK_OBJECT_TYPE_BUFFER, db->buffer);
+
+  db->mapped = allocation_info.pMappedData;
+  db->address = ac_vk_get_buffer_address(device, db->buffer);
+
+  return ac_result_success;
 }
 
 static ac_result
@@ -1729,6 +2143,11 @@ ac_vk_create_descriptor_buffer(
   AC_FROM_HANDLE(device, ac_vk_device);
   AC_FROM_HANDLE2(dsl, info->dsl, ac_vk_dsl);
 
+  if (device->descriptor_buffer)
+  {
+    return ac_vk_create_descriptor_buffer_memory(device, info, dsl, db);
+  }
+
   VkDescriptorPoolSize pool_sizes[] = {
     {VK_DESCRIPTOR_TYPE_SAMPLER, 0},
     {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0},
@@ -1862,6 +2281,12 @@ ac_vk_destroy_descriptor_buffer(
   for (uint32_t s = 0; s < ac_space_count; ++s)
   {
     ac_free(db->sets[s]);
+    array_free(db->binding_offsets[s]);
+  }
+
+  if (db->buffer)
+  {
+    vmaDestroyBuffer(device->gpu_allocator, db->buffer, db->allocation);
   }
 
   device->vkDestroyDescriptorPool(
@@ -1903,13 +2328,14 @@ ac_vk_create_compute_pipeline(
 
   VkComputePipelineCreateInfo compute_pipeline_create_info = {
     .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+    .flags = ac_vk_pipeline_create_flags(device),
     .stage = shader_stage_create_info,
     .layout = pipeline->pipeline_layout,
   };
 
   AC_VK_RIF(device->vkCreateComputePipelines(
     device->device,
-    VK_NULL_HANDLE,
+    device->pipeline_cache,
     1,
     &compute_pipeline_create_info,
     &device->cpu_allocator,
@@ -1981,6 +2407,7 @@ ac_vk_create_raytracing_pipeline(
 
   VkRayTracingPipelineCreateInfoKHR pipeline_create_info = {
     .sType = VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_CREATE_INFO_KHR,
+    .flags = ac_vk_pipeline_create_flags(device),
     .stageCount = raytracing->shader_count,
     .pStages = stages,
     .groupCount = raytracing->group_count,
@@ -1992,7 +2419,7 @@ ac_vk_create_raytracing_pipeline(
   AC_VK_RIF(device->vkCreateRayTracingPipelinesKHR(
     device->device,
     VK_NULL_HANDLE,
-    VK_NULL_HANDLE,
+    device->pipeline_cache,
     1,
     &pipeline_create_info,
     &device->cpu_allocator,
@@ -2233,6 +2660,7 @@ ac_vk_create_graphics_pipeline(
 
   VkGraphicsPipelineCreateInfo pipeline_create_info = {
     .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+    .flags = ac_vk_pipeline_create_flags(device),
     .stageCount = stage_count,
     .pStages = stage_create_infos,
     .pVertexInputState = &vertex_input_state_create_info,
@@ -2248,7 +2676,7 @@ ac_vk_create_graphics_pipeline(
   };
   AC_VK_RIF(device->vkCreateGraphicsPipelines(
     device->device,
-    VK_NULL_HANDLE,
+    device->pipeline_cache,
     1,
     &pipeline_create_info,
     &device->cpu_allocator,
@@ -2435,6 +2863,7 @@ ac_vk_create_mesh_pipeline(
 
   VkGraphicsPipelineCreateInfo pipeline_create_info = {
     .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+    .flags = ac_vk_pipeline_create_flags(device),
     .stageCount = stage_count,
     .pStages = stage_create_infos,
     .pVertexInputState = NULL,
@@ -2450,7 +2879,7 @@ ac_vk_create_mesh_pipeline(
   };
   AC_VK_RIF(device->vkCreateGraphicsPipelines(
     device->device,
-    VK_NULL_HANDLE,
+    device->pipeline_cache,
     1,
     &pipeline_create_info,
     &device->cpu_allocator,
@@ -2492,12 +2921,21 @@ ac_vk_create_buffer(
 
   AC_INIT_INTERNAL(buffer, ac_vk_buffer);
 
-  return ac_vk_create_buffer2(
+  VkBufferUsageFlags usage = ac_vk_buffer_descriptor_usage(device, info);
+
+  AC_RIF(ac_vk_create_buffer2(
     device,
     info,
-    0,
+    usage,
     &buffer->buffer,
-    &buffer->allocation);
+    &buffer->allocation));
+
+  if (usage)
+  {
+    buffer->address = ac_vk_get_buffer_address(device, buffer->buffer);
+  }
+
+  return ac_result_success;
 }
 
 static void
@@ -2565,24 +3003,12 @@ ac_vk_destroy_sampler(ac_device device_handle, ac_sampler sampler_handle)
     &device->cpu_allocator);
 }
 
-static ac_result
-ac_vk_create_image(
-  ac_device            device_handle,
+static inline ac_result
+ac_vk_image_create_info(
   const ac_image_info* info,
-  ac_image*            image_handle)
+  VkImageCreateInfo*   image_create_info)
 {
-  AC_FROM_HANDLE(device, ac_vk_device);
-
-  AC_INIT_INTERNAL(image, ac_vk_image);
-
-  VmaAllocationCreateInfo allocation_create_info = {
-    .usage = VMA_MEMORY_USAGE_GPU_ONLY,
-    .pUserData = ac_const_cast(info->name),
-    .flags = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT |
-             VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT,
-  };
-
-  VkImageCreateInfo image_create_info = {
+  *image_create_info = (VkImageCreateInfo) {
     .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
     .pNext = NULL,
     .flags = 0,
@@ -2605,29 +3031,66 @@ ac_vk_create_image(
   {
   case ac_image_type_1d:
   case ac_image_type_1d_array:
-    image_create_info.imageType = VK_IMAGE_TYPE_1D;
+    image_create_info->imageType = VK_IMAGE_TYPE_1D;
     break;
   case ac_image_type_cube:
     AC_ASSERT(info->layers == 6);
-    image_create_info.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
-    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info->flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+    image_create_info->imageType = VK_IMAGE_TYPE_2D;
     break;
   case ac_image_type_2d:
   case ac_image_type_2d_array:
-    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info->imageType = VK_IMAGE_TYPE_2D;
     break;
   default:
     AC_ASSERT(false);
     return ac_result_invalid_argument;
   }
 
-  AC_VK_RIF(vmaCreateImage(
-    device->gpu_allocator,
-    &image_create_info,
-    &allocation_create_info,
-    &image->image,
-    &image->allocation,
-    NULL));
+  return ac_result_success;
+}
+
+static ac_result
+ac_vk_create_image(
+  ac_device            device_handle,
+  const ac_image_info* info,
+  ac_image*            image_handle)
+{
+  AC_FROM_HANDLE(device, ac_vk_device);
+
+  AC_INIT_INTERNAL(image, ac_vk_image);
+
+  VmaAllocationCreateInfo allocation_create_info = {
+    .usage = VMA_MEMORY_USAGE_GPU_ONLY,
+    .pUserData = ac_const_cast(info->name),
+    .flags = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT |
+             VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT,
+  };
+
+  VkImageCreateInfo image_create_info;
+  AC_RIF(ac_vk_image_create_info(info, &image_create_info));
+
+  if (info->memory)
+  {
+    AC_FROM_HANDLE2(memory, info->memory, ac_vk_memory);
+
+    AC_VK_RIF(vmaCreateAliasingImage2(
+      device->gpu_allocator,
+      memory->allocation,
+      info->memory_offset,
+      &image_create_info,
+      &image->image));
+  }
+  else
+  {
+    AC_VK_RIF(vmaCreateImage(
+      device->gpu_allocator,
+      &image_create_info,
+      &allocation_create_info,
+      &image->image,
+      &image->allocation,
+      NULL));
+  }
 
   AC_VK_SET_OBJECT_NAME(
     device,
@@ -2755,52 +3218,170 @@ ac_vk_destroy_image(ac_device device_handle, ac_image image_handle)
   vmaDestroyImage(device->gpu_allocator, image->image, image->allocation);
 }
 
+static ac_result
+ac_vk_create_memory(
+  ac_device             device_handle,
+  const ac_memory_info* info,
+  ac_memory*            memory_handle)
+{
+  AC_FROM_HANDLE(device, ac_vk_device);
+
+  AC_INIT_INTERNAL(memory, ac_vk_memory);
+
+  VkMemoryRequirements requirements = {
+    .size = info->size,
+    .alignment = info->alignment,
+    .memoryTypeBits = info->type_bits,
+  };
+
+  VmaAllocationCreateInfo allocation_create_info = {
+    .usage = ac_determine_vma_memory_usage(info->memory_usage),
+    .pUserData = ac_const_cast(info->name),
+    .flags = VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT |
+             VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT,
+  };
+
+  AC_VK_RIF(vmaAllocateMemory(
+    device->gpu_allocator,
+    &requirements,
+    &allocation_create_info,
+    &memory->allocation,
+    NULL));
+
+  return ac_result_success;
+}
+
 static void
-ac_vk_update_descriptor(
-  ac_device                  device_handle,
-  ac_descriptor_buffer       db_handle,
-  ac_space                   space,
-  uint32_t                   set,
-  const ac_descriptor_write* info)
+ac_vk_destroy_memory(ac_device device_handle, ac_memory memory_handle)
 {
   AC_FROM_HANDLE(device, ac_vk_device);
-  AC_FROM_HANDLE(db, ac_vk_descriptor_buffer);
+  AC_FROM_HANDLE(memory, ac_vk_memory);
 
-  VkDescriptorSet descriptor_set = db->sets[space][set];
+  vmaFreeMemory(device->gpu_allocator, memory->allocation);
+}
 
-  VkWriteDescriptorSetAccelerationStructureKHR acceleration_write = {
-    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR,
-    .accelerationStructureCount = info->count,
+static ac_result
+ac_vk_get_image_memory_requirements(
+  ac_device               device_handle,
+  const ac_image_info*    info,
+  ac_memory_requirements* requirements)
+{
+  AC_FROM_HANDLE(device, ac_vk_device);
+
+  VkImageCreateInfo image_create_info;
+  AC_RIF(ac_vk_image_create_info(info, &image_create_info));
+
+  VkDeviceImageMemoryRequirements device_requirements = {
+    .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS,
+    .pCreateInfo = &image_create_info,
+  };
+
+  VkMemoryRequirements2 memory_requirements = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+  };
+
+  device->vkGetDeviceImageMemoryRequirements(
+    device->device,
+    &device_requirements,
+    &memory_requirements);
+
+  requirements->size = memory_requirements.memoryRequirements.size;
+  requirements->alignment = memory_requirements.memoryRequirements.alignment;
+  requirements->type_bits =
+    memory_requirements.memoryRequirements.memoryTypeBits;
+
+  return ac_result_success;
+}
+
+static ac_result
+ac_vk_get_buffer_memory_requirements(
+  ac_device               device_handle,
+  const ac_buffer_info*   info,
+  ac_memory_requirements* requirements)
+{
+  AC_FROM_HANDLE(device, ac_vk_device);
+
+  VkBufferCreateInfo buffer_create_info =
+    ac_vk_buffer_create_info(info, ac_vk_buffer_descriptor_usage(device, info));
+
+  VkDeviceBufferMemoryRequirements device_requirements = {
+    .sType = VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS,
+    .pCreateInfo = &buffer_create_info,
   };
 
+  VkMemoryRequirements2 memory_requirements = {
+    .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+  };
+
+  device->vkGetDeviceBufferMemoryRequirements(
+    device->device,
+    &device_requirements,
+    &memory_requirements);
+
+  requirements->size = memory_requirements.memoryRequirements.size;
+  requirements->alignment = memory_requirements.memoryRequirements.alignment;
+  requirements->type_bits =
+    memory_requirements.memoryRequirements.memoryTypeBits;
+
+  return ac_result_success;
+}
+
+static void
+ac_vk_flush_descriptor_writes(
+  ac_vk_device*            device,
+  ac_vk_descriptor_writes* scratch)
+{
+  if (scratch->write_count)
+  {
+    device->vkUpdateDescriptorSets(
+      device->device,
+      scratch->write_count,
+      scratch->writes,
+      0,
+      NULL);
+  }
+
+  scratch->write_count = 0;
+  scratch->info_count = 0;
+}
+
+static void
+ac_vk_push_descriptor_write(
+  ac_vk_descriptor_writes*   scratch,
+  VkDescriptorSet            descriptor_set,
+  const ac_descriptor_write* info,
+  uint32_t                   first,
+  uint32_t                   count)
+{
   ac_shader_descriptor_type type = (ac_shader_descriptor_type)info->type;
   uint32_t                  binding =
     ac_shader_compiler_get_shader_binding_index(type, info->reg);
 
-  VkWriteDescriptorSet write = {
+  uint32_t              index = scratch->info_count;
+  VkWriteDescriptorSet* write = &scratch->writes[scratch->write_count];
+
+  *write = (VkWriteDescriptorSet) {
     .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-    .dstBinding = binding,
-    .descriptorCount = info->count,
     .dstSet = descriptor_set,
+    .dstBinding = binding,
+    .dstArrayElement = info->index + first,
+    .descriptorCount = count,
     .descriptorType = ac_descriptor_type_to_vk(info->type),
   };
 
-  VkDescriptorBufferInfo*     buffer_descriptors = NULL;
-  VkDescriptorImageInfo*      image_descriptors = NULL;
-  VkAccelerationStructureKHR* acceleration_structures = NULL;
-
   switch (info->type)
   {
   case ac_descriptor_type_cbv_buffer:
   case ac_descriptor_type_srv_buffer:
   case ac_descriptor_type_uav_buffer:
   {
-    buffer_descriptors =
-      ac_calloc(sizeof(VkDescriptorBufferInfo) * info->count);
+    VkDescriptorBufferInfo* buffer_descriptors = &scratch->buffers[index];
 
-    for (uint32_t j = 0; j < info->count; ++j)
+    for (uint32_t j = 0; j < count; ++j)
     {
-      const ac_descriptor* descriptor = &info->descriptors[j];
+      const ac_descriptor* descriptor = &info->descriptors[first + j];
+
+      buffer_descriptors[j] = (VkDescriptorBufferInfo) {0};
 
       if (!descriptor->buffer)
       {
@@ -2814,17 +3395,19 @@ ac_vk_update_descriptor(
         descriptor->range == AC_WHOLE_SIZE ? VK_WHOLE_SIZE : descriptor->range;
     }
 
-    write.pBufferInfo = buffer_descriptors;
+    write->pBufferInfo = buffer_descriptors;
     break;
   }
   case ac_descriptor_type_srv_image:
   case ac_descriptor_type_uav_image:
   {
-    image_descriptors = ac_calloc(sizeof(VkDescriptorImageInfo) * info->count);
+    VkDescriptorImageInfo* image_descriptors = &scratch->images[index];
 
-    for (uint32_t j = 0; j < info->count; ++j)
+    for (uint32_t j = 0; j < count; ++j)
     {
-      const ac_descriptor* descriptor = &info->descriptors[j];
+      const ac_descriptor* descriptor = &info->descriptors[first + j];
+
+      image_descriptors[j] = (VkDescriptorImageInfo) {0};
 
       if (!descriptor->image)
       {
@@ -2850,16 +3433,18 @@ ac_vk_update_descriptor(
       }
     }
 
-    write.pImageInfo = image_descriptors;
+    write->pImageInfo = image_descriptors;
     break;
   }
   case ac_descriptor_type_sampler:
   {
-    image_descriptors = ac_calloc(sizeof(VkDescriptorImageInfo) * info->count);
+    VkDescriptorImageInfo* image_descriptors = &scratch->images[index];
 
-    for (uint32_t j = 0; j < info->count; ++j)
+    for (uint32_t j = 0; j < count; ++j)
     {
-      const ac_descriptor* descriptor = &info->descriptors[j];
+      const ac_descriptor* descriptor = &info->descriptors[first + j];
+
+      image_descriptors[j] = (VkDescriptorImageInfo) {0};
 
       if (!descriptor->sampler)
       {
@@ -2870,19 +3455,18 @@ ac_vk_update_descriptor(
       image_descriptors[j].sampler = sampler->sampler;
     }
 
-    write.pImageInfo = image_descriptors;
+    write->pImageInfo = image_descriptors;
     break;
   }
   case ac_descriptor_type_as:
   {
-    acceleration_structures =
-      ac_calloc(sizeof(VkAccelerationStructureKHR) * info->count);
+    VkAccelerationStructureKHR* acceleration_structures = &scratch->as[index];
 
-    acceleration_write.pAccelerationStructures = acceleration_structures;
-
-    for (uint32_t j = 0; j < info->count; ++j)
+    for (uint32_t j = 0; j < count; ++j)
     {
-      const ac_descriptor* descriptor = &info->descriptors[j];
+      const ac_descriptor* descriptor = &info->descriptors[first + j];
+
+      acceleration_structures[j] = VK_NULL_HANDLE;
 
       if (!descriptor->as)
       {
@@ -2894,7 +3478,17 @@ ac_vk_update_descriptor(
       acceleration_structures[j] = as->as;
     }
 
-    write.pNext = &acceleration_write;
+    VkWriteDescriptorSetAccelerationStructureKHR* acceleration_write =
+      &scratch->as_writes[scratch->write_count];
+
+    *acceleration_write = (VkWriteDescriptorSetAccelerationStructureKHR) {
+      .sType =
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR,
+      .accelerationStructureCount = count,
+      .pAccelerationStructures = acceleration_structures,
+    };
+
+    write->pNext = acceleration_write;
     break;
   }
   default:
@@ -2904,11 +3498,199 @@ ac_vk_update_descriptor(
   }
   }
 
-  device->vkUpdateDescriptorSets(device->device, 1, &write, 0, NULL);
+  scratch->write_count++;
+  scratch->info_count += count;
+}
+
+static void
+ac_vk_write_descriptors(
+  ac_vk_device*              device,
+  uint8_t*                   dst,
+  const ac_descriptor_write* info)
+{
+  size_t descriptor_size = device->descriptor_sizes[info->type];
+
+  dst += info->index * descriptor_size;
+
+  VkDescriptorGetInfoEXT get_info = {
+    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+    .type = ac_descriptor_type_to_vk(info->type),
+  };
+
+  for (uint32_t j = 0; j < info->count; ++j, dst += descriptor_size)
+  {
+    const ac_descriptor* descriptor = &info->descriptors[j];
+
+    VkDescriptorAddressInfoEXT address_info;
+    VkDescriptorImageInfo      image_info;
+
+    switch (info->type)
+    {
+    case ac_descriptor_type_cbv_buffer:
+    case ac_descriptor_type_srv_buffer:
+    case ac_descriptor_type_uav_buffer:
+    {
+      if (!descriptor->buffer)
+      {
+        continue;
+      }
+
+      AC_FROM_HANDLE2(buffer, descriptor->buffer, ac_vk_buffer);
+
+      address_info = (VkDescriptorAddressInfoEXT) {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+        .address = buffer->address + descriptor->offset,
+        .range = descriptor->range == AC_WHOLE_SIZE
+                   ? buffer->common.size - descriptor->offset
+                   : descriptor->range,
+      };
+
+      if (info->type == ac_descriptor_type_cbv_buffer)
+      {
+        get_info.data.pUniformBuffer = &address_info;
+      }
+      else
+      {
+        get_info.data.pStorageBuffer = &address_info;
+      }
+      break;
+    }
+    case ac_descriptor_type_srv_image:
+    case ac_descriptor_type_uav_image:
+    {
+      if (!descriptor->image)
+      {
+        continue;
+      }
+
+      AC_FROM_HANDLE2(image, descriptor->image, ac_vk_image);
+
+      AC_ASSERT(descriptor->level < descriptor->image->levels);
+
+      if (info->type == ac_descriptor_type_srv_image)
+      {
+        image_info = (VkDescriptorImageInfo) {
+          .imageView = image->srv_view,
+          .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        };
+        get_info.data.pSampledImage = &image_info;
+      }
+      else
+      {
+        AC_ASSERT(image->common.usage & ac_image_usage_uav_bit);
+        AC_ASSERT(image->uav_views);
+        image_info = (VkDescriptorImageInfo) {
+          .imageView = image->uav_views[descriptor->level],
+          .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        };
+        get_info.data.pStorageImage = &image_info;
+      }
+      break;
+    }
+    case ac_descriptor_type_sampler:
+    {
+      if (!descriptor->sampler)
+      {
+        continue;
+      }
+
+      AC_FROM_HANDLE2(sampler, descriptor->sampler, ac_vk_sampler);
+      get_info.data.pSampler = &sampler->sampler;
+      break;
+    }
+    case ac_descriptor_type_as:
+    {
+      if (!descriptor->as)
+      {
+        continue;
+      }
+
+      AC_FROM_HANDLE2(as, descriptor->as, ac_vk_as);
+      get_info.data.accelerationStructure =
+        ac_vk_get_as_address(device, as->as);
+      break;
+    }
+    default:
+    {
+      AC_ASSERT(false);
+      continue;
+    }
+    }
+
+    device->vkGetDescriptorEXT(device->device, &get_info, descriptor_size, dst);
+  }
+}
+
+static void
+ac_vk_update_set(
+  ac_device                  device_handle,
+  ac_descriptor_buffer       db_handle,
+  ac_space                   space,
+  uint32_t                   set,
+  uint32_t                   count,
+  const ac_descriptor_write* writes)
+{
+  AC_FROM_HANDLE(device, ac_vk_device);
+  AC_FROM_HANDLE(db, ac_vk_descriptor_buffer);
+
+  if (device->descriptor_buffer)
+  {
+    uint8_t* dst =
+      db->mapped + db->space_offsets[space] + db->set_strides[space] * set;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      const ac_descriptor_write* info = &writes[i];
+
+      uint32_t binding = ac_shader_compiler_get_shader_binding_index(
+        (ac_shader_descriptor_type)info->type,
+        info->reg);
+
+      ac_vk_write_descriptors(
+        device,
+        dst + ac_vk_find_binding_offset(db->binding_offsets[space], binding),
+        info);
+    }
+
+    return;
+  }
+
+  VkDescriptorSet descriptor_set = db->sets[space][set];
+
+  ac_vk_descriptor_writes scratch;
+  scratch.write_count = 0;
+  scratch.info_count = 0;
 
-  ac_free(buffer_descriptors);
-  ac_free(image_descriptors);
-  ac_free(acceleration_structures);
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    const ac_descriptor_write* info = &writes[i];
+
+    // big writes are split across several vulkan writes
+    uint32_t first = 0;
+    while (first < info->count)
+    {
+      if (
+        scratch.write_count == AC_VK_MAX_DESCRIPTOR_WRITES ||
+        scratch.info_count == AC_VK_MAX_DESCRIPTOR_INFOS)
+      {
+        ac_vk_flush_descriptor_writes(device, &scratch);
+      }
+
+      uint32_t available = AC_VK_MAX_DESCRIPTOR_INFOS - scratch.info_count;
+      uint32_t chunk = AC_MIN(info->count - first, available);
+
+      ac_vk_push_descriptor_write(
+        &scratch,
+        descriptor_set,
+        info,
+        first,
+        chunk);
+
+      first += chunk;
+    }
+  }
+
+  ac_vk_flush_descriptor_writes(device, &scratch);
 }
 
 static ac_result
@@ -3395,8 +4177,10 @@ ac_vk_cmd_end_rendering(ac_cmd cmd_handle)
 }
 
 static void
-ac_vk_cmd_barrier(
+ac_vk_cmd_dependency(
   ac_cmd                   cmd_handle,
+  ac_vk_dependency_op      op,
+  ac_event                 event_handle,
   uint32_t                 buffer_barrier_count,
   const ac_buffer_barrier* buffer_barriers,
   uint32_t                 image_barrier_count,
@@ -3405,20 +4189,11 @@ ac_vk_cmd_barrier(
   AC_FROM_HANDLE2(device, cmd_handle->device, ac_vk_device);
   AC_FROM_HANDLE(cmd, ac_vk_cmd);
 
-  VkBufferMemoryBarrier2* buffer_memory_barriers = NULL;
-  VkImageMemoryBarrier2*  image_memory_barriers = NULL;
-
-  if (buffer_barrier_count)
-  {
-    buffer_memory_barriers =
-      ac_alloc(buffer_barrier_count * sizeof(VkBufferMemoryBarrier2));
-  }
+  array_resize(cmd->buffer_barriers, buffer_barrier_count);
+  array_resize(cmd->image_barriers, image_barrier_count);
 
-  if (image_barrier_count)
-  {
-    image_memory_barriers =
-      ac_alloc(image_barrier_count * sizeof(VkImageMemoryBarrier2));
-  }
+  VkBufferMemoryBarrier2* buffer_memory_barriers = cmd->buffer_barriers;
+  VkImageMemoryBarrier2*  image_memory_barriers = cmd->image_barriers;
 
   for (uint32_t i = 0; i < buffer_barrier_count; ++i)
   {
@@ -3524,10 +4299,92 @@ ac_vk_cmd_barrier(
     .pImageMemoryBarriers = image_memory_barriers,
   };
 
-  device->vkCmdPipelineBarrier2(cmd->cmd, &dep_info);
+  switch (op)
+  {
+  case ac_vk_dependency_op_barrier:
+  {
+    device->vkCmdPipelineBarrier2(cmd->cmd, &dep_info);
+    break;
+  }
+  case ac_vk_dependency_op_set_event:
+  {
+    AC_FROM_HANDLE(event, ac_vk_event);
+    device->vkCmdSetEvent2(cmd->cmd, event->event, &dep_info);
+    break;
+  }
+  case ac_vk_dependency_op_wait_event:
+  {
+    AC_FROM_HANDLE(event, ac_vk_event);
+    device->vkCmdWaitEvents2(cmd->cmd, 1, &event->event, &dep_info);
+    // reset waits for everything before it, so it never races the wait
+    device->vkCmdResetEvent2(
+      cmd->cmd,
+      event->event,
+      VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+    break;
+  }
+  default:
+  {
+    AC_ASSERT(0);
+    break;
+  }
+  }
+}
 
-  ac_free(buffer_memory_barriers);
-  ac_free(image_memory_barriers);
+static void
+ac_vk_cmd_barrier(
+  ac_cmd                   cmd_handle,
+  uint32_t                 buffer_barrier_count,
+  const ac_buffer_barrier* buffer_barriers,
+  uint32_t                 image_barrier_count,
+  const ac_image_barrier*  image_barriers)
+{
+  ac_vk_cmd_dependency(
+    cmd_handle,
+    ac_vk_dependency_op_barrier,
+    NULL,
+    buffer_barrier_count,
+    buffer_barriers,
+    image_barrier_count,
+    image_barriers);
+}
+
+static void
+ac_vk_cmd_set_event(
+  ac_cmd                   cmd_handle,
+  ac_event                 event_handle,
+  uint32_t                 buffer_barrier_count,
+  const ac_buffer_barrier* buffer_barriers,
+  uint32_t                 image_barrier_count,
+  const ac_image_barrier*  image_barriers)
+{
+  ac_vk_cmd_dependency(
+    cmd_handle,
+    ac_vk_dependency_op_set_event,
+    event_handle,
+    buffer_barrier_count,
+    buffer_barriers,
+    image_barrier_count,
+    image_barriers);
+}
+
+static void
+ac_vk_cmd_wait_event(
+  ac_cmd                   cmd_handle,
+  ac_event                 event_handle,
+  uint32_t                 buffer_barrier_count,
+  const ac_buffer_barrier* buffer_barriers,
+  uint32_t                 image_barrier_count,
+  const ac_image_barrier*  image_barriers)
+{
+  ac_vk_cmd_dependency(
+    cmd_handle,
+    ac_vk_dependency_op_wait_event,
+    event_handle,
+    buffer_barrier_count,
+    buffer_barriers,
+    image_barrier_count,
+    image_barriers);
 }
 
 static void
@@ -3948,6 +4805,59 @@ ac_vk_cmd_bind_set(
   AC_FROM_HANDLE2(pipeline, cmd_handle->pipeline, ac_vk_pipeline);
   AC_FROM_HANDLE(db, ac_vk_descriptor_buffer);
 
+  if (device->descriptor_buffer)
+  {
+    uint32_t buffer_index = 0;
+    while (
+      buffer_index < cmd->descriptor_buffer_count &&
+      cmd->descriptor_buffers[buffer_index] != db->address)
+    {
+      ++buffer_index;
+    }
+
+    if (buffer_index == cmd->descriptor_buffer_count)
+    {
+      if (buffer_index == device->max_descriptor_buffers)
+      {
+        buffer_index = 0;
+        cmd->descriptor_buffer_count = 0;
+      }
+
+      cmd->descriptor_buffers[cmd->descriptor_buffer_count++] = db->address;
+
+      // already bound buffers keep their indices, so offsets set for other
+      // spaces stay valid
+      VkDescriptorBufferBindingInfoEXT binding_infos[ac_space_count];
+      for (uint32_t i = 0; i < cmd->descriptor_buffer_count; ++i)
+      {
+        binding_infos[i] = (VkDescriptorBufferBindingInfoEXT) {
+          .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+          .address = cmd->descriptor_buffers[i],
+          .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+                   VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT,
+        };
+      }
+
+      device->vkCmdBindDescriptorBuffersEXT(
+        cmd->cmd,
+        cmd->descriptor_buffer_count,
+        binding_infos);
+    }
+
+    VkDeviceSize offset =
+      db->space_offsets[space] + db->set_strides[space] * set;
+
+    device->vkCmdSetDescriptorBufferOffsetsEXT(
+      cmd->cmd,
+      ac_pipeline_type_to_vk_bind_point(pipeline->common.type),
+      pipeline->pipeline_layout,
+      (uint32_t)space,
+      1,
+      &buffer_index,
+      &offset);
+    return;
+  }
+
   device->vkCmdBindDescriptorSets(
     cmd->cmd,
     ac_pipeline_type_to_vk_bind_point(pipeline->common.type),
@@ -4059,6 +4969,8 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
   device->common.queue_present = ac_vk_queue_present;
   device->common.create_fence = ac_vk_create_fence;
   device->common.destroy_fence = ac_vk_destroy_fence;
+  device->common.create_event = ac_vk_create_event;
+  device->common.destroy_event = ac_vk_destroy_event;
   device->common.get_fence_value = ac_vk_get_fence_value;
   device->common.signal_fence = ac_vk_signal_fence;
   device->common.wait_fence = ac_vk_wait_fence;
@@ -4091,7 +5003,13 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
   device->common.destroy_sampler = ac_vk_destroy_sampler;
   device->common.create_image = ac_vk_create_image;
   device->common.destroy_image = ac_vk_destroy_image;
-  device->common.update_descriptor = ac_vk_update_descriptor;
+  device->common.create_memory = ac_vk_create_memory;
+  device->common.destroy_memory = ac_vk_destroy_memory;
+  device->common.get_image_memory_requirements =
+    ac_vk_get_image_memory_requirements;
+  device->common.get_buffer_memory_requirements =
+    ac_vk_get_buffer_memory_requirements;
+  device->common.update_set = ac_vk_update_set;
   device->common.create_sbt = ac_vk_create_sbt;
   device->common.destroy_sbt = ac_vk_destroy_sbt;
   device->common.create_blas = ac_vk_create_blas;
@@ -4101,6 +5019,8 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
   device->common.cmd_begin_rendering = ac_vk_cmd_begin_rendering;
   device->common.cmd_end_rendering = ac_vk_cmd_end_rendering;
   device->common.cmd_barrier = ac_vk_cmd_barrier;
+  device->common.cmd_set_event = ac_vk_cmd_set_event;
+  device->common.cmd_wait_event = ac_vk_cmd_wait_event;
   device->common.cmd_set_scissor = ac_vk_cmd_set_scissor;
   device->common.cmd_set_viewport = ac_vk_cmd_set_viewport;
   device->common.cmd_bind_pipeline = ac_vk_cmd_bind_pipeline;
@@ -4508,15 +5428,31 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
     .pNext = &vk_12,
   };
 
+  VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer = {
+    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+    .pNext = &vk_13,
+  };
+
   VkPhysicalDeviceFeatures2 features = {
     .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-    .pNext = &vk_13,
+    .pNext = &descriptor_buffer,
   };
 
   {
+    VkPhysicalDeviceIDProperties id_props = {
+      .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+    };
+
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT db_props = {
+      .sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+      .pNext = &id_props,
+    };
+
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR rt_props = {
       .sType =
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR,
+      .pNext = &db_props,
     };
 
     VkPhysicalDeviceProperties2 props = {
@@ -4527,6 +5463,20 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
     device->vkGetPhysicalDeviceProperties2(device->gpu, &props);
     device->vkGetPhysicalDeviceFeatures2(device->gpu, &features);
 
+    ac_vk_pipeline_cache_header* cache_header = &device->pipeline_cache_header;
+    cache_header->magic = AC_VK_PIPELINE_CACHE_MAGIC;
+    cache_header->vendor_id = props.properties.vendorID;
+    cache_header->device_id = props.properties.deviceID;
+    cache_header->driver_version = props.properties.driverVersion;
+    memcpy(
+      cache_header->device_uuid,
+      id_props.deviceUUID,
+      sizeof(cache_header->device_uuid));
+    memcpy(
+      cache_header->pipeline_cache_uuid,
+      props.properties.pipelineCacheUUID,
+      sizeof(cache_header->pipeline_cache_uuid));
+
     device->common.props.api = "Vulkan";
     device->common.props.max_sample_count = 4;
     device->common.props.cbv_buffer_alignment =
@@ -4546,6 +5496,38 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
     device->shader_group_base_alignment = rt_props.shaderGroupBaseAlignment;
     device->shader_group_handle_alignment = rt_props.shaderGroupHandleAlignment;
     device->shader_group_handle_size = rt_props.shaderGroupHandleSize;
+
+    // descriptor sets and descriptor buffers can't be mixed, so only the
+    // main feature is enabled and every set goes through buffer memory
+    device->descriptor_buffer =
+      descriptor_buffer.descriptorBuffer && vk_12.bufferDeviceAddress;
+    descriptor_buffer.descriptorBufferCaptureReplay = VK_FALSE;
+    descriptor_buffer.descriptorBufferImageLayoutIgnored = VK_FALSE;
+    descriptor_buffer.descriptorBufferPushDescriptors = VK_FALSE;
+
+    device->descriptor_buffer_alignment =
+      db_props.descriptorBufferOffsetAlignment;
+    device->max_descriptor_buffers = AC_MIN(
+      AC_MIN(
+        db_props.maxResourceDescriptorBufferBindings,
+        db_props.maxSamplerDescriptorBufferBindings),
+      ac_space_count);
+
+    bool robust = features.features.robustBufferAccess;
+
+    size_t* sizes = device->descriptor_sizes;
+    sizes[ac_descriptor_type_sampler] = db_props.samplerDescriptorSize;
+    sizes[ac_descriptor_type_srv_image] = db_props.sampledImageDescriptorSize;
+    sizes[ac_descriptor_type_uav_image] = db_props.storageImageDescriptorSize;
+    sizes[ac_descriptor_type_cbv_buffer] =
+      robust ? db_props.robustUniformBufferDescriptorSize
+             : db_props.uniformBufferDescriptorSize;
+    sizes[ac_descriptor_type_srv_buffer] =
+      robust ? db_props.robustStorageBufferDescriptorSize
+             : db_props.storageBufferDescriptorSize;
+    sizes[ac_descriptor_type_uav_buffer] = sizes[ac_descriptor_type_srv_buffer];
+    sizes[ac_descriptor_type_as] =
+      db_props.accelerationStructureDescriptorSize;
   }
 
   // TODO: check features
@@ -4587,6 +5569,10 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
     VK_EXT_MESH_SHADER_EXTENSION_NAME,
   };
 
+  const char* descriptor_buffer_extensions[] = {
+    VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME,
+  };
+
   const char* raytracing_extensions[] = {
     VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
     VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
@@ -4652,6 +5638,27 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
     }
   }
 
+  if (device->descriptor_buffer)
+  {
+    if (ac_vk_is_extensions_supported(
+          supported_extensions,
+          supported_extension_count,
+          descriptor_buffer_extensions,
+          AC_COUNTOF(descriptor_buffer_extensions)))
+    {
+      array_append(device_extensions, descriptor_buffer_extensions[0]);
+    }
+    else
+    {
+      device->descriptor_buffer = false;
+    }
+  }
+
+  if (!device->descriptor_buffer)
+  {
+    features.pNext = descriptor_buffer.pNext;
+  }
+
   ac_free(supported_extensions);
 
   uint32_t                queue_family_create_count = 0;
@@ -4792,6 +5799,18 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
 
   ac_vk_load_device_functions(device);
 
+  device->common.support_placed_resources =
+    device->vkGetDeviceImageMemoryRequirements &&
+    device->vkGetDeviceBufferMemoryRequirements;
+
+  device->common.support_bindless =
+    vk_12.descriptorBindingPartiallyBound &&
+    (device->descriptor_buffer ||
+     (vk_12.descriptorBindingUpdateUnusedWhilePending &&
+      vk_12.descriptorBindingSampledImageUpdateAfterBind &&
+      vk_12.descriptorBindingStorageImageUpdateAfterBind &&
+      vk_12.descriptorBindingStorageBufferUpdateAfterBind));
+
   VmaVulkanFunctions vulkan_functions = {
     .vkAllocateMemory = device->vkAllocateMemory,
     .vkBindBufferMemory = device->vkBindBufferMemory,
@@ -4833,7 +5852,7 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
     .vulkanApiVersion = app_info.apiVersion,
   };
 
-  if (device->common.support_raytracing)
+  if (device->common.support_raytracing || device->descriptor_buffer)
   {
     vma_allocator_create_info.flags |=
       VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
@@ -4849,6 +5868,8 @@ ac_vk_create_device(const ac_device_info* info, ac_device* device_handle)
     device->vkGetDeviceQueue(device->device, queue->family, 0, &queue->queue);
   }
 
+  ac_vk_create_pipeline_cache(device);
+
   return ac_result_success;
 }
 
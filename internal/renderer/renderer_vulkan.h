@@ -17,6 +17,19 @@
 #define AC_VK_SET_OBJECT_NAME(device, name, type, object) ((void)0)
 #endif
 
+// written before vulkan cache data, drivers validate their own header
+// differently, so make sure data comes from the same device and driver
+typedef struct ac_vk_pipeline_cache_header {
+  uint32_t magic;
+  uint32_t vendor_id;
+  uint32_t device_id;
+  uint32_t driver_version;
+  uint8_t  device_uuid[VK_UUID_SIZE];
+  uint8_t  pipeline_cache_uuid[VK_UUID_SIZE];
+  uint64_t data_size;
+  uint64_t data_hash;
+} ac_vk_pipeline_cache_header;
+
 typedef struct ac_vk_device {
   ac_device_internal       common;
   VkAllocationCallbacks    cpu_allocator;
@@ -30,6 +43,13 @@ typedef struct ac_vk_device {
   uint32_t                 shader_group_handle_alignment;
   uint32_t                 shader_group_handle_size;
   RENDERDOC_API_1_6_0*     rdoc;
+  VkPipelineCache          pipeline_cache;
+  bool                     descriptor_buffer;
+  VkDeviceSize             descriptor_buffer_alignment;
+  uint32_t                 max_descriptor_buffers;
+  size_t                   descriptor_sizes[AC_DESCRIPTOR_TYPE_COUNT];
+
+  ac_vk_pipeline_cache_header pipeline_cache_header;
 
   void*                                    vk;
   PFN_vkGetInstanceProcAddr                vkGetInstanceProcAddr;
@@ -42,6 +62,7 @@ typedef struct ac_vk_device {
   PFN_vkCreateDebugUtilsMessengerEXT       vkCreateDebugUtilsMessengerEXT;
   PFN_vkCreateDevice                       vkCreateDevice;
   PFN_vkCreateSemaphore                    vkCreateSemaphore;
+  PFN_vkCreateEvent                        vkCreateEvent;
   PFN_vkCreatePipelineLayout               vkCreatePipelineLayout;
   PFN_vkCreateSwapchainKHR                 vkCreateSwapchainKHR;
   PFN_vkCreateImageView                    vkCreateImageView;
@@ -52,6 +73,15 @@ typedef struct ac_vk_device {
   PFN_vkCreateComputePipelines             vkCreateComputePipelines;
   PFN_vkCreateRayTracingPipelinesKHR       vkCreateRayTracingPipelinesKHR;
   PFN_vkCreateGraphicsPipelines            vkCreateGraphicsPipelines;
+  PFN_vkCreatePipelineCache                vkCreatePipelineCache;
+  PFN_vkDestroyPipelineCache               vkDestroyPipelineCache;
+  PFN_vkGetPipelineCacheData               vkGetPipelineCacheData;
+  PFN_vkGetDescriptorSetLayoutSizeEXT      vkGetDescriptorSetLayoutSizeEXT;
+  PFN_vkGetDescriptorEXT                   vkGetDescriptorEXT;
+  PFN_vkCmdBindDescriptorBuffersEXT        vkCmdBindDescriptorBuffersEXT;
+  PFN_vkCmdSetDescriptorBufferOffsetsEXT   vkCmdSetDescriptorBufferOffsetsEXT;
+  PFN_vkGetDescriptorSetLayoutBindingOffsetEXT
+    vkGetDescriptorSetLayoutBindingOffsetEXT;
   PFN_vkCreateSampler                      vkCreateSampler;
   PFN_vkCreateAccelerationStructureKHR     vkCreateAccelerationStructureKHR;
   PFN_vkGetDeviceQueue                     vkGetDeviceQueue;
@@ -74,6 +104,9 @@ typedef struct ac_vk_device {
   PFN_vkCmdBeginRendering                  vkCmdBeginRendering;
   PFN_vkCmdEndRendering                    vkCmdEndRendering;
   PFN_vkCmdPipelineBarrier2                vkCmdPipelineBarrier2;
+  PFN_vkCmdSetEvent2                       vkCmdSetEvent2;
+  PFN_vkCmdWaitEvents2                     vkCmdWaitEvents2;
+  PFN_vkCmdResetEvent2                     vkCmdResetEvent2;
   PFN_vkCmdSetScissor                      vkCmdSetScissor;
   PFN_vkCmdSetViewport                     vkCmdSetViewport;
   PFN_vkCmdBindPipeline                    vkCmdBindPipeline;
@@ -103,6 +136,7 @@ typedef struct ac_vk_device {
   PFN_vkDestroySwapchainKHR                vkDestroySwapchainKHR;
   PFN_vkDestroySurfaceKHR                  vkDestroySurfaceKHR;
   PFN_vkDestroySemaphore                   vkDestroySemaphore;
+  PFN_vkDestroyEvent                       vkDestroyEvent;
   PFN_vkDestroyDevice                      vkDestroyDevice;
   PFN_vkDestroyInstance                    vkDestroyInstance;
   PFN_vkDestroyDebugUtilsMessengerEXT      vkDestroyDebugUtilsMessengerEXT;
@@ -159,12 +193,22 @@ typedef struct ac_vk_cmd_pool {
 typedef struct ac_vk_cmd {
   ac_cmd_internal common;
   VkCommandBuffer cmd;
+  uint32_t        descriptor_buffer_count;
+  VkDeviceAddress descriptor_buffers[ac_space_count];
+  // barrier translation storage, keeps capacity between recordings
+  array_t(VkBufferMemoryBarrier2) buffer_barriers;
+  array_t(VkImageMemoryBarrier2) image_barriers;
 } ac_vk_cmd;
 
 typedef struct ac_vk_queue {
   ac_queue_internal common;
   uint32_t          family;
   VkQueue           queue;
+  // scratch storage reused between submits, guarded by queue mutex
+  array_t(VkSemaphoreSubmitInfo) wait_semaphores;
+  array_t(VkSemaphoreSubmitInfo) signal_semaphores;
+  array_t(VkCommandBufferSubmitInfo) cmds;
+  array_t(VkSemaphore) present_semaphores;
 } ac_vk_queue;
 
 typedef struct ac_vk_fence {
@@ -173,6 +217,17 @@ typedef struct ac_vk_fence {
   bool              signaled;
 } ac_vk_fence;
 
+typedef struct ac_vk_event {
+  ac_event_internal common;
+  VkEvent           event;
+} ac_vk_event;
+
+typedef enum ac_vk_dependency_op {
+  ac_vk_dependency_op_barrier = 0,
+  ac_vk_dependency_op_set_event = 1,
+  ac_vk_dependency_op_wait_event = 2,
+} ac_vk_dependency_op;
+
 typedef struct ac_vk_sampler {
   ac_sampler_internal common;
   VkSampler           sampler;
@@ -190,8 +245,14 @@ typedef struct ac_vk_buffer {
   ac_buffer_internal common;
   VkBuffer           buffer;
   VmaAllocation      allocation;
+  VkDeviceAddress    address;
 } ac_vk_buffer;
 
+typedef struct ac_vk_memory {
+  ac_memory_internal common;
+  VmaAllocation      allocation;
+} ac_vk_memory;
+
 typedef struct ac_vk_swapchain {
   ac_swapchain_internal common;
   VkSurfaceKHR          surface;
@@ -203,17 +264,49 @@ typedef struct ac_vk_shader {
   VkShaderModule     shader;
 } ac_vk_shader;
 
+typedef struct ac_vk_binding_offset {
+  uint32_t     binding;
+  VkDeviceSize offset;
+} ac_vk_binding_offset;
+
 typedef struct ac_vk_dsl {
   ac_dsl_internal       common;
   VkDescriptorSetLayout dsls[ac_space_count];
+  // filled only with VK_EXT_descriptor_buffer
+  VkDeviceSize          sizes[ac_space_count];
+  array_t(ac_vk_binding_offset) offsets[ac_space_count];
 } ac_vk_dsl;
 
 typedef struct ac_vk_descriptor_buffer {
   ac_descriptor_buffer_internal common;
   VkDescriptorPool              descriptor_pool;
   VkDescriptorSet*              sets[ac_space_count];
+  // VK_EXT_descriptor_buffer path, sets are written straight to memory
+  VkBuffer                      buffer;
+  VmaAllocation                 allocation;
+  uint8_t*                      mapped;
+  VkDeviceAddress               address;
+  VkDeviceSize                  space_offsets[ac_space_count];
+  VkDeviceSize                  set_strides[ac_space_count];
+  array_t(ac_vk_binding_offset) binding_offsets[ac_space_count];
 } ac_vk_descriptor_buffer;
 
+#define AC_VK_MAX_DESCRIPTOR_WRITES 32
+#define AC_VK_MAX_DESCRIPTOR_INFOS 128
+
+// stack scratch for ac_vk_update_set, flushed to vkUpdateDescriptorSets
+// whenever writes or descriptor infos run out
+typedef struct ac_vk_descriptor_writes {
+  uint32_t             write_count;
+  uint32_t             info_count;
+  VkWriteDescriptorSet writes[AC_VK_MAX_DESCRIPTOR_WRITES];
+  VkWriteDescriptorSetAccelerationStructureKHR
+                             as_writes[AC_VK_MAX_DESCRIPTOR_WRITES];
+  VkDescriptorBufferInfo     buffers[AC_VK_MAX_DESCRIPTOR_INFOS];
+  VkDescriptorImageInfo      images[AC_VK_MAX_DESCRIPTOR_INFOS];
+  VkAccelerationStructureKHR as[AC_VK_MAX_DESCRIPTOR_INFOS];
+} ac_vk_descriptor_writes;
+
 typedef struct ac_vk_pipeline {
   ac_pipeline_internal common;
   VkPipeline           pipeline;
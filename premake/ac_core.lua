@@ -16,6 +16,8 @@ project("ac-core")
     RD .. "include/*",
     RD .. "internal/ac_private.h",
     RD .. "internal/core/core.c",
+    RD .. "internal/core/allocator.c",
+    RD .. "internal/core/job.c",
     RD .. "internal/core/memory_manager.c",
     RD .. "internal/core/memory_manager.h",
     RD .. "internal/core/log.c",
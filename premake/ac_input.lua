@@ -7,6 +7,8 @@ project("ac-input")
 
   uuid("b5d11330-999c-11ee-9ec1-0800200c9a66")
 
+  defines({ "AC_MEMORY_TAG=ac_memory_tag_input" })
+
   files({
     RD .. "external/c_array/c_array.h",
     RD .. "external/c_hashmap/c_hashmap.h",
@@ -17,6 +17,8 @@ project("ac-render-graph")
 
   dependson("ac-render-graph-shaders")
 
+  defines({ "AC_MEMORY_TAG=ac_memory_tag_render_graph" })
+
   files({
     RD .. "external/c_array/c_array.h",
     RD .. "external/c_hashmap/c_hashmap.h",
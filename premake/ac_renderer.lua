@@ -7,6 +7,8 @@ project("ac-renderer")
 
   uuid("e84fb8b0-730a-11ee-a565-0800200c9a66")
 
+  defines({ "AC_MEMORY_TAG=ac_memory_tag_renderer" })
+
   files({
     RD .. "external/c_array/c_array.h",
     RD .. "external/c_hashmap/c_hashmap.h",
@@ -0,0 +1,29 @@
+include("ac_common_settings")
+
+local RD = "../"
+
+project("ac-tests")
+  kind("ConsoleApp")
+
+  uuid("39cf26f2-caa2-11f1-aece-02fc00000001")
+
+  files({
+    RD .. "include/*",
+    RD .. "internal/ac_private.h",
+    RD .. "tests/tests.h",
+    RD .. "tests/tests.c",
+    RD .. "tests/core/test_allocator.c",
+    RD .. "tests/core/test_job.c",
+  })
+
+  includedirs({
+    RD .. "tests",
+  })
+
+  filter({ "system:linux" })
+    links({
+      "pthread",
+      "dl",
+      "m",
+    })
+  filter({})
@@ -7,6 +7,8 @@ project("ac-window")
 
   uuid("50d695f0-7312-11ee-a565-0800200c9a66")
 
+  defines({ "AC_MEMORY_TAG=ac_memory_tag_window" })
+
   files({
     RD .. "external/c_array/c_array.h",
     RD .. "external/c_hashmap/c_hashmap.h",
@@ -28,3 +28,4 @@ include("ac_renderer")
 include("ac_render_graph")
 include("ac_window")
 include("ac_input")
+include("ac_tests")
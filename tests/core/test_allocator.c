@@ -0,0 +1,287 @@
+#include "tests.h"
+
+static void
+ac_test_fill(void* p, size_t size, uint8_t value)
+{
+  memset(p, value, size);
+}
+
+static bool
+ac_test_check(const void* p, size_t size, uint8_t value)
+{
+  const uint8_t* bytes = p;
+  for (size_t i = 0; i < size; ++i)
+  {
+    if (bytes[i] != value)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+ac_test_arena(void)
+{
+  ac_arena arena;
+  AC_TEST_EXPECT(
+    ac_create_arena(&(ac_arena_info) {.size = 4096}, &arena) ==
+    ac_result_success);
+
+  uint8_t* a = ac_arena_alloc(arena, 3, 1);
+  uint8_t* b = ac_arena_alloc(arena, 100, 64);
+  uint8_t* c = ac_arena_alloc(arena, 8, 16);
+  AC_TEST_EXPECT(a && b && c);
+  AC_TEST_EXPECT(AC_TEST_IS_ALIGNED(b, 64));
+  AC_TEST_EXPECT(AC_TEST_IS_ALIGNED(c, 16));
+  AC_TEST_EXPECT(b >= a + 3 && c >= b + 100);
+
+  AC_TEST_EXPECT(ac_arena_alloc(arena, 8192, 1) == NULL);
+
+  ac_arena_reset(arena);
+  AC_TEST_EXPECT(ac_arena_alloc(arena, 3, 1) == a);
+
+  // last allocation grows in place and gives memory back on free
+  ac_arena_reset(arena);
+
+  ac_allocator allocator;
+  ac_arena_get_allocator(arena, &allocator);
+  ac_push_allocator(&allocator);
+
+  uint8_t* p = ac_alloc(64);
+  AC_TEST_EXPECT(p);
+  ac_test_fill(p, 64, 0xab);
+
+  uint8_t* q = ac_realloc(p, 256);
+  AC_TEST_EXPECT(q == p);
+  AC_TEST_EXPECT(ac_test_check(q, 64, 0xab));
+
+  ac_free(q);
+  AC_TEST_EXPECT(ac_alloc_tagged(4096, ac_memory_tag_core) == NULL);
+
+  uint8_t* r = ac_alloc(64);
+  AC_TEST_EXPECT(r == p);
+  ac_free(r);
+
+  ac_pop_allocator();
+  ac_destroy_arena(arena);
+
+  // arena placed into user memory
+  static uint8_t memory[1024];
+
+  AC_TEST_EXPECT(
+    ac_create_arena(
+      &(ac_arena_info) {.memory = memory, .size = sizeof(memory)},
+      &arena) == ac_result_success);
+
+  uint8_t* inside = ac_arena_alloc(arena, 64, 16);
+  AC_TEST_EXPECT(inside > memory && inside + 64 <= memory + sizeof(memory));
+  AC_TEST_EXPECT(ac_arena_alloc(arena, sizeof(memory), 1) == NULL);
+
+  ac_destroy_arena(arena);
+}
+
+void
+ac_test_pool(void)
+{
+  ac_pool pool;
+  AC_TEST_EXPECT(
+    ac_create_pool(
+      &(ac_pool_info) {
+        .size = 64 * (64 + AC_ALLOCATION_HEADER_SIZE),
+        .block_size = 64 + AC_ALLOCATION_HEADER_SIZE,
+      },
+      &pool) == ac_result_success);
+
+  void*    blocks[64];
+  uint32_t count = 0;
+  while (count < AC_COUNTOF(blocks))
+  {
+    void* block = ac_pool_alloc(pool);
+    if (!block)
+    {
+      break;
+    }
+    AC_TEST_EXPECT(AC_TEST_IS_ALIGNED(block, 16));
+    blocks[count++] = block;
+  }
+
+  // pool object is not taken out of size when pool owns its memory
+  AC_TEST_EXPECT(count == AC_COUNTOF(blocks));
+  AC_TEST_EXPECT(ac_pool_alloc(pool) == NULL);
+
+  for (uint32_t i = 1; i < count; ++i)
+  {
+    AC_TEST_EXPECT(blocks[i] != blocks[i - 1]);
+  }
+
+  ac_pool_free(pool, blocks[3]);
+  AC_TEST_EXPECT(ac_pool_alloc(pool) == blocks[3]);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    ac_pool_free(pool, blocks[i]);
+  }
+
+  ac_allocator allocator;
+  ac_pool_get_allocator(pool, &allocator);
+  ac_push_allocator(&allocator);
+
+  AC_TEST_EXPECT(ac_alloc(65) == NULL);
+  AC_TEST_EXPECT(ac_aligned_alloc(16, 64) == NULL);
+
+  uint8_t* p = ac_alloc(64);
+  AC_TEST_EXPECT(p);
+  ac_test_fill(p, 64, 0x5a);
+
+  // shrinking stays in block, growing past it fails and keeps original
+  AC_TEST_EXPECT(ac_realloc(p, 32) == p);
+  AC_TEST_EXPECT(ac_realloc(p, 200) == NULL);
+  AC_TEST_EXPECT(ac_test_check(p, 32, 0x5a));
+
+  ac_free(p);
+
+  ac_pop_allocator();
+  ac_destroy_pool(pool);
+}
+
+void
+ac_test_heap(void)
+{
+  static const size_t alignments[] = { 16, 32, 64, 128, 256 };
+
+  ac_heap heap;
+  AC_TEST_EXPECT(
+    ac_create_heap(&(ac_heap_info) {.size = 1 << 20}, &heap) ==
+    ac_result_success);
+
+  uint8_t* blocks[64];
+  size_t   sizes[AC_COUNTOF(blocks)];
+
+  for (uint32_t i = 0; i < AC_COUNTOF(blocks); ++i)
+  {
+    size_t alignment = alignments[i % AC_COUNTOF(alignments)];
+    sizes[i] = (i * 37) % 2000 + 1;
+    blocks[i] = ac_heap_alloc(heap, sizes[i], alignment);
+    AC_TEST_EXPECT(blocks[i]);
+    AC_TEST_EXPECT(AC_TEST_IS_ALIGNED(blocks[i], alignment));
+    ac_test_fill(blocks[i], sizes[i], (uint8_t)i);
+  }
+
+  for (uint32_t i = 0; i < AC_COUNTOF(blocks); i += 2)
+  {
+    ac_heap_free(heap, blocks[i]);
+  }
+
+  for (uint32_t i = 0; i < AC_COUNTOF(blocks); i += 2)
+  {
+    sizes[i] = (i * 53) % 3000 + 1;
+    blocks[i] = ac_heap_alloc(heap, sizes[i], 16);
+    AC_TEST_EXPECT(blocks[i]);
+    ac_test_fill(blocks[i], sizes[i], (uint8_t)i);
+  }
+
+  // growing keeps contents and alignment whether block moves or not
+  blocks[1] = ac_heap_realloc(heap, blocks[1], 10000, 32);
+  AC_TEST_EXPECT(AC_TEST_IS_ALIGNED(blocks[1], 32));
+  AC_TEST_EXPECT(ac_test_check(blocks[1], sizes[1], 1));
+  sizes[1] = 10000;
+  ac_test_fill(blocks[1], sizes[1], 1);
+
+  for (uint32_t i = 0; i < AC_COUNTOF(blocks); ++i)
+  {
+    AC_TEST_EXPECT(ac_test_check(blocks[i], sizes[i], (uint8_t)i));
+  }
+
+  for (uint32_t i = 0; i < AC_COUNTOF(blocks); ++i)
+  {
+    ac_heap_free(heap, blocks[(i * 7) % AC_COUNTOF(blocks)]);
+  }
+
+  // fits only when every freed block is coalesced back
+  void* big = ac_heap_alloc(heap, 900 * 1024, 16);
+  AC_TEST_EXPECT(big);
+  ac_heap_free(heap, big);
+
+  ac_destroy_heap(heap);
+}
+
+static void
+ac_test_aligned_realloc_with_current(void)
+{
+  static const size_t alignments[] = { 32, 64, 128, 4096 };
+
+  for (uint32_t i = 0; i < AC_COUNTOF(alignments); ++i)
+  {
+    size_t alignment = alignments[i];
+
+    uint8_t* p = ac_aligned_alloc(24, alignment);
+    AC_TEST_EXPECT(p && AC_TEST_IS_ALIGNED(p, alignment));
+    ac_test_fill(p, 24, (uint8_t)i);
+
+    for (size_t size = 100; size <= 100000; size *= 10)
+    {
+      p = ac_realloc(p, size);
+      AC_TEST_EXPECT(p && AC_TEST_IS_ALIGNED(p, alignment));
+      AC_TEST_EXPECT(ac_test_check(p, 24, (uint8_t)i));
+    }
+
+    ac_free(p);
+  }
+}
+
+void
+ac_test_aligned_realloc(void)
+{
+  ac_test_aligned_realloc_with_current();
+
+  ac_heap heap;
+  AC_TEST_EXPECT(
+    ac_create_heap(&(ac_heap_info) {.size = 1 << 20}, &heap) ==
+    ac_result_success);
+
+  ac_allocator allocator;
+  ac_heap_get_allocator(heap, &allocator);
+
+  ac_push_allocator(&allocator);
+  ac_test_aligned_realloc_with_current();
+  ac_pop_allocator();
+
+  ac_destroy_heap(heap);
+}
+
+void
+ac_test_memory_stats(void)
+{
+  ac_memory_tag tag = ac_memory_tag_user + 1;
+
+  ac_memory_stats before;
+  ac_get_memory_stats(&before);
+
+  void* p = ac_alloc_tagged(100, tag);
+  void* q = ac_calloc_tagged(50, tag);
+
+  ac_memory_stats stats;
+  ac_get_memory_stats(&stats);
+
+  ac_memory_tag_stats* a = &before.tags[tag];
+  ac_memory_tag_stats* b = &stats.tags[tag];
+  AC_TEST_EXPECT(b->live_bytes == a->live_bytes + 150);
+  AC_TEST_EXPECT(b->live_allocations == a->live_allocations + 2);
+  AC_TEST_EXPECT(b->total_allocations == a->total_allocations + 2);
+  AC_TEST_EXPECT(b->peak_bytes >= b->live_bytes);
+
+  // realloc keeps tag of allocation
+  p = ac_realloc_tagged(p, 300, ac_memory_tag_application);
+
+  ac_get_memory_stats(&stats);
+  AC_TEST_EXPECT(b->live_bytes == a->live_bytes + 350);
+  AC_TEST_EXPECT(b->peak_bytes >= a->live_bytes + 350);
+
+  ac_free(p);
+  ac_free(q);
+
+  ac_get_memory_stats(&stats);
+  AC_TEST_EXPECT(b->live_bytes == a->live_bytes);
+  AC_TEST_EXPECT(b->live_allocations == a->live_allocations);
+}
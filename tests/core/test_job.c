@@ -0,0 +1,201 @@
+#include "tests.h"
+
+#define AC_TEST_JOB_COUNT 1000
+#define AC_TEST_PARENT_COUNT 64
+#define AC_TEST_CHILD_COUNT 64
+#define AC_TEST_CHAIN_LENGTH 8
+
+typedef struct ac_test_job_state {
+  volatile int64_t value;
+  volatile int64_t order;
+} ac_test_job_state;
+
+static void
+ac_test_job_increment(void* data)
+{
+  ac_test_job_state* state = data;
+
+  AC_TEST_EXPECT(ac_job_get_thread_index() < ac_job_get_thread_count());
+
+  ac_atomic_add_i64(&state->value, 1);
+}
+
+void
+ac_test_job_run(void)
+{
+  AC_TEST_EXPECT(ac_job_get_thread_index() == 0);
+
+  ac_job_counter counter = {0};
+  AC_TEST_EXPECT(ac_job_is_complete(&counter));
+
+  // wait on complete counter returns right away
+  ac_job_wait(&counter);
+
+  static ac_job jobs[AC_TEST_JOB_COUNT];
+
+  ac_test_job_state state = {0};
+  for (uint32_t i = 0; i < AC_TEST_JOB_COUNT; ++i)
+  {
+    jobs[i] = (ac_job) {
+      .function = ac_test_job_increment,
+      .data = &state,
+    };
+  }
+
+  // one counter tracks jobs from several runs
+  ac_job_run(jobs, AC_TEST_JOB_COUNT / 2, &counter);
+  ac_job_run(jobs, AC_TEST_JOB_COUNT / 2, &counter);
+  ac_job_wait(&counter);
+
+  AC_TEST_EXPECT(ac_job_is_complete(&counter));
+  AC_TEST_EXPECT(ac_atomic_load_i64(&state.value) == AC_TEST_JOB_COUNT);
+}
+
+typedef struct ac_test_job_link {
+  ac_test_job_state* state;
+  ac_job_counter*    dependency;
+  int64_t            index;
+} ac_test_job_link;
+
+static void
+ac_test_job_link_function(void* data)
+{
+  ac_test_job_link* link = data;
+
+  if (link->dependency)
+  {
+    AC_TEST_EXPECT(ac_job_is_complete(link->dependency));
+  }
+
+  // links run strictly one after another
+  int64_t order = ac_atomic_add_i64(&link->state->order, 1);
+  AC_TEST_EXPECT(order == link->index + 1);
+}
+
+void
+ac_test_job_run_after(void)
+{
+  ac_test_job_state state = {0};
+  ac_job_counter    counters[AC_TEST_CHAIN_LENGTH];
+  ac_test_job_link  links[AC_TEST_CHAIN_LENGTH];
+  AC_ZERO(counters);
+
+  for (uint32_t i = 0; i < AC_TEST_CHAIN_LENGTH; ++i)
+  {
+    links[i] = (ac_test_job_link) {
+      .state = &state,
+      .dependency = i ? &counters[i - 1] : NULL,
+      .index = i,
+    };
+  }
+
+  ac_job job = {
+    .function = ac_test_job_increment,
+    .data = &state,
+  };
+
+  // first link is queued behind job which may still be running
+  ac_job_counter gate = {0};
+  ac_job_run(&job, 1, &gate);
+
+  for (uint32_t i = 0; i < AC_TEST_CHAIN_LENGTH; ++i)
+  {
+    ac_job link = {
+      .function = ac_test_job_link_function,
+      .data = &links[i],
+    };
+
+    AC_TEST_EXPECT(
+      ac_job_run_after(&link, 1, i ? &counters[i - 1] : &gate, &counters[i]) ==
+      ac_result_success);
+  }
+
+  ac_job_wait(&counters[AC_TEST_CHAIN_LENGTH - 1]);
+
+  for (uint32_t i = 0; i < AC_TEST_CHAIN_LENGTH; ++i)
+  {
+    AC_TEST_EXPECT(ac_job_is_complete(&counters[i]));
+  }
+  AC_TEST_EXPECT(ac_job_is_complete(&gate));
+  AC_TEST_EXPECT(ac_atomic_load_i64(&state.order) == AC_TEST_CHAIN_LENGTH);
+
+  // complete dependency queues jobs right away
+  ac_job_counter after = {0};
+  AC_TEST_EXPECT(
+    ac_job_run_after(&job, 1, &gate, &after) == ac_result_success);
+  ac_job_wait(&after);
+  AC_TEST_EXPECT(ac_atomic_load_i64(&state.value) == 2);
+
+  // so does missing one
+  AC_TEST_EXPECT(
+    ac_job_run_after(&job, 1, NULL, &after) == ac_result_success);
+  ac_job_wait(&after);
+  AC_TEST_EXPECT(ac_atomic_load_i64(&state.value) == 3);
+}
+
+static void
+ac_test_job_parent(void* data)
+{
+  ac_test_job_state* state = data;
+
+  ac_job jobs[AC_TEST_CHILD_COUNT];
+  for (uint32_t i = 0; i < AC_TEST_CHILD_COUNT; ++i)
+  {
+    jobs[i] = (ac_job) {
+      .function = ac_test_job_increment,
+      .data = state,
+    };
+  }
+
+  // on fiber wait yields, without free fiber it helps on thread stack
+  ac_job_counter counter = {0};
+  ac_job_run(jobs, AC_TEST_CHILD_COUNT, &counter);
+  ac_job_wait(&counter);
+
+  AC_TEST_EXPECT(ac_job_is_complete(&counter));
+}
+
+void
+ac_test_job_nested_wait(void)
+{
+  static ac_job jobs[AC_TEST_PARENT_COUNT];
+
+  ac_test_job_state state = {0};
+  for (uint32_t i = 0; i < AC_TEST_PARENT_COUNT; ++i)
+  {
+    jobs[i] = (ac_job) {
+      .function = ac_test_job_parent,
+      .data = &state,
+    };
+  }
+
+  ac_job_counter counter = {0};
+  ac_job_run(jobs, AC_TEST_PARENT_COUNT, &counter);
+  ac_job_wait(&counter);
+
+  AC_TEST_EXPECT(
+    ac_atomic_load_i64(&state.value) ==
+    AC_TEST_PARENT_COUNT * AC_TEST_CHILD_COUNT);
+}
+
+void
+ac_test_job_counter_reuse(void)
+{
+  ac_test_job_state state = {0};
+  ac_job_counter    counter = {0};
+
+  ac_job job = {
+    .function = ac_test_job_increment,
+    .data = &state,
+  };
+
+  // counter goes back to complete after every wait and can be run again
+  for (uint32_t i = 0; i < 100; ++i)
+  {
+    ac_job_run(&job, 1, &counter);
+    ac_job_wait(&counter);
+
+    AC_TEST_EXPECT(ac_job_is_complete(&counter));
+    AC_TEST_EXPECT(ac_atomic_load_i64(&state.value) == i + 1);
+  }
+}
@@ -0,0 +1,78 @@
+#include "tests.h"
+
+// less fibers than parent jobs in nested tests, so fallback to thread stack
+// is covered too
+#define AC_TESTS_JOB_FIBER_COUNT 8
+
+typedef void (*ac_test_function)(void);
+
+typedef struct ac_test {
+  const char*      name;
+  ac_test_function function;
+} ac_test;
+
+static const ac_test ac_tests[] = {
+  { "arena", ac_test_arena },
+  { "pool", ac_test_pool },
+  { "heap", ac_test_heap },
+  { "aligned realloc", ac_test_aligned_realloc },
+  { "memory stats", ac_test_memory_stats },
+  { "job run", ac_test_job_run },
+  { "job run after", ac_test_job_run_after },
+  { "job nested wait", ac_test_job_nested_wait },
+  { "job counter reuse", ac_test_job_counter_reuse },
+};
+
+static volatile int64_t ac_test_failures;
+
+void
+ac_test_fail(const char* expr, const char* file, uint32_t line)
+{
+  ac_atomic_add_i64(&ac_test_failures, 1);
+  AC_ERROR(
+    "[ tests ] expectation failed. expr: %s file: %s line: %u",
+    expr,
+    file,
+    line);
+}
+
+AC_API ac_result
+ac_main(uint32_t argc, char** argv)
+{
+  AC_UNUSED(argc);
+  AC_UNUSED(argv);
+
+  AC_RIF(ac_init(&(ac_init_info) {
+    .app_name = "ac-tests",
+    .enable_memory_manager = true,
+    .job_fiber_count = AC_TESTS_JOB_FIBER_COUNT,
+  }));
+
+  uint32_t failed = 0;
+
+  for (uint32_t i = 0; i < AC_COUNTOF(ac_tests); ++i)
+  {
+    int64_t before = ac_atomic_load_i64(&ac_test_failures);
+
+    ac_tests[i].function();
+
+    if (ac_atomic_load_i64(&ac_test_failures) != before)
+    {
+      AC_ERROR("[ tests ] %s: failed", ac_tests[i].name);
+      ++failed;
+    }
+    else
+    {
+      AC_INFO("[ tests ] %s: ok", ac_tests[i].name);
+    }
+  }
+
+  AC_INFO(
+    "[ tests ] %u of %u passed",
+    (uint32_t)AC_COUNTOF(ac_tests) - failed,
+    (uint32_t)AC_COUNTOF(ac_tests));
+
+  ac_shutdown();
+
+  return failed ? ac_result_unknown_error : ac_result_success;
+}
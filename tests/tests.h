@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ac_private.h"
+
+// failed expectation is logged and marks current test as failed, test keeps
+// running. safe to use from jobs
+#define AC_TEST_EXPECT(expr)                                                   \
+  do                                                                           \
+  {                                                                            \
+    if (!(expr))                                                               \
+    {                                                                          \
+      ac_test_fail(#expr, (__FILE__), AC_CAST(uint32_t, __LINE__));            \
+    }                                                                          \
+  }                                                                            \
+  while (false)
+
+#define AC_TEST_IS_ALIGNED(p, alignment)                                       \
+  ((((uintptr_t)(p)) & ((uintptr_t)(alignment) - 1)) == 0)
+
+void
+ac_test_fail(const char* expr, const char* file, uint32_t line);
+
+void
+ac_test_arena(void);
+
+void
+ac_test_pool(void);
+
+void
+ac_test_heap(void);
+
+void
+ac_test_aligned_realloc(void);
+
+void
+ac_test_memory_stats(void);
+
+void
+ac_test_job_run(void);
+
+void
+ac_test_job_run_after(void);
+
+void
+ac_test_job_nested_wait(void);
+
+void
+ac_test_job_counter_reuse(void);